@@ -1,39 +1,91 @@
 #include "AudioRecorder.h"
-#include <pulse/simple.h>
-#include <pulse/error.h>
+#include "audio/AudioBackend.h"
+#include "audio/AudioDsp.h"
+#include "audio/DiskRecording.h"
+#include "audio/NoiseGate.h"
+#include "audio/PreRollBuffer.h"
+#include "audio/Resampler.h"
+#include "audio/VoiceActivityDetector.h"
+#include "utils/Settings.h"
 #include <QDebug>
-#include <cmath>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
+#include <time.h>
+
+namespace {
+    int64_t threadCpuNs() {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+    
+    int64_t wallNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
 
 AudioRecorder::AudioRecorder() 
-    : m_pulseAudioHandle(nullptr)
-    , m_isRecording(false) {
+    : m_isRecording(false)
+    , m_spillFailed(false)
+    , m_armed(false)
+    , m_capturing(false)
+    , m_idleCpuNs(0)
+    , m_idleWallNs(0)
+    , m_idleCpuStart(-1)
+    , m_idleWallStart(0)
+    , m_resampledFill(0)
+    , m_noiseGateNs(0.0)
+    , m_capturedBlocks(0)
+    , m_vad(VoiceActivityDetector::create())
+    , m_vadEnabled(false)
+    , m_ringOverruns(0)
+    , m_drainTimer(new QTimer(this))
+    , m_captureRing(std::make_unique<CaptureRing>()) {
+    
+    // 1a. GUI-side consumer for the capture ring
+    m_drainTimer->setInterval(DRAIN_INTERVAL_MS);
+    connect(m_drainTimer, &QTimer::timeout, this, &AudioRecorder::drainCapturedAudio);
     
-    // 1a. setup pulse audio connection
-    pa_sample_spec ss;
-    ss.format = PA_SAMPLE_S16LE;   // 16-bit signed little-endian
-    ss.channels = CHANNELS;         // mono
-    ss.rate = SAMPLE_RATE;          // 16kHz
+    // 1b. pick the capture backend from settings
+    Settings& settings = Settings::instance();
     
-    int error = 0;
+    AudioBackend::Config config;
+    config.sampleRate = settings.sampleRate();   // 0 = the device's own rate
+    config.channels = 0;                         // always the device's own, we downmix
+    config.latencyMs = settings.captureLatencyMs();
     
-    // 1b. create pulse simple connection
-    m_pulseAudioHandle = pa_simple_new(
-        nullptr,                    // default server
-        "SpeechRecorder",           // app name  
-        PA_STREAM_RECORD,           // recording stream
-        nullptr,                    // default device
-        "Speech Input",             // stream description
-        &ss,                        // sample spec
-        nullptr,                    // default channel map
-        nullptr,                    // default buffer attrs
-        &error                      // error code
-    );
+    // older versions stored the combo box label
+    QString device = settings.inputDevice();
+    if (device.compare("default", Qt::CaseInsensitive) != 0 && device != "PulseAudio Default") {
+        config.device = device;
+    }
+    
+    // 1c. throws std::runtime_error if PulseAudio is unreachable
+    m_backend = AudioBackend::create(settings.audioBackend(), config);
+    qDebug() << "Audio backend:" << m_backend->name()
+             << "latency target:" << config.latencyMs << "ms";
+    
+    // 1d. anything but 16 kHz mono goes through our resampler instead of
+    //     the server's; reads stay ~BUFFER_SIZE output samples long
+    const int rate = m_backend->sampleRate();
+    const int channels = m_backend->channels();
+    size_t nativeFrames = static_cast<size_t>(BUFFER_SIZE) * rate / SAMPLE_RATE;
+    if (rate != SAMPLE_RATE || channels != CHANNELS) {
+        Resampler::Quality quality = Resampler::qualityFromName(settings.resampleQuality().toUtf8().constData());
+        m_resampler = std::make_unique<Resampler>(rate, channels, SAMPLE_RATE, quality);
+        m_nativeBuffer.resize(nativeFrames * channels);
+        m_resampled.resize(BUFFER_SIZE + m_resampler->maxOutput(nativeFrames));
+        qDebug() << "Capture format:" << rate << "Hz," << channels << "channels, resampled to 16 kHz mono,"
+                 << Resampler::qualityName(quality) << "quality," << m_resampler->taps() << "taps";
+    }
     
-    if (!m_pulseAudioHandle) {
-        throw std::runtime_error(
-            QString("PulseAudio init failed: %1").arg(pa_strerror(error)).toStdString()
-        );
+    // 1e. optionally keep listening between takes
+    if (settings.preRollSeconds() > 0) {
+        arm(std::min(settings.preRollSeconds(), MAX_PRE_ROLL_SECONDS));
     }
 }
 
@@ -41,9 +93,32 @@ AudioRecorder::~AudioRecorder() {
     if (m_isRecording) {
         stopRecording();
     }
+    disarm();
+}
+
+void AudioRecorder::arm(int seconds) {
+    size_t blocks = (static_cast<size_t>(seconds) * SAMPLE_RATE + BUFFER_SIZE - 1) / BUFFER_SIZE;
+    m_preRoll = std::make_unique<PreRollBuffer>(BUFFER_SIZE, blocks);
     
-    if (m_pulseAudioHandle) {
-        pa_simple_free(m_pulseAudioHandle);
+    // the stream runs from here on; takes no longer start or flush it
+    m_backend->start();
+    m_armed = true;
+    m_recordThread = std::make_unique<QThread>();
+    connect(m_recordThread.get(), &QThread::started,
+            [this]() { recordingLoop(); });
+    m_recordThread->start();
+    qDebug() << "Pre-roll armed:" << seconds << "s";
+}
+
+void AudioRecorder::disarm() {
+    if (!m_armed) {
+        return;
+    }
+    m_armed = false;
+    m_backend->stop();
+    if (m_recordThread && m_recordThread->isRunning()) {
+        m_recordThread->quit();
+        m_recordThread->wait(MODE_CHANGE_TIMEOUT_MS);
     }
 }
 
@@ -52,78 +127,328 @@ void AudioRecorder::startRecording() {
         return;
     }
     
-    // 2a. clear old buffer
+    // 2a. clear old buffer; the ring is empty since the last drain and
+    //     only its overrun count needs a fresh baseline
     m_audioBuffer.clear();
-    m_audioBuffer.reserve(SAMPLE_RATE * 60); // reserve 1 minute initially
+    m_floatBuffer.clear();
+    m_spillFailed = false;
+    m_ringOverruns = m_captureRing->overruns();
+    m_segmenter.reset();
+    
+    // the gate and detector adapt to the room, so they start fresh too.
+    // Armed, the capture thread never stops, so it swaps the gate in and
+    // resets the rest itself at the take's first block (deliverBlock)
+    Settings& settings = Settings::instance();
+    std::unique_ptr<NoiseGate> gate;
+    if (settings.noiseGateEnabled()) {
+        NoiseGate::Config gateConfig;
+        gateConfig.mode = settings.noiseGateMode() == "spectral" ? NoiseGate::Mode::Spectral
+                                                                 : NoiseGate::Mode::Gate;
+        gate = std::make_unique<NoiseGate>(gateConfig);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_modeMutex);
+        m_nextNoiseGate = std::move(gate);
+        m_vadEnabled = settings.voiceActivityDetection();
+    }
+    
+    // 2b. spill mode: blocks go to a file as they are drained, RAM use stays
+    //     at the capture ring however long the recording runs
+    m_spill.reset();
+    if (settings.spillToDisk()) {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/recordings";
+        QString error;
+        m_spill = DiskRecording::create(dir, error);
+        if (!m_spill) {
+            qWarning() << "Recording to memory, cannot spill to disk:" << error;
+        }
+    }
+    if (!m_spill) {
+        m_audioBuffer.reserve(SAMPLE_RATE * 60); // reserve 1 minute initially
+        m_floatBuffer.reserve(SAMPLE_RATE * 60);
+    }
     
-    // 2b. start recording thread
+    // 2c. armed: the capture thread is already reading; it sees the flag
+    //     at its next block and sends the pre-roll ahead of it. The
+    //     resampler runs on untouched, so pre-roll and take join up.
+    m_drainTimer->start();
+    if (m_armed) {
+        std::lock_guard<std::mutex> lock(m_modeMutex);
+        m_isRecording = true;
+        return;
+    }
+    
+    // 2d. no capture thread yet: the resampler starts clean, and the
+    //     backend is uncorked / flushed so only fresh audio comes through
+    if (m_resampler) {
+        m_resampler->reset();
+        m_resampledFill = 0;
+    }
+    m_backend->start();
+    
+    // 2e. start recording thread
     m_isRecording = true;
     m_recordThread = std::make_unique<QThread>();
     
-    // 2c. move recording to thread
+    // 2f. move recording to thread
     connect(m_recordThread.get(), &QThread::started,
             [this]() { recordingLoop(); });
     
     m_recordThread->start();
 }
 
-std::vector<int16_t> AudioRecorder::stopRecording() {
+AudioBuffer::Ptr AudioRecorder::stopRecording() {
     if (!m_isRecording) {
-        return {};
+        return nullptr;
     }
     
-    // 3a. signal thread to stop
-    m_isRecording = false;
+    qDebug() << "Capture latency:" << m_backend->latencyMs() << "ms";
+    if (m_armed) {
+        // 3a. armed: the thread keeps running; wait until it has finished
+        //     the take's last block and gone back to filling the pre-roll
+        std::unique_lock<std::mutex> lock(m_modeMutex);
+        m_isRecording = false;
+        m_modeChanged.wait_for(lock, std::chrono::milliseconds(MODE_CHANGE_TIMEOUT_MS),
+                               [this]() { return !m_capturing; });
+        lock.unlock();
+        
+        int64_t idleWall = m_idleWallNs.load();
+        if (idleWall > 0) {
+            qDebug() << "Pre-roll idle cost:" << 100.0 * m_idleCpuNs.load() / idleWall
+                     << "% of a core over" << idleWall / 1e9 << "s";
+        }
+    } else {
+        // 3a. signal thread to stop, and wake it if it is blocked in read()
+        m_isRecording = false;
+        m_backend->stop();
+        
+        // 3b. wait for thread to finish
+        if (m_recordThread && m_recordThread->isRunning()) {
+            m_recordThread->quit();
+            m_recordThread->wait(MODE_CHANGE_TIMEOUT_MS);
+        }
+    }
     
-    // 3b. wait for thread to finish
-    if (m_recordThread && m_recordThread->isRunning()) {
-        m_recordThread->quit();
-        m_recordThread->wait(5000); // 5 second timeout
+    // 3c. producer is gone, pick up whatever is still in the ring
+    m_drainTimer->stop();
+    drainCapturedAudio();
+    
+    if (m_noiseGate && m_capturedBlocks > 0) {
+        double usPerBlock = m_noiseGateNs / m_capturedBlocks / 1000.0;
+        qDebug() << "Noise gate:" << usPerBlock << "us per block,"
+                 << usPerBlock / (BUFFER_SIZE * 1000.0 / SAMPLE_RATE) / 10.0 << "% of the block";
+    }
+    
+    size_t overruns = m_captureRing->overruns() - m_ringOverruns;
+    if (overruns > 0) {
+        qWarning() << "Capture ring overran" << overruns << "times, audio was dropped";
+    }
+    
+    AudioBuffer::SpeechSpans speech;
+    if (m_vadEnabled) {
+        speech = m_segmenter.finish();
     }
     
-    // 3c. return captured audio
-    return std::move(m_audioBuffer);
+    // 3d. spilled: finish the file and map it for the engines
+    if (m_spill) {
+        std::shared_ptr<DiskRecording> recording = std::move(m_spill);
+        QString error;
+        if (!recording->finish(error)) {
+            emit recordingError("Could not finish the recording file: " + error);
+            return nullptr;
+        }
+        return AudioBuffer::create(std::move(recording), std::move(speech));
+    }
+    
+    // 3e. hand the captured audio over without copying; the float view
+    //     saves the engine a conversion pass right when the user waits
+    return AudioBuffer::create(std::move(m_audioBuffer), std::move(m_floatBuffer), std::move(speech));
+}
+
+void AudioRecorder::drainCapturedAudio() {
+    // runs on the GUI thread, the only consumer of m_captureRing
+    while (const CaptureRing::Block* block = m_captureRing->front()) {
+        if (m_vadEnabled) {
+            m_segmenter.add(block->count, block->flags & BLOCK_SPEECH);
+        }
+        
+        if (m_spill) {
+            // report a full disk once, keep draining so capture isn't blocked
+            if (!m_spill->append(block->samples, block->count) && !m_spillFailed) {
+                m_spillFailed = true;
+                emit recordingError("Writing the recording to disk failed: " + m_spill->errorString());
+            }
+        } else {
+            m_audioBuffer.insert(m_audioBuffer.end(),
+                                 block->samples,
+                                 block->samples + block->count);
+            
+            // convert while capture is idle anyway; a take too long for the
+            // float view to pay off drops it instead of doubling its RAM
+            if (m_audioBuffer.size() <= FLOAT_VIEW_MAX_SAMPLES) {
+                size_t offset = m_floatBuffer.size();
+                m_floatBuffer.resize(offset + block->count);
+                AudioDsp::convertToFloat(block->samples, m_floatBuffer.data() + offset, block->count);
+            } else if (!m_floatBuffer.empty()) {
+                m_floatBuffer.clear();
+                m_floatBuffer.shrink_to_fit();
+            }
+        }
+        emit audioCaptured(block->samples, block->count);
+        m_captureRing->release();
+    }
 }
 
 void AudioRecorder::recordingLoop() {
     int16_t buffer[BUFFER_SIZE];
-    int error = 0;
-    
-    while (m_isRecording) {
-        // 4a. read audio chunk from pulse
-        int bytes_read = pa_simple_read(
-            m_pulseAudioHandle,
-            buffer,
-            sizeof(buffer),
-            &error
-        );
-        
-        if (bytes_read < 0) {
-            emit recordingError(QString("Read error: %1").arg(pa_strerror(error)));
+    if (m_armed) {
+        beginIdle();
+    }
+    
+    while (m_isRecording || m_armed) {
+        // 4a. read audio chunk from the backend, at 16 kHz mono already
+        //     or at the device's format
+        QString error;
+        int16_t* target = m_resampler ? m_nativeBuffer.data() : buffer;
+        size_t samples = m_resampler ? m_nativeBuffer.size() : BUFFER_SIZE;
+        if (!m_backend->read(target, samples, error)) {
+            if (!error.isEmpty() && m_isRecording) {
+                emit recordingError(error);
+            } else if (!error.isEmpty()) {
+                qWarning() << "Pre-roll capture stopped:" << error;
+            }
             break;
         }
         
-        // 4b. append to main buffer
-        m_audioBuffer.insert(m_audioBuffer.end(), 
-                           buffer, 
-                           buffer + BUFFER_SIZE);
+        if (!m_resampler) {
+            deliverBlock(buffer);
+            continue;
+        }
         
-        // 4c. calculate and emit audio level
-        float rms = calculateRMS(buffer, BUFFER_SIZE);
-        emit audioLevelChanged(rms);
+        // 4b. convert, and pass on whole blocks; a 44.1 kHz read doesn't
+        //     come out at exactly BUFFER_SIZE samples
+        m_resampledFill += m_resampler->process(m_nativeBuffer.data(), samples / m_resampler->channels(),
+                                                m_resampled.data() + m_resampledFill);
+        size_t offset = 0;
+        for (; offset + BUFFER_SIZE <= m_resampledFill; offset += BUFFER_SIZE) {
+            deliverBlock(m_resampled.data() + offset);
+        }
+        std::copy(m_resampled.begin() + offset, m_resampled.begin() + m_resampledFill, m_resampled.begin());
+        m_resampledFill -= offset;
     }
+    
+    // gone for good: a failed stream disarms, so the next take starts a
+    // thread of its own, and nobody may be left waiting on a mode change
+    endIdle();
+    m_armed = false;
+    setCapturing(false);
 }
 
-float AudioRecorder::calculateRMS(const int16_t* buffer, size_t size) {
-    if (size == 0) return 0.0f;
+void AudioRecorder::deliverBlock(int16_t* block) {
+    // 4c. read the flag and record what was acted on in one step, so
+    //     stopRecording() either sees the take start or stops it first
+    bool recording;
+    bool starting = false;
+    bool stopping = false;
+    {
+        std::lock_guard<std::mutex> lock(m_modeMutex);
+        recording = m_isRecording;
+        if (recording != m_capturing) {
+            m_capturing = recording;
+            starting = recording;
+            stopping = !recording;
+        }
+        if (starting) {
+            // the last take's gate goes back, startRecording() frees it
+            m_noiseGate.swap(m_nextNoiseGate);
+        }
+    }
     
-    // 5a. calculate root mean square for audio level
-    double sum = 0.0;
-    for (size_t i = 0; i < size; ++i) {
-        double normalized = static_cast<double>(buffer[i]) / 32768.0;
-        sum += normalized * normalized;
+    // 4d. a take starts: per-take state is reset here, on this thread, and
+    //     its first blocks are the pre-roll, oldest first, kept off the
+    //     meter (seconds-old levels, a hundred-odd signals in one burst)
+    if (starting) {
+        endIdle();
+        m_vad->reset();
+        m_noiseGateNs = 0.0;
+        m_capturedBlocks = 0;
+        if (m_preRoll) {
+            for (size_t i = 0; i < m_preRoll->size(); ++i) {
+                captureBlock(m_preRoll->block(i), false);
+            }
+            m_preRoll->clear();
+        }
+    } else if (stopping) {
+        m_modeChanged.notify_all();
+        beginIdle();
+    }
+    
+    // 4e. idle blocks only get copied; gate, VAD and meter wait for a take
+    if (recording) {
+        captureBlock(block, true);
+    } else if (m_preRoll) {
+        m_preRoll->push(block);
+    }
+}
+
+void AudioRecorder::setCapturing(bool capturing) {
+    {
+        std::lock_guard<std::mutex> lock(m_modeMutex);
+        m_capturing = capturing;
+    }
+    m_modeChanged.notify_all();
+}
+
+void AudioRecorder::beginIdle() {
+    m_idleCpuStart = threadCpuNs();
+    m_idleWallStart = wallNs();
+}
+
+void AudioRecorder::endIdle() {
+    if (m_idleCpuStart < 0) {
+        return;
+    }
+    m_idleCpuNs += threadCpuNs() - m_idleCpuStart;
+    m_idleWallNs += wallNs() - m_idleWallStart;
+    m_idleCpuStart = -1;
+}
+
+void AudioRecorder::captureBlock(int16_t* block, bool meter) {
+    // 5a. gate in place, timed so the cost shows up next to the latency
+    if (m_noiseGate) {
+        auto gateStart = std::chrono::steady_clock::now();
+        m_noiseGate->process(block, BUFFER_SIZE);
+        m_noiseGateNs += std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - gateStart).count();
     }
+    m_capturedBlocks++;
+    
+    // 5b. speech or not, decided here while the block is hot in cache;
+    //     the consumer only turns the flags into spans
+    uint32_t flags = m_vadEnabled && m_vad->isSpeech(block, BUFFER_SIZE) ? BLOCK_SPEECH : 0;
     
-    // 5b. return RMS value (0.0 to 1.0)
-    return std::sqrt(sum / size);
+    // 5c. hand the block to the consumer (no allocation, no lock)
+    m_captureRing->push(block, BUFFER_SIZE, flags);
+    
+    // 5d. calculate and emit audio level
+    if (meter) {
+        float rms = AudioDsp::calculateRMS(block, BUFFER_SIZE);
+        emit audioLevelChanged(rms);
+    }
+}
+
+double AudioRecorder::latencyMs() const {
+    return m_backend->latencyMs();
+}
+
+QString AudioRecorder::backendName() const {
+    return m_backend->name();
+}
+
+int AudioRecorder::captureRate() const {
+    return m_backend->sampleRate();
+}
+
+int AudioRecorder::captureChannels() const {
+    return m_backend->channels();
 }
@@ -5,38 +5,119 @@
 #include <QThread>
 #include <vector>
 #include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include "audio/AudioBuffer.h"
+#include "audio/AudioRingBuffer.h"
+#include "audio/SpeechSegmenter.h"
 
-// forward declare to avoid pulse headers in header file
-typedef struct pa_simple pa_simple;
+class QTimer;
+class AudioBackend;
+class DiskRecording;
+class VoiceActivityDetector;
+class NoiseGate;
+class Resampler;
+class PreRollBuffer;
 
 class AudioRecorder : public QObject {
     Q_OBJECT
-
+    
 public:
     AudioRecorder();
     ~AudioRecorder();
     
+    // With Settings::preRollSeconds the capture thread runs from
+    // construction on and keeps the last seconds of audio; startRecording()
+    // then only flips a flag and the take begins with that pre-roll.
     void startRecording();
-    std::vector<int16_t> stopRecording();
+    
+    // Returns the captured audio, in memory or, in spill mode
+    // (Settings::spillToDisk), mapped from the recording file. Null if
+    // nothing was recording or the file could not be finished. With
+    // Settings::voiceActivityDetection the buffer carries speech spans.
+    AudioBuffer::Ptr stopRecording();
+    
+    // Measured capture latency of the active backend (-1 if unknown)
+    double latencyMs() const;
+    QString backendName() const;
+    
+    // Format the device delivers; anything but 16 kHz mono is converted
+    // on the capture thread (Settings::sampleRate, Settings::resampleQuality)
+    int captureRate() const;
+    int captureChannels() const;
+    
+    bool isArmed() const { return m_armed; }
     
 signals:
     void audioLevelChanged(float level);
+    
+    // Emitted on the GUI thread for every block drained from the capture
+    // ring. The pointer is only valid for the duration of the call.
+    void audioCaptured(const int16_t* samples, size_t count);
     void recordingError(const QString& error);
-
+    
+private slots:
+    void drainCapturedAudio();
+    
 private:
+    void arm(int seconds);
+    void disarm();
     void recordingLoop();
-    float calculateRMS(const int16_t* buffer, size_t size);
+    void deliverBlock(int16_t* block);   // one 16 kHz block, capture thread
+    void captureBlock(int16_t* block, bool meter);   // same, while recording; meter: emit its level
+    void setCapturing(bool capturing);
+    void beginIdle();
+    void endIdle();
     
-    pa_simple* m_pulseAudioHandle;
+    std::unique_ptr<AudioBackend> m_backend;
     std::unique_ptr<QThread> m_recordThread;
     std::atomic<bool> m_isRecording;
-    std::vector<int16_t> m_audioBuffer;
+    std::vector<int16_t> m_audioBuffer;   // only touched on the GUI thread
+    std::vector<float> m_floatBuffer;     // same audio as float, while short enough
+    std::unique_ptr<DiskRecording> m_spill;   // spill mode, while recording
+    bool m_spillFailed;
+    // pre-roll: the capture thread outlives takes and owns the buffer;
+    // m_capturing is the mode it has acted on, so stopRecording() can wait
+    // for the last block of the take
+    std::unique_ptr<PreRollBuffer> m_preRoll;       // capture thread only, null if off
+    std::atomic<bool> m_armed;
+    bool m_capturing;                               // guarded by m_modeMutex
+    std::mutex m_modeMutex;
+    std::condition_variable m_modeChanged;
+    std::atomic<int64_t> m_idleCpuNs;               // capture thread CPU spent idle
+    std::atomic<int64_t> m_idleWallNs;
+    int64_t m_idleCpuStart;                         // capture thread only, -1 = not idle
+    int64_t m_idleWallStart;
+    
+    std::unique_ptr<Resampler> m_resampler;         // capture thread only, null at 16 kHz mono
+    std::vector<int16_t> m_nativeBuffer;            // one read at the device format
+    std::vector<int16_t> m_resampled;               // 16 kHz output not yet a full block
+    size_t m_resampledFill;
+    std::unique_ptr<NoiseGate> m_noiseGate;         // capture thread only, null if off
+    std::unique_ptr<NoiseGate> m_nextNoiseGate;     // next take's, guarded by m_modeMutex
+    double m_noiseGateNs;                           // time spent gating this recording
+    size_t m_capturedBlocks;
+    std::unique_ptr<VoiceActivityDetector> m_vad;   // capture thread only
+    SpeechSegmenter m_segmenter;                    // GUI thread only
+    bool m_vadEnabled;                              // fixed per recording, set under m_modeMutex
+    size_t m_ringOverruns;                          // ring's count when the take started
+    QTimer* m_drainTimer;
     
     // constants
     static constexpr int SAMPLE_RATE = 16000;
     static constexpr int CHANNELS = 1;
     static constexpr int BUFFER_SIZE = 1024;
+    static constexpr int RING_BLOCKS = 256;     // ~16 s of headroom at 16kHz
+    static constexpr int DRAIN_INTERVAL_MS = 20;
+    static constexpr uint32_t BLOCK_SPEECH = 1;     // CaptureRing::Block::flags
+    static constexpr size_t FLOAT_VIEW_MAX_SAMPLES = SAMPLE_RATE * 600;   // Whisper chunks past 10 min anyway
+    static constexpr int MAX_PRE_ROLL_SECONDS = 10;   // stitched through the ring, which holds ~16 s
+    static constexpr int MODE_CHANGE_TIMEOUT_MS = 5000;
+    
+    // capture thread -> GUI thread handoff, lock-free
+    using CaptureRing = AudioRingBuffer<BUFFER_SIZE, RING_BLOCKS>;
+    std::unique_ptr<CaptureRing> m_captureRing;
 };
 
 #endif // AUDIORECORDER_H
@@ -1,17 +1,23 @@
 #include "MainWindow.h"
 #include "AudioRecorder.h"
 #include "WhisperTranscriber.h"
-#include "TranscriptionWorker.h"
-#include "transcription/VoskEngine.h"
+#include "StreamingTranscriptionWorker.h"
+#include "transcription/ModelCache.h"
+#include "transcription/ModelLoader.h"
+#include "transcription/TranscriptionScheduler.h"
 #include "gui/ModelSelector.h"
 #include "gui/ModelManager.h"
 #include "gui/SettingsDialog.h"
+#include "gui/DesktopExporter.h"
 #include "utils/FileExporter.h"
 #include "utils/Settings.h"
 #include "utils/ErrorHandler.h"
+#include "utils/StartupTimer.h"
+#include "utils/LatencyTrace.h"
 
 #include <QPushButton>
 #include <QTextEdit>
+#include <QTextCursor>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -26,14 +32,19 @@
 #include <QMenu>
 #include <QFileDialog>
 #include <QGroupBox>
-
-// VoskEngine is included directly
+#include <QFileInfo>
+#include <QStatusBar>
+#include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent) 
     : QMainWindow(parent)
     , m_isRecording(false)
     , m_modelManager(nullptr)
     , m_settingsDialog(nullptr)
+    , m_modelCache(std::make_unique<ModelCache>())
+    , m_modelLoader(nullptr)
+    , m_scheduler(nullptr)
+    , m_streamingWorker(nullptr)
     , m_recordingTimer(new QTimer(this)) {
     
     setupMenuBar();
@@ -42,22 +53,60 @@ MainWindow::MainWindow(QWidget *parent)
     // Connect recording timer
     connect(m_recordingTimer, &QTimer::timeout, this, &MainWindow::updateRecordingTimer);
     
+    // Transcriptions run on a fixed pool, results come back in recording order
+    m_scheduler = new TranscriptionScheduler(Settings::instance().transcriptionWorkers(),
+                                             TranscriptionScheduler::DEFAULT_MAX_QUEUED, this);
+    connect(m_scheduler, &TranscriptionScheduler::jobFinished, this,
+            [this](quint64 jobId, const QString& text) {
+        std::shared_ptr<LatencyTrace> trace;
+        auto it = m_traces.find(jobId);
+        if (it != m_traces.end()) {
+            trace = std::move(it->second);
+            m_traces.erase(it);
+        }
+        completeTranscription(text.isEmpty() ? "(No speech detected)" : text, trace);
+    });
+    connect(m_scheduler, &TranscriptionScheduler::jobFailed, this,
+            [this](quint64 jobId, const QString& error) {
+        m_traces.erase(jobId);
+        onTranscriptionError(error);
+    });
+    connect(m_scheduler, &TranscriptionScheduler::queueDepthChanged,
+            this, &MainWindow::onTranscriptionQueueChanged);
+    
     // Initialize audio recorder
     try {
         m_audioRecorder = std::make_unique<AudioRecorder>();
         connect(m_audioRecorder.get(), &AudioRecorder::audioLevelChanged, 
                 this, &MainWindow::updateAudioLevel);
+        connect(m_audioRecorder.get(), &AudioRecorder::recordingError, this,
+                [this](const QString& error) {
+            QMessageBox::warning(this, "Recording Error", error);
+        });
     } catch (const std::exception& e) {
         ErrorHandler::showPulseAudioError(this, e.what());
     }
     
-    // Load default model from settings
+    // Load default model from settings, in the background
     QString defaultModel = Settings::instance().defaultModel();
     m_modelSelector->refreshAvailableModels();
     loadTranscriber(defaultModel);
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+    // Don't leave a loader running against a destroyed window
+    if (m_modelLoader) {
+        m_modelLoader->disconnect(this);
+        m_modelLoader->cancel();
+        m_modelLoader->wait();
+        delete m_modelLoader;
+    }
+}
+
+void MainWindow::paintEvent(QPaintEvent* event) {
+    StartupTimer::mark("first paint");
+    QMainWindow::paintEvent(event);
+}
 
 void MainWindow::setupMenuBar() {
     QMenuBar* menuBar = new QMenuBar(this);
@@ -240,79 +289,207 @@ void MainWindow::setupUI() {
     m_footerLabel->setAlignment(Qt::AlignCenter);
     m_footerLabel->setStyleSheet("color: #666; font-size: 11px; padding: 5px;");
     mainLayout->addWidget(m_footerLabel);
+    
+    // Latency readout, only visible when enabled in Settings
+    m_latencyLabel = new QLabel(this);
+    m_latencyLabel->setStyleSheet("color: #888; font-size: 11px;");
+    statusBar()->addPermanentWidget(m_latencyLabel, 1);
+    statusBar()->setVisible(Settings::instance().latencyReadout());
+}
+
+QString MainWindow::modelPathFor(const QString& modelName) const {
+    QString modelDir = Settings::instance().modelDirectory();
+    
+    if (modelName.startsWith("Vosk")) {
+        if (modelName == "Vosk Small") {
+            return modelDir + "/vosk-model-small-en-us-0.15";
+        }
+        return modelDir + "/vosk-model-en-us-0.22";
+    }
+    
+    // Determine model filename based on name
+    QString modelFile;
+    if (modelName.contains("Tiny En")) modelFile = "ggml-tiny.en.bin";
+    else if (modelName.contains("Tiny")) modelFile = "ggml-tiny.bin";
+    else if (modelName.contains("Base En")) modelFile = "ggml-base.en.bin";
+    else if (modelName.contains("Base")) modelFile = "ggml-base.bin";
+    else if (modelName.contains("Small En")) modelFile = "ggml-small.en.bin";
+    else if (modelName.contains("Small")) modelFile = "ggml-small.bin";
+    else if (modelName.contains("Medium En")) modelFile = "ggml-medium.en.bin";
+    else if (modelName.contains("Medium")) modelFile = "ggml-medium.bin";
+    else if (modelName.contains("Large V1")) modelFile = "ggml-large-v1.bin";
+    else if (modelName.contains("Large V2")) modelFile = "ggml-large-v2.bin";
+    else if (modelName.contains("Large V3")) modelFile = "ggml-large-v3.bin";
+    else modelFile = "ggml-base.bin"; // fallback
+    
+    return modelDir + "/" + modelFile;
 }
 
 void MainWindow::loadTranscriber(const QString& modelName) {
     m_currentModel = modelName;
     
-    try {
-        if (modelName.startsWith("Whisper")) {
-            // Determine model filename based on name
-            QString modelFile;
-            if (modelName.contains("Tiny En")) modelFile = "ggml-tiny.en.bin";
-            else if (modelName.contains("Tiny")) modelFile = "ggml-tiny.bin";
-            else if (modelName.contains("Base En")) modelFile = "ggml-base.en.bin";
-            else if (modelName.contains("Base")) modelFile = "ggml-base.bin";
-            else if (modelName.contains("Small En")) modelFile = "ggml-small.en.bin";
-            else if (modelName.contains("Small")) modelFile = "ggml-small.bin";
-            else if (modelName.contains("Medium En")) modelFile = "ggml-medium.en.bin";
-            else if (modelName.contains("Medium")) modelFile = "ggml-medium.bin";
-            else if (modelName.contains("Large V1")) modelFile = "ggml-large-v1.bin";
-            else if (modelName.contains("Large V2")) modelFile = "ggml-large-v2.bin";
-            else if (modelName.contains("Large V3")) modelFile = "ggml-large-v3.bin";
-            else modelFile = "ggml-base.bin"; // fallback
-            
-            QString modelPath = Settings::instance().modelDirectory() + "/" + modelFile;
-            
-            // Check if model exists before trying to load
-            if (!QFile::exists(modelPath)) {
-                throw std::runtime_error(QString("Model file not found: %1\nDownload it from Tools > Manage Models").arg(modelFile).toStdString());
-            }
-            
-            m_whisperTranscriber = std::make_unique<WhisperTranscriber>(modelPath);
-            m_voskEngine.reset();
-            setStatus(QString("Ready - %1 loaded").arg(modelName));
-            
-        } else if (modelName.startsWith("Vosk")) {
-            // Vosk support is optional
-#ifdef VOSK_AVAILABLE
-            QString modelPath = Settings::instance().modelDirectory();
-            if (modelName == "Vosk Small") {
-                modelPath += "/vosk-model-small-en-us-0.15";
-            } else {
-                modelPath += "/vosk-model-en-us-0.22";
-            }
-            
-            m_voskEngine = std::make_unique<VoskEngine>(modelPath.toStdString());
-            m_whisperTranscriber.reset();
-            
-            if (m_voskEngine->isModelLoaded()) {
-                setStatus(QString("Ready - %1 loaded").arg(modelName));
-            } else {
-                throw std::runtime_error("Vosk model not found. Download from Tools > Manage Models.");
-            }
-#else
-            // Vosk not available - fallback to Whisper Base
-            QMessageBox::warning(this, "Vosk Not Available",
-                "Vosk support not compiled in. Falling back to Whisper Base.\n\n"
-                "To enable Vosk: install libvosk and rebuild.");
-            
-            // Load Whisper Base as fallback
-            m_modelSelector->setCurrentText("Whisper Base");
-            return; // Will trigger loadTranscriber again with Whisper Base
+#ifndef VOSK_AVAILABLE
+    if (modelName.startsWith("Vosk")) {
+        // Vosk not available - fallback to Whisper Base
+        QMessageBox::warning(this, "Vosk Not Available",
+            "Vosk support not compiled in. Falling back to Whisper Base.\n\n"
+            "To enable Vosk: install libvosk and rebuild.");
+        
+        // Load Whisper Base as fallback
+        m_modelSelector->setCurrentText("Whisper Base");
+        return; // Will trigger loadTranscriber again with Whisper Base
+    }
 #endif
+    
+    QString modelPath = modelPathFor(modelName);
+    
+    // Check if model exists before trying to load
+    if (modelName.startsWith("Whisper") && !QFile::exists(modelPath)) {
+        onModelLoadFailed(modelName, QString("Model file not found: %1\nDownload it from Tools > Manage Models")
+                          .arg(QFileInfo(modelPath).fileName()));
+        return;
+    }
+    
+    // Reuse the model if it is still in memory
+    m_modelCache->setKeepModelsLoaded(Settings::instance().keepModelLoaded());
+    ModelCache::Entry cached = m_modelCache->find(modelPath);
+    if (cached.isValid()) {
+        activateModel(modelName, cached);
+        return;
+    }
+    
+    // One load at a time; m_currentModel is loaded once this one finishes
+    if (m_modelLoader) {
+        return;
+    }
+    
+    // Without keepModelLoaded only one model may be resident
+    if (!Settings::instance().keepModelLoaded()) {
+        m_modelCache->clear();
+        m_engine.reset();
+    }
+    
+    // Load in the background so the window stays usable
+    m_modelLoader = new ModelLoader(modelName, modelPath);
+    connect(m_modelLoader, &ModelLoader::loadProgress,
+            this, &MainWindow::onModelLoadProgress);
+    connect(m_modelLoader, &ModelLoader::modelLoaded,
+            this, &MainWindow::onModelLoaded);
+    connect(m_modelLoader, &ModelLoader::loadFailed, this, [this](const QString& error) {
+        QString name = m_modelLoader->modelName();
+        finishModelLoad();
+        if (name != m_currentModel) {
+            // the user already picked something else
+            loadTranscriber(m_currentModel);
+            return;
         }
-    } catch (const std::exception& e) {
-        ErrorHandler::showModelLoadError(this, modelName, e.what());
-        setStatus("Error: Model not loaded");
+        onModelLoadFailed(name, error);
+    });
+    connect(m_modelLoader, &ModelLoader::finished,
+            m_modelLoader, &QObject::deleteLater);
+    
+    m_modelSelector->setLoadingState(modelName, 0);
+    if (!m_isRecording) {
+        setStatus(QString("⏳ Loading %1...").arg(modelName));
+    }
+    m_modelLoader->start();
+}
+
+void MainWindow::onModelLoadProgress(int percent) {
+    if (!m_modelLoader) return;
+    
+    m_modelSelector->setLoadingState(m_modelLoader->modelName(), percent);
+    if (percent >= 0 && !m_isRecording) {
+        setStatus(QString("⏳ Loading %1... %2%").arg(m_modelLoader->modelName()).arg(percent));
+    }
+}
+
+void MainWindow::onModelLoaded() {
+    if (!m_modelLoader) return;
+    
+    m_modelCache->insert(m_modelLoader->modelPath(), m_modelLoader->takeResult());
+    finishModelLoad();
+    
+    // Either the model just loaded (a cache hit now) or whatever the user
+    // picked while it was loading
+    loadTranscriber(m_currentModel);
+}
+
+void MainWindow::onModelLoadFailed(const QString& modelName, const QString& error) {
+    ErrorHandler::showModelLoadError(this, modelName, error);
+    setStatus("Error: Model not loaded");
+    
+    // Try to fall back to Whisper Base if available
+    if (modelName != "Whisper Base" && QFile::exists(Settings::instance().modelDirectory() + "/ggml-base.bin")) {
+        QMessageBox::information(this, "Using Fallback Model",
+            "Loading Whisper Base as fallback model.");
+        m_modelSelector->setCurrentText("Whisper Base");
+    }
+    
+    // Nothing left that could transcribe what was recorded meanwhile
+    if (!m_modelLoader && !m_engine && !m_pendingAudio.empty()) {
+        setStatus(QString("Error: Model not loaded - %1 recording(s) discarded").arg(m_pendingAudio.size()));
+        m_pendingAudio.clear();
+    }
+}
+
+void MainWindow::finishModelLoad() {
+    m_modelSelector->clearLoadingState();
+    m_modelLoader = nullptr;   // deletes itself once the thread exits
+}
+
+void MainWindow::activateModel(const QString& modelName, const ModelCache::Entry& entry) {
+    m_engine = entry.engine;
+    if (auto whisper = std::dynamic_pointer_cast<WhisperTranscriber>(m_engine)) {
+        whisper->setAdaptiveAudioContext(Settings::instance().adaptiveAudioContext());
+    }
+    if (!m_isRecording) {
+        setStatus(QString("Ready - %1 loaded").arg(modelName));
+    }
+    StartupTimer::mark("model ready");
+    
+    // Audio recorded while the model was loading
+    if (!m_isRecording) {
+        transcribePendingAudio();
+    }
+}
+
+void MainWindow::transcribePendingAudio() {
+    if (m_pendingAudio.empty() || !m_engine) {
+        return;
+    }
+    
+    // Oldest first, for as long as the queue takes them; a take the queue
+    // refuses goes back to the front and waits for queueDepthChanged.
+    // submit() reports the new depth synchronously, which may re-enter
+    // here, so each take leaves the list before it is submitted.
+    while (!m_pendingAudio.empty()) {
+        PendingRecording recording = std::move(m_pendingAudio.front());
+        m_pendingAudio.erase(m_pendingAudio.begin());
         
-        // Try to fall back to Whisper Base if available
-        if (modelName != "Whisper Base" && QFile::exists(Settings::instance().modelDirectory() + "/ggml-base.bin")) {
-            QMessageBox::information(this, "Using Fallback Model",
-                "Loading Whisper Base as fallback model.");
-            m_modelSelector->setCurrentText("Whisper Base");
+        quint64 jobId = m_scheduler->submit(m_engine, recording.audio, TranscriptionScheduler::Normal,
+                                            recording.trace);
+        if (jobId == 0) {
+            m_pendingAudio.insert(m_pendingAudio.begin(), std::move(recording));
+            break;
+        }
+        if (recording.trace) {
+            m_traces[jobId] = recording.trace;
         }
     }
+    
+    if (m_isRecording) {
+        return;   // the status shows the take
+    }
+    TranscriptionScheduler::Metrics metrics = m_scheduler->metrics();
+    if (!m_pendingAudio.empty()) {
+        setStatus(QString("⏳ Transcription queue full... (%1 more recording(s) waiting)")
+                      .arg(m_pendingAudio.size()));
+    } else if (metrics.queued > 0) {
+        setStatus(QString("⏳ Transcribing... (%1 waiting)").arg(metrics.queued));
+    } else {
+        setStatus("⏳ Transcribing... Please wait");
+    }
 }
 
 void MainWindow::onRecordButtonClicked() {
@@ -349,6 +526,15 @@ void MainWindow::startRecording() {
     m_recordingStartTime = QTime::currentTime();
     m_recordingTimer->start(100); // Update every 100ms
     
+    // Live transcription has to be listening before the first block arrives.
+    // Incremental engines always stream, the final text is then ready on stop.
+    if (m_engine) {
+        TranscriptionEngine::Capabilities caps = m_engine->capabilities();
+        if (caps.streaming && (caps.incremental || Settings::instance().liveTranscription())) {
+            startStreaming();
+        }
+    }
+    
     // Start recording
     m_audioRecorder->startRecording();
     m_isRecording = true;
@@ -356,8 +542,25 @@ void MainWindow::startRecording() {
 }
 
 void MainWindow::stopRecording() {
-    // Stop recording and get audio data
-    m_audioBuffer = m_audioRecorder->stopRecording();
+    // Trace this recording from here to the text on screen, if asked to
+    Settings& settings = Settings::instance();
+    m_pendingTrace.reset();
+    if (settings.latencyReadout() || settings.latencyLog()) {
+        m_pendingTrace = std::make_shared<LatencyTrace>();
+    }
+    
+    // Stop recording and get audio data, in memory or mapped from disk
+    AudioBuffer::Ptr audio;
+    {
+        LatencyTrace::Scope traceScope(m_pendingTrace.get());
+        LatencyTrace::StageTimer timer("drain");
+        audio = m_audioRecorder->stopRecording();
+    }
+    
+    const size_t recordedSamples = audio ? audio->size() : 0;
+    if (m_pendingTrace) {
+        m_pendingTrace->setAudioSamples(recordedSamples);
+    }
     
     // Update UI
     m_recordButton->setText("⬤ RECORD");
@@ -374,8 +577,22 @@ void MainWindow::stopRecording() {
     m_audioLevel->setValue(0);
     m_recordingTimer->stop();
     
+    // queue changes during the take were left for now
+    onTranscriptionQueueChanged(m_scheduler->metrics().queued, m_scheduler->isFull());
+    
     // Check if we got any audio
-    if (m_audioBuffer.empty() || m_audioBuffer.size() < 1600) { // less than 0.1 sec
+    bool tooShort = recordedSamples < 1600; // less than 0.1 sec
+    
+    // Live transcription already has everything but the last window
+    if (m_streamingWorker) {
+        finishStreaming(!tooShort, std::move(m_pendingTrace));
+        if (!tooShort) {
+            setStatus("⏳ Finalizing transcription...");
+            return;
+        }
+    }
+    
+    if (tooShort) {
         QMessageBox::warning(this, "Warning", 
             "No audio recorded. Please check your microphone.\n\n"
             "Test with: pactl list sources");
@@ -384,10 +601,19 @@ void MainWindow::stopRecording() {
         return;
     }
     
+    // Model still loading in the background: keep the audio until it's
+    // ready, behind anything else recorded meanwhile
+    if (!m_engine && m_modelLoader) {
+        m_pendingAudio.push_back({std::move(audio), std::move(m_pendingTrace)});
+        setStatus(QString("⏳ Waiting for %1 to finish loading... (%2 recording(s) waiting)")
+                      .arg(m_modelLoader->modelName()).arg(m_pendingAudio.size()));
+        return;
+    }
+    
     setStatus("⏳ Transcribing... Please wait");
     
     // Check if we have a transcriber loaded
-    if (!m_whisperTranscriber && !m_voskEngine) {
+    if (!m_engine) {
         QMessageBox::critical(this, "Error", 
             "No transcription model loaded.\n"
             "Please select a model from the dropdown.");
@@ -395,35 +621,76 @@ void MainWindow::stopRecording() {
         return;
     }
     
-    // Create worker thread for transcription
-    TranscriptionWorker* worker = nullptr;
-    if (m_whisperTranscriber) {
-        worker = new TranscriptionWorker(m_whisperTranscriber.get(), m_audioBuffer);
-    } else if (m_voskEngine) {
-        // For Vosk, we need to create a custom worker
-        // For now, transcribe directly (TODO: make async)
-        try {
-            std::string result = m_voskEngine->transcribe(m_audioBuffer);
-            onTranscriptionComplete(QString::fromStdString(result));
-            return;
-        } catch (const std::exception& e) {
-            onTranscriptionError(QString::fromStdString(e.what()));
-            return;
-        }
+    transcribeAudio(std::move(audio), std::move(m_pendingTrace));
+}
+
+void MainWindow::transcribeAudio(AudioBuffer::Ptr audio, std::shared_ptr<LatencyTrace> trace) {
+    // Queue it on the worker pool, same path for every engine, behind any
+    // take still waiting for room. The job shares the buffer, a spilled
+    // recording is decoded from its file.
+    m_pendingAudio.push_back({std::move(audio), std::move(trace)});
+    transcribePendingAudio();
+}
+
+void MainWindow::onTranscriptionQueueChanged(int queued, bool full) {
+    // takes the queue refused go in as soon as it has room again
+    if (!full) {
+        transcribePendingAudio();
     }
     
-    if (worker) {
-        connect(worker, &TranscriptionWorker::transcriptionComplete,
-                this, &MainWindow::onTranscriptionComplete);
-        connect(worker, &TranscriptionWorker::transcriptionError,
-                this, &MainWindow::onTranscriptionError);
-        connect(worker, &TranscriptionWorker::finished,
-                worker, &QObject::deleteLater);
-        
-        worker->start();
+    // backpressure: don't accept another recording the queue can't take
+    if (!m_isRecording) {
+        m_recordButton->setEnabled(!full);
+        m_recordButton->setToolTip(full ? QString("%1 recordings waiting to be transcribed").arg(queued)
+                                        : QString());
     }
 }
 
+void MainWindow::startStreaming() {
+    m_streamingWorker = new StreamingTranscriptionWorker(m_engine);
+    
+    // drained blocks arrive on the GUI thread, so this is a direct call
+    connect(m_audioRecorder.get(), &AudioRecorder::audioCaptured,
+            m_streamingWorker, &StreamingTranscriptionWorker::appendAudio);
+    connect(m_streamingWorker, &StreamingTranscriptionWorker::streamUpdate,
+            this, &MainWindow::onStreamUpdate);
+    connect(m_streamingWorker, &StreamingTranscriptionWorker::transcriptionError,
+            this, &MainWindow::onTranscriptionError);
+    connect(m_streamingWorker, &StreamingTranscriptionWorker::finished,
+            m_streamingWorker, &QObject::deleteLater);
+    
+    m_streamingWorker->start();
+}
+
+void MainWindow::finishStreaming(bool keepResult, std::shared_ptr<LatencyTrace> trace) {
+    disconnect(m_audioRecorder.get(), &AudioRecorder::audioCaptured,
+               m_streamingWorker, &StreamingTranscriptionWorker::appendAudio);
+    
+    if (keepResult) {
+        // the trace goes with this worker, a new take may start before it's done
+        connect(m_streamingWorker, &StreamingTranscriptionWorker::transcriptionComplete,
+                this, [this, trace](const QString& text) {
+            completeTranscription(text, trace);
+        });
+        m_streamingWorker->finish();
+    } else {
+        m_streamingWorker->cancel();
+    }
+    
+    // worker deletes itself once run() returns
+    m_streamingWorker = nullptr;
+}
+
+void MainWindow::onStreamUpdate(const QString& committed, const QString& partial) {
+    // committed text is final, the partial hypothesis may still change
+    QString html = committed.toHtmlEscaped();
+    if (!partial.isEmpty()) {
+        html += QString(" <span style='color: #888;'>%1</span>").arg(partial.toHtmlEscaped());
+    }
+    m_textDisplay->setHtml(html);
+    m_textDisplay->moveCursor(QTextCursor::End);
+}
+
 void MainWindow::updateRecordingTimer() {
     if (m_isRecording) {
         int msecs = m_recordingStartTime.msecsTo(QTime::currentTime());
@@ -450,6 +717,26 @@ void MainWindow::onTranscriptionComplete(const QString& text) {
     });
 }
 
+void MainWindow::completeTranscription(const QString& text, std::shared_ptr<LatencyTrace> trace) {
+    {
+        LatencyTrace::Scope traceScope(trace.get());
+        LatencyTrace::StageTimer timer("gui");
+        onTranscriptionComplete(text);
+    }
+    
+    if (!trace) {
+        return;
+    }
+    
+    Settings& settings = Settings::instance();
+    if (settings.latencyReadout()) {
+        m_latencyLabel->setText(trace->summary());
+    }
+    if (settings.latencyLog() && !trace->appendToLog()) {
+        qWarning() << "Could not write" << LatencyTrace::latencyLogPath();
+    }
+}
+
 void MainWindow::onTranscriptionError(const QString& error) {
     ErrorHandler::showTranscriptionError(this, error);
     setStatus("Error - Ready");
@@ -471,7 +758,7 @@ void MainWindow::onClearButtonClicked() {
 void MainWindow::onCopyButtonClicked() {
     QString text = m_textDisplay->toPlainText();
     if (!text.isEmpty()) {
-        FileExporter::copyToClipboard(text);
+        DesktopExporter::copyToClipboard(text);
         setStatus("✓ Copied to clipboard");
         
         QTimer::singleShot(2000, [this]() {
@@ -531,7 +818,7 @@ void MainWindow::onExportPDFClicked() {
                                                    "transcription.pdf",
                                                    "PDF Documents (*.pdf)");
     if (!filename.isEmpty()) {
-        if (FileExporter::exportToPDF(text, filename)) {
+        if (DesktopExporter::exportToPDF(text, filename)) {
             setStatus("✓ Exported to " + filename);
             QTimer::singleShot(3000, [this]() { setStatus("Ready"); });
         } else {
@@ -594,6 +881,7 @@ void MainWindow::onSettings() {
     }
     
     m_settingsDialog->exec();
+    statusBar()->setVisible(Settings::instance().latencyReadout());
 }
 
 void MainWindow::onAbout() {
@@ -624,6 +912,9 @@ void MainWindow::onModelChanged(const QString& modelName) {
 }
 
 void MainWindow::onModelsUpdated() {
+    // Forget cached models whose files were removed
+    m_modelCache->pruneMissing();
+    
     // Refresh model selector
     m_modelSelector->refreshAvailableModels();
 }
@@ -4,6 +4,9 @@
 #include <QMainWindow>
 #include <QThread>
 #include <QTime>
+#include "audio/AudioBuffer.h"
+#include "transcription/ModelCache.h"
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -15,12 +18,14 @@ class QProgressBar;
 class QTimer;
 class QMenuBar;
 class AudioRecorder;
-class WhisperTranscriber;
-class TranscriptionWorker;
+class TranscriptionEngine;
+class TranscriptionScheduler;
+class StreamingTranscriptionWorker;
 class ModelSelector;
 class ModelManager;
 class SettingsDialog;
-class VoskEngine;
+class ModelLoader;
+class LatencyTrace;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -29,6 +34,9 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
 private slots:
     // Button handlers
     void onRecordButtonClicked();
@@ -41,6 +49,8 @@ private slots:
     // Transcription handlers
     void onTranscriptionComplete(const QString& text);
     void onTranscriptionError(const QString& error);
+    void onStreamUpdate(const QString& committed, const QString& partial);
+    void onTranscriptionQueueChanged(int queued, bool full);
     
     // Audio handlers
     void updateAudioLevel(float level);
@@ -58,6 +68,8 @@ private slots:
     // Model selection
     void onModelChanged(const QString& modelName);
     void onModelsUpdated();
+    void onModelLoadProgress(int percent);
+    void onModelLoaded();
 
 private:
     void setupUI();
@@ -66,6 +78,15 @@ private:
     void stopRecording();
     void setStatus(const QString& status);
     void loadTranscriber(const QString& modelName);
+    QString modelPathFor(const QString& modelName) const;
+    void activateModel(const QString& modelName, const ModelCache::Entry& entry);
+    void onModelLoadFailed(const QString& modelName, const QString& error);
+    void finishModelLoad();
+    void transcribeAudio(AudioBuffer::Ptr audio, std::shared_ptr<LatencyTrace> trace);
+    void transcribePendingAudio();
+    void startStreaming();
+    void finishStreaming(bool keepResult, std::shared_ptr<LatencyTrace> trace);
+    void completeTranscription(const QString& text, std::shared_ptr<LatencyTrace> trace);
     
     // UI elements
     QPushButton* m_recordButton;
@@ -78,6 +99,7 @@ private:
     QLabel* m_statusLabel;
     QLabel* m_timerLabel;
     QLabel* m_footerLabel;
+    QLabel* m_latencyLabel;
     QProgressBar* m_audioLevel;
     ModelSelector* m_modelSelector;
     
@@ -87,8 +109,11 @@ private:
     
     // Core components
     std::unique_ptr<AudioRecorder> m_audioRecorder;
-    std::unique_ptr<WhisperTranscriber> m_whisperTranscriber;
-    std::unique_ptr<VoskEngine> m_voskEngine;
+    std::shared_ptr<TranscriptionEngine> m_engine;   // Whisper or Vosk
+    std::unique_ptr<ModelCache> m_modelCache;
+    ModelLoader* m_modelLoader;           // non-null while a model loads
+    TranscriptionScheduler* m_scheduler;
+    StreamingTranscriptionWorker* m_streamingWorker;
     
     // Timer for recording duration
     QTimer* m_recordingTimer;
@@ -97,7 +122,18 @@ private:
     // State tracking
     bool m_isRecording;
     QString m_currentModel;
-    std::vector<int16_t> m_audioBuffer;
+    
+    // Takes not submitted yet, recorded before the model was ready or
+    // refused by a full queue; submitted in order once they can be
+    struct PendingRecording {
+        AudioBuffer::Ptr audio;
+        std::shared_ptr<LatencyTrace> trace;
+    };
+    std::vector<PendingRecording> m_pendingAudio;
+    
+    // Latency traces, only created when the readout or log is enabled
+    std::shared_ptr<LatencyTrace> m_pendingTrace;   // last recording, not yet submitted
+    std::map<quint64, std::shared_ptr<LatencyTrace>> m_traces;   // by scheduler job
 };
 
 #endif // MAINWINDOW_H
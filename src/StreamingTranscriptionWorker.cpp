@@ -0,0 +1,98 @@
+#include "StreamingTranscriptionWorker.h"
+#include "transcription/TranscriptionEngine.h"
+#include <QDebug>
+
+StreamingTranscriptionWorker::StreamingTranscriptionWorker(std::shared_ptr<TranscriptionEngine> engine)
+    : m_engine(std::move(engine))
+    , m_finishing(false)
+    , m_cancelled(false) {
+}
+
+void StreamingTranscriptionWorker::appendAudio(const int16_t* samples, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.insert(m_pending.end(), samples, samples + count);
+    }
+    m_cond.notify_one();
+}
+
+void StreamingTranscriptionWorker::finish() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finishing = true;
+    }
+    m_cond.notify_one();
+}
+
+void StreamingTranscriptionWorker::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+    }
+    m_cond.notify_one();
+}
+
+void StreamingTranscriptionWorker::run() {
+    try {
+        // state of this recording only, a previous worker may still be
+        // decoding its tail on the same engine
+        std::unique_ptr<TranscriptionEngine::Stream> stream = m_engine->beginStream();
+        
+        QString committed;
+        std::vector<int16_t> chunk;
+        
+        for (;;) {
+            // 1a. wait for new audio or the end of the recording
+            bool finishing = false;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [this]() {
+                    return !m_pending.empty() || m_finishing || m_cancelled;
+                });
+                
+                if (m_cancelled) {
+                    return;
+                }
+                
+                chunk.swap(m_pending);
+                m_pending.clear();
+                finishing = m_finishing;
+            }
+            
+            // 1b. recording stopped, decode the tail in one go
+            if (finishing) {
+                TranscriptionEngine::StreamUpdate last =
+                    m_engine->finishStream(*stream, chunk.data(), chunk.size());
+                if (!last.committed.empty()) {
+                    if (!committed.isEmpty()) committed += " ";
+                    committed += QString::fromStdString(last.committed).trimmed();
+                }
+                break;
+            }
+            
+            // 1c. feed what arrived, may run a window decode
+            TranscriptionEngine::StreamUpdate update =
+                m_engine->feedStream(*stream, chunk.data(), chunk.size());
+            chunk.clear();
+            
+            // 1d. push new text to the GUI
+            if (update.updated) {
+                if (!update.committed.empty()) {
+                    if (!committed.isEmpty()) committed += " ";
+                    committed += QString::fromStdString(update.committed).trimmed();
+                }
+                emit streamUpdate(committed, QString::fromStdString(update.partial).trimmed());
+            }
+        }
+        
+        // 2a. everything is committed now
+        if (committed.isEmpty()) {
+            committed = "(No speech detected)";
+        }
+        
+        emit transcriptionComplete(committed);
+    
+    } catch (const std::exception& e) {
+        emit transcriptionError(QString("Transcription failed: %1").arg(e.what()));
+    }
+}
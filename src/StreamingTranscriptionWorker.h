@@ -0,0 +1,44 @@
+#ifndef STREAMINGTRANSCRIPTIONWORKER_H
+#define STREAMINGTRANSCRIPTIONWORKER_H
+
+#include <QThread>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TranscriptionEngine;
+
+// Runs an engine's streaming mode while recording. Audio is pushed
+// in from the GUI thread as it is captured; partial and committed text come
+// back through streamUpdate().
+class StreamingTranscriptionWorker : public QThread {
+    Q_OBJECT
+    
+public:
+    explicit StreamingTranscriptionWorker(std::shared_ptr<TranscriptionEngine> engine);
+    
+    // Called from the GUI thread
+    void appendAudio(const int16_t* samples, size_t count);
+    void finish();   // decode the tail and emit transcriptionComplete
+    void cancel();   // stop without emitting a result
+    
+protected:
+    void run() override;
+    
+signals:
+    void streamUpdate(const QString& committed, const QString& partial);
+    void transcriptionComplete(const QString& text);
+    void transcriptionError(const QString& error);
+    
+private:
+    std::shared_ptr<TranscriptionEngine> m_engine;
+    
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<int16_t> m_pending;   // captured but not yet fed
+    bool m_finishing;
+    bool m_cancelled;
+};
+
+#endif // STREAMINGTRANSCRIPTIONWORKER_H
@@ -1,12 +1,22 @@
 #include "WhisperTranscriber.h"
 #include "whisper.h"
+#include "audio/AudioDsp.h"
+#include "utils/LatencyTrace.h"
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <cstdio>
 #include <QDebug>
 #include <QFile>
 
 WhisperTranscriber::WhisperTranscriber() 
     : m_ctx(nullptr)
-    , m_modelPath("./models/ggml-base.bin") {
+    , m_modelPath("./models/ggml-base.bin")
+    , m_parallelDecoders(0)
+    , m_adaptiveAudioCtx(false) {
     
     if (!QFile::exists(m_modelPath)) {
         throw std::runtime_error(
@@ -15,19 +25,14 @@ WhisperTranscriber::WhisperTranscriber()
         );
     }
     
-    struct whisper_context_params cparams = whisper_context_default_params();
-    m_ctx = whisper_init_from_file_with_params(m_modelPath.toStdString().c_str(), cparams);
-    
-    if (!m_ctx) {
-        throw std::runtime_error("Failed to load Whisper model from " + m_modelPath.toStdString());
-    }
-    
-    qDebug() << "Whisper model loaded:" << m_modelPath;
+    loadModel(nullptr);
 }
 
-WhisperTranscriber::WhisperTranscriber(const QString& modelPath) 
+WhisperTranscriber::WhisperTranscriber(const QString& modelPath, LoadProgress progress) 
     : m_ctx(nullptr)
-    , m_modelPath(modelPath) {
+    , m_modelPath(modelPath)
+    , m_parallelDecoders(0)
+    , m_adaptiveAudioCtx(false) {
     
     if (!QFile::exists(m_modelPath)) {
         throw std::runtime_error(
@@ -35,8 +40,75 @@ WhisperTranscriber::WhisperTranscriber(const QString& modelPath)
         );
     }
     
+    loadModel(progress);
+}
+
+WhisperTranscriber::~WhisperTranscriber() {
+    if (m_ctx) {
+        whisper_free(m_ctx);
+    }
+}
+
+namespace {
+    // whisper_model_loader over a FILE* that reports how far the read got
+    struct ProgressReader {
+        FILE* file;
+        size_t total;
+        size_t done;
+        const WhisperTranscriber::LoadProgress* progress;
+        bool aborted;
+    };
+    
+    size_t progressRead(void* ctx, void* output, size_t size) {
+        auto* reader = static_cast<ProgressReader*>(ctx);
+        if (reader->aborted) {
+            return 0;
+        }
+        size_t n = fread(output, 1, size, reader->file);
+        reader->done += n;
+        if (reader->total > 0 && !(*reader->progress)(float(reader->done) / reader->total)) {
+            // a short read makes whisper_init fail cleanly
+            reader->aborted = true;
+            return 0;
+        }
+        return n;
+    }
+    
+    bool progressEof(void* ctx) {
+        auto* reader = static_cast<ProgressReader*>(ctx);
+        return reader->aborted || feof(reader->file);
+    }
+    
+    void progressClose(void* ctx) {
+        fclose(static_cast<ProgressReader*>(ctx)->file);
+    }
+}
+
+void WhisperTranscriber::loadModel(const LoadProgress& progress) {
     struct whisper_context_params cparams = whisper_context_default_params();
-    m_ctx = whisper_init_from_file_with_params(m_modelPath.toStdString().c_str(), cparams);
+    
+    if (!progress) {
+        m_ctx = whisper_init_from_file_with_params(m_modelPath.toStdString().c_str(), cparams);
+    } else {
+        // same as the file loader, but lets the GUI show a percentage
+        FILE* file = fopen(m_modelPath.toStdString().c_str(), "rb");
+        if (!file) {
+            throw std::runtime_error("Cannot open Whisper model: " + m_modelPath.toStdString());
+        }
+        
+        ProgressReader reader{file, static_cast<size_t>(QFile(m_modelPath).size()), 0, &progress, false};
+        whisper_model_loader loader;
+        loader.context = &reader;
+        loader.read = progressRead;
+        loader.eof = progressEof;
+        loader.close = progressClose;
+        
+        m_ctx = whisper_init_with_params(&loader, cparams);
+        
+        if (reader.aborted && !m_ctx) {
+            throw std::runtime_error("Loading cancelled: " + m_modelPath.toStdString());
+        }
+    }
     
     if (!m_ctx) {
         throw std::runtime_error("Failed to load Whisper model: " + m_modelPath.toStdString());
@@ -45,25 +117,331 @@ WhisperTranscriber::WhisperTranscriber(const QString& modelPath)
     qDebug() << "Whisper model loaded:" << m_modelPath;
 }
 
-WhisperTranscriber::~WhisperTranscriber() {
-    if (m_ctx) {
-        whisper_free(m_ctx);
+TranscriptionEngine::Capabilities WhisperTranscriber::capabilities() const {
+    Capabilities caps;
+    caps.streaming = true;
+    caps.timestamps = true;
+    caps.confidences = true;
+    return caps;
+}
+
+namespace {
+    // a whisper_state per scheduler worker, sharing the loaded model
+    struct WhisperWorkspace : public TranscriptionEngine::Workspace {
+        whisper_state* state = nullptr;
+        std::vector<float> scratch;   // float conversion, reused across jobs
+        
+        ~WhisperWorkspace() override {
+            if (state) {
+                whisper_free_state(state);
+            }
+        }
+    };
+    
+    bool abortRequested(void* data) {
+        return static_cast<const std::atomic<bool>*>(data)->load();
+    }
+    
+    // Marks when the first encoder pass starts; everything before it is
+    // mel spectrogram computation
+    bool markEncoderBegin(whisper_context*, whisper_state*, void* data) {
+        auto* begin = static_cast<std::chrono::steady_clock::time_point*>(data);
+        if (*begin == std::chrono::steady_clock::time_point()) {
+            *begin = std::chrono::steady_clock::now();
+        }
+        return true;
+    }
+}
+
+std::unique_ptr<TranscriptionEngine::Workspace> WhisperTranscriber::createWorkspace() {
+    if (!m_ctx) {
+        throw std::runtime_error("Whisper context not initialized");
+    }
+    
+    auto workspace = std::make_unique<WhisperWorkspace>();
+    workspace->state = whisper_init_state(m_ctx);
+    if (!workspace->state) {
+        throw std::runtime_error("Failed to create Whisper decoder state");
     }
+    return workspace;
 }
 
-std::string WhisperTranscriber::transcribe(const std::vector<int16_t>& audioData) {
+std::vector<WhisperTranscriber::Segment> WhisperTranscriber::transcribeSegments(
+        const std::vector<int16_t>& audioData) {
+    // one-off call without a workspace, so nothing to share or reuse
+    std::vector<float> scratch;
+    return decode(*AudioBuffer::create(audioData), nullptr, 0, nullptr, scratch);
+}
+
+std::vector<WhisperTranscriber::Segment> WhisperTranscriber::transcribeWith(
+        const AudioBuffer& audio, Workspace& workspace) {
+    auto* whisperWorkspace = dynamic_cast<WhisperWorkspace*>(&workspace);
+    if (!whisperWorkspace) {
+        std::vector<float> scratch;
+        return decode(audio, nullptr, workspace.threads, &workspace.cancelRequested, scratch);
+    }
+    return decode(audio, whisperWorkspace->state, workspace.threads,
+                  &workspace.cancelRequested, whisperWorkspace->scratch);
+}
+
+std::vector<WhisperTranscriber::Segment> WhisperTranscriber::decode(
+        const AudioBuffer& audio, whisper_state* state, int threads,
+        std::atomic<bool>* cancel, std::vector<float>& scratch) {
     if (!m_ctx) {
         throw std::runtime_error("Whisper context not initialized");
     }
     
-    if (audioData.empty()) {
-        return "";
+    const size_t count = audio.size();
+    if (count == 0) {
+        return {};
+    }
+    
+    // 2a. long audio fans out over several decoder states, and very long
+    //     audio is converted one chunk at a time even on a single decoder
+    //     so memory doesn't grow with the recording
+    int threadBudget = threads > 0 ? threads
+                                   : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int decoders = decoderCount(count, threadBudget);
+    if (decoders > 1 || count >= static_cast<size_t>(SAMPLE_RATE) * CHUNKED_MIN_MS / 1000) {
+        LatencyTrace::StageTimer timer("inference");
+        return transcribeParallel(audio, decoders, threadBudget, cancel, state);
+    }
+    
+    // 2b. float samples: the capture-time view if the recorder made one,
+    //     else converted into the workspace's scratch buffer
+    const float* pcm;
+    {
+        LatencyTrace::StageTimer timer("convert");
+        pcm = audio.toFloat(0, count, scratch);
+    }
+    
+    // 2c. setup whisper params
+    whisper_full_params params = defaultParams();
+    params.no_context = false;       // use context for better accuracy
+    if (threads > 0) {
+        params.n_threads = threads;
+    }
+    if (cancel) {
+        params.abort_callback = abortRequested;
+        params.abort_callback_user_data = cancel;
+    }
+    
+    // 2d. short clips don't need the full 30 s encoder window
+    int audioCtx = m_adaptiveAudioCtx ? audioContextFor(count) : 0;
+    if (audioCtx > 0) {
+        params.audio_ctx = audioCtx;
+        std::vector<Segment> segments = runFull(params, pcm, count, state);
+        
+        // 2e. accuracy guard: a truncated context that comes back unsure
+        //     gets a second pass with the full context. Nothing at all is
+        //     believed for silence and clicks, and only retried if the
+        //     clip is loud enough to hold speech.
+        float confidence = meanConfidence(segments);
+        bool retry = segments.empty()
+            ? AudioDsp::calculateRMS(audio.samples(), count) >= AUDIO_CTX_RETRY_MIN_RMS
+            : confidence < AUDIO_CTX_MIN_CONFIDENCE;
+        if (!retry) {
+            return segments;
+        }
+        
+        qDebug() << "audio_ctx" << audioCtx << "confidence" << confidence
+                 << (segments.empty() ? "empty," : "too low,") << "retrying with full context";
+        params.audio_ctx = 0;
+    }
+    
+    // 2f. run transcription
+    return runFull(params, pcm, count, state);
+}
+
+void WhisperTranscriber::setAdaptiveAudioContext(bool enabled) {
+    m_adaptiveAudioCtx = enabled;
+}
+
+int WhisperTranscriber::audioContextFor(size_t samples) const {
+    // 8a. one encoder frame per 20 ms, plus some margin for the tail
+    const int64_t ms = static_cast<int64_t>(samples) * 1000 / SAMPLE_RATE + AUDIO_CTX_MARGIN_MS;
+    int ctx = static_cast<int>((ms + AUDIO_CTX_MS_PER_FRAME - 1) / AUDIO_CTX_MS_PER_FRAME);
+    
+    // 8b. round up to a safe granularity
+    ctx = (ctx + AUDIO_CTX_GRANULARITY - 1) / AUDIO_CTX_GRANULARITY * AUDIO_CTX_GRANULARITY;
+    ctx = std::max(ctx, AUDIO_CTX_MIN);
+    
+    // 8c. 0 means "use the model's full context"
+    return ctx >= whisper_n_audio_ctx(m_ctx) ? 0 : ctx;
+}
+
+float WhisperTranscriber::meanConfidence(const std::vector<Segment>& segments) {
+    if (segments.empty()) {
+        return 0.0f;
+    }
+    
+    float sum = 0.0f;
+    for (const Segment& segment : segments) {
+        sum += segment.confidence;
+    }
+    return sum / segments.size();
+}
+
+void WhisperTranscriber::setParallelDecoders(int decoders) {
+    m_parallelDecoders = std::max(0, decoders);
+}
+
+int WhisperTranscriber::decoderCount(size_t samples, int threadBudget) const {
+    if (samples < static_cast<size_t>(SAMPLE_RATE) * PARALLEL_MIN_MS / 1000) {
+        return 1;
+    }
+    
+    int decoders = m_parallelDecoders;
+    if (decoders == 0) {
+        decoders = std::min(MAX_DECODERS, std::max(1, threadBudget / THREADS_PER_DECODER));
+    }
+    
+    // no point in more decoders than chunks
+    size_t chunks = samples / (static_cast<size_t>(SAMPLE_RATE) * CHUNK_TARGET_MS / 1000) + 1;
+    return static_cast<int>(std::min<size_t>(decoders, chunks));
+}
+
+std::vector<size_t> WhisperTranscriber::findChunkBoundaries(const int16_t* samples, size_t count) {
+    // 6a. short-time energy on 10 ms frames, only compared so unscaled
+    const size_t frame = SAMPLE_RATE * ENERGY_FRAME_MS / 1000;
+    const size_t nFrames = count / frame;
+    std::vector<float> energy(nFrames);
+    for (size_t f = 0; f < nFrames; ++f) {
+        float sum = 0.0f;
+        for (size_t i = f * frame; i < (f + 1) * frame; ++i) {
+            float sample = samples[i];
+            sum += sample * sample;
+        }
+        energy[f] = sum;
+    }
+    
+    // 6b. walk forward in ~30 s steps, cutting at the quietest frame in the
+    //     last few seconds before each target so words aren't split. No
+    //     chunk is longer than the target, so whisper never splits one
+    //     itself at 30 s.
+    const size_t target = CHUNK_TARGET_MS / ENERGY_FRAME_MS;
+    const size_t search = CHUNK_SEARCH_MS / ENERGY_FRAME_MS;
+    const size_t minTail = CHUNK_MIN_MS / ENERGY_FRAME_MS;
+    
+    std::vector<size_t> boundaries;
+    boundaries.push_back(0);
+    
+    size_t start = 0;
+    while (count > (start + target) * frame) {
+        // 6c. a cut that would leave a tiny last chunk moves back and hands
+        //     it some of this chunk instead
+        size_t end = start + target;
+        size_t latest = std::min(end, nFrames - std::min(nFrames, minTail));
+        size_t best = std::max(latest, start + 1);
+        for (size_t f = end - search; f <= latest; ++f) {
+            if (energy[f] < energy[best]) {
+                best = f;
+            }
+        }
+        boundaries.push_back(best * frame);
+        start = best;
     }
     
-    // 2a. convert int16 to float
-    std::vector<float> floatData = convertToFloat(audioData);
+    boundaries.push_back(count);
+    return boundaries;
+}
+
+std::vector<WhisperTranscriber::Segment> WhisperTranscriber::transcribeParallel(
+        const AudioBuffer& audio, int decoders, int threadBudget,
+        std::atomic<bool>* cancel, whisper_state* workspaceState) {
+    std::vector<size_t> bounds = findChunkBoundaries(audio.samples(), audio.size());
+    const size_t nChunks = bounds.size() - 1;
+    decoders = std::min<int>(decoders, static_cast<int>(nChunks));
+    
+    int threadsPerDecoder = std::max(1, threadBudget / decoders);
+    
+    qDebug() << "Parallel transcription:" << nChunks << "chunks on"
+             << decoders << "decoders x" << threadsPerDecoder << "threads";
+    
+    // 7a. each chunk's segments land in its own slot so the merge keeps order
+    std::vector<std::vector<Segment>> results(nChunks);
+    std::atomic<size_t> nextChunk(0);
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+    
+    auto worker = [&](whisper_state* borrowed) {
+        // 7b. one whisper_state per decoder, all sharing the loaded model;
+        //     the first decoder reuses the caller's workspace state
+        whisper_state* state = borrowed ? borrowed : whisper_init_state(m_ctx);
+        if (!state) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!firstError) {
+                firstError = std::make_exception_ptr(
+                    std::runtime_error("Failed to create Whisper decoder state"));
+            }
+            return;
+        }
+        
+        whisper_full_params params = defaultParams();
+        params.n_threads = threadsPerDecoder;
+        params.no_context = true;    // chunks are decoded independently
+        if (cancel) {
+            params.abort_callback = abortRequested;
+            params.abort_callback_user_data = cancel;
+        }
+        
+        // 7c. without a capture-time float view only the chunk being
+        //     decoded is ever held as float
+        std::vector<float> chunkSamples;
+        
+        for (size_t chunk = nextChunk++; chunk < nChunks; chunk = nextChunk++) {
+            if (cancel && *cancel) {
+                break;
+            }
+            
+            const size_t begin = bounds[chunk];
+            const size_t length = bounds[chunk + 1] - begin;
+            const float* pcm = audio.toFloat(begin, length, chunkSamples);
+            
+            int result = whisper_full_with_state(m_ctx, state, params, pcm,
+                                                 static_cast<int>(length));
+            if (result != 0) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!firstError) {
+                    firstError = std::make_exception_ptr(std::runtime_error(
+                        "Whisper transcription failed with code: " + std::to_string(result)));
+                }
+                break;
+            }
+            
+            // 7d. shift chunk-local timestamps onto the recording timeline
+            const int64_t offsetMs = static_cast<int64_t>(begin) * 1000 / SAMPLE_RATE;
+            results[chunk] = collectSegments(state, offsetMs);
+        }
+        
+        if (!borrowed) {
+            whisper_free_state(state);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (int i = 0; i < decoders; ++i) {
+        threads.emplace_back(worker, i == 0 ? workspaceState : nullptr);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
     
-    // 2b. setup whisper params
+    // 7e. merge in chunk order
+    std::vector<Segment> merged;
+    for (std::vector<Segment>& chunk : results) {
+        merged.insert(merged.end(),
+                      std::make_move_iterator(chunk.begin()),
+                      std::make_move_iterator(chunk.end()));
+    }
+    return merged;
+}
+
+whisper_full_params WhisperTranscriber::defaultParams() const {
     whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
     
     params.n_threads = 4;           // use 4 CPU threads
@@ -72,44 +450,274 @@ std::string WhisperTranscriber::transcribe(const std::vector<int16_t>& audioData
     params.print_progress = false;
     params.print_timestamps = false;
     params.single_segment = false;   // allow multiple segments
-    params.no_context = false;       // use context for better accuracy
     
-    // 2c. run transcription
-    int result = whisper_full(m_ctx, params, floatData.data(), floatData.size());
+    return params;
+}
+
+std::vector<WhisperTranscriber::Segment> WhisperTranscriber::runFull(
+        const whisper_full_params& params, const float* samples, size_t count,
+        whisper_state* state) {
+    // a private state needs no lock, the shared context does
+    std::unique_lock<std::mutex> lock(m_ctxMutex, std::defer_lock);
+    if (!state) {
+        lock.lock();
+    }
+    
+    // traced: split whisper_full at the first encoder pass into mel and
+    // encode+decode. whisper's own counters live in the state and aren't
+    // readable for a private one, so this works the same for both paths.
+    LatencyTrace* trace = LatencyTrace::current();
+    whisper_full_params tracedParams = params;
+    std::chrono::steady_clock::time_point start, encoderBegin;
+    if (trace) {
+        tracedParams.encoder_begin_callback = markEncoderBegin;
+        tracedParams.encoder_begin_callback_user_data = &encoderBegin;
+        start = std::chrono::steady_clock::now();
+    }
+    
+    int result = state
+        ? whisper_full_with_state(m_ctx, state, tracedParams, samples, static_cast<int>(count))
+        : whisper_full(m_ctx, tracedParams, samples, static_cast<int>(count));
+    
+    if (trace) {
+        auto end = std::chrono::steady_clock::now();
+        if (encoderBegin == std::chrono::steady_clock::time_point()) {
+            encoderBegin = end;     // aborted before encoding
+        }
+        trace->add("mel", std::chrono::duration<double, std::milli>(encoderBegin - start).count());
+        trace->add("inference", std::chrono::duration<double, std::milli>(end - encoderBegin).count());
+    }
     
     if (result != 0) {
         throw std::runtime_error("Whisper transcription failed with code: " + std::to_string(result));
     }
     
-    // 2d. collect all segments into result string
-    std::string transcription;
-    const int n_segments = whisper_full_n_segments(m_ctx);
+    return collectSegments(state, 0);
+}
+
+std::vector<WhisperTranscriber::Segment> WhisperTranscriber::collectSegments(
+        whisper_state* state, int64_t offsetMs) const {
+    // collect segments, whisper timestamps are in 10 ms units.
+    // state == nullptr reads the context's default state.
+    std::vector<Segment> segments;
+    const int n_segments = state ? whisper_full_n_segments_from_state(state)
+                                 : whisper_full_n_segments(m_ctx);
+    segments.reserve(n_segments);
     
     for (int i = 0; i < n_segments; ++i) {
-        const char* text = whisper_full_get_segment_text(m_ctx, i);
+        const char* text = state ? whisper_full_get_segment_text_from_state(state, i)
+                                 : whisper_full_get_segment_text(m_ctx, i);
         if (text) {
-            transcription += text;
-            transcription += " ";
+            float p = 0.0f;
+            const int n_tokens = state ? whisper_full_n_tokens_from_state(state, i)
+                                       : whisper_full_n_tokens(m_ctx, i);
+            for (int t = 0; t < n_tokens; ++t) {
+                p += state ? whisper_full_get_token_p_from_state(state, i, t)
+                           : whisper_full_get_token_p(m_ctx, i, t);
+            }
+            
+            int64_t t0 = state ? whisper_full_get_segment_t0_from_state(state, i)
+                               : whisper_full_get_segment_t0(m_ctx, i);
+            int64_t t1 = state ? whisper_full_get_segment_t1_from_state(state, i)
+                               : whisper_full_get_segment_t1(m_ctx, i);
+            
+            segments.push_back({
+                text,
+                offsetMs + t0 * 10,
+                offsetMs + t1 * 10,
+                n_tokens > 0 ? p / n_tokens : 0.0f
+            });
+        }
+    }
+    
+    return segments;
+}
+
+// One recording's streaming state, only touched by the thread driving it.
+// Its own whisper_state, so the window's tokens can still be read after
+// the decode and streams never queue on the shared context.
+struct WhisperTranscriber::WhisperStream : public TranscriptionEngine::Stream {
+    whisper_state* state = nullptr;
+    std::vector<float> audio;     // audio not yet committed
+    size_t pending = 0;           // samples since the last decode
+    std::string prompt;           // tail of committed text
+    
+    ~WhisperStream() override {
+        if (state) {
+            whisper_free_state(state);
         }
     }
+};
+
+std::unique_ptr<TranscriptionEngine::Stream> WhisperTranscriber::beginStream() {
+    if (!m_ctx) {
+        throw std::runtime_error("Whisper context not initialized");
+    }
+    
+    auto stream = std::make_unique<WhisperStream>();
+    stream->state = whisper_init_state(m_ctx);
+    if (!stream->state) {
+        throw std::runtime_error("Failed to create Whisper decoder state");
+    }
+    stream->audio.reserve(SAMPLE_RATE * (STREAM_WINDOW_MS + STREAM_STEP_MS) / 1000);
+    return stream;
+}
+
+WhisperTranscriber::WhisperStream& WhisperTranscriber::streamState(Stream& stream) {
+    auto* whisperStream = dynamic_cast<WhisperStream*>(&stream);
+    if (!whisperStream) {
+        throw std::logic_error("Stream was not started by the Whisper engine");
+    }
+    return *whisperStream;
+}
+
+WhisperTranscriber::StreamUpdate WhisperTranscriber::feedStream(Stream& stream, const int16_t* samples,
+                                                                size_t count) {
+    WhisperStream& state = streamState(stream);
+    
+    // 3a. accumulate uncommitted audio
+    appendStreamAudio(state, samples, count);
+    
+    // 3b. only decode once a full step of new audio is in
+    if (state.pending < static_cast<size_t>(SAMPLE_RATE * STREAM_STEP_MS / 1000)) {
+        return {};
+    }
+    
+    return decodeWindow(state, false);
+}
+
+WhisperTranscriber::StreamUpdate WhisperTranscriber::finishStream(Stream& stream, const int16_t* samples,
+                                                                  size_t count) {
+    WhisperStream& state = streamState(stream);
+    appendStreamAudio(state, samples, count);
+    
+    // 4a. whatever is left is at most one window + one step long, so the
+    //     stop-to-text latency doesn't grow with recording length
+    if (state.audio.empty()) {
+        StreamUpdate update;
+        update.updated = true;
+        return update;
+    }
+    
+    return decodeWindow(state, true);
+}
+
+void WhisperTranscriber::appendStreamAudio(WhisperStream& stream, const int16_t* samples, size_t count) {
+    size_t offset = stream.audio.size();
+    stream.audio.resize(offset + count);
+    AudioDsp::convertToFloat(samples, stream.audio.data() + offset, count);
+    stream.pending += count;
+}
+
+WhisperTranscriber::StreamUpdate WhisperTranscriber::decodeWindow(WhisperStream& stream, bool final) {
+    if (!m_ctx) {
+        throw std::runtime_error("Whisper context not initialized");
+    }
+    
+    stream.pending = 0;
+    
+    // 5a. each window is decoded on its own; the committed tail goes in as a
+    //     prompt instead of whisper's token context, which tends to loop on
+    //     repeated overlapping audio
+    whisper_full_params params = defaultParams();
+    params.no_context = true;
+    params.token_timestamps = true;   // where to split a window that is one segment
+    params.initial_prompt = stream.prompt.empty() ? nullptr : stream.prompt.c_str();
+    
+    std::vector<Segment> segments = runFull(params, stream.audio.data(), stream.audio.size(), stream.state);
+    
+    StreamUpdate update;
+    update.updated = true;
+    
+    const size_t windowSamples = static_cast<size_t>(SAMPLE_RATE) * STREAM_WINDOW_MS / 1000;
     
-    // 2e. trim trailing space
-    if (!transcription.empty() && transcription.back() == ' ') {
-        transcription.pop_back();
+    if (final) {
+        // 5b. end of stream, everything is committed
+        update.committed = joinSegments(segments, 0, segments.size());
+        stream.audio.clear();
+    } else if (stream.audio.size() >= windowSamples && !segments.empty()) {
+        // 5c. window is full: commit all but the last segment, which may end
+        //     in a word cut off at the window edge, and slide the window up
+        //     to where that segment starts
+        size_t keep = segments.size() - 1;
+        update.committed = joinSegments(segments, 0, keep);
+        update.partial = joinSegments(segments, keep, segments.size());
+        int64_t cutMs = segments[keep].startMs;
+        
+        // 5d. one segment (ten seconds of unbroken speech) starts where the
+        //     window does: commit its words up to the last one instead
+        if (keep == 0) {
+            std::string head, tail;
+            if (splitBeforeLastWord(stream.state, head, tail, cutMs)) {
+                update.committed = head;
+                update.partial = tail;
+            }
+        }
+        
+        size_t cut = static_cast<size_t>(std::max<int64_t>(0, cutMs)) * SAMPLE_RATE / 1000;
+        cut = std::min(cut, stream.audio.size());
+        stream.audio.erase(stream.audio.begin(), stream.audio.begin() + cut);
+    } else if (stream.audio.size() >= windowSamples) {
+        // 5e. a full window with no speech in it: slide it anyway, keeping
+        //     only the overlap, so silence doesn't grow the buffer
+        size_t keep = static_cast<size_t>(SAMPLE_RATE) * STREAM_KEEP_MS / 1000;
+        stream.audio.erase(stream.audio.begin(), stream.audio.end() - keep);
+    } else {
+        // 5f. window still growing, everything is tentative
+        update.partial = joinSegments(segments, 0, segments.size());
     }
     
-    return transcription;
+    // 5g. remember the committed tail as the next prompt, trimmed at the
+    //     start of a UTF-8 character so the tokenizer gets valid text
+    if (!update.committed.empty()) {
+        stream.prompt += " " + update.committed;
+        if (stream.prompt.size() > STREAM_PROMPT_CHARS) {
+            size_t trim = stream.prompt.size() - STREAM_PROMPT_CHARS;
+            while (trim < stream.prompt.size()
+                   && (static_cast<unsigned char>(stream.prompt[trim]) & 0xC0) == 0x80) {
+                ++trim;
+            }
+            stream.prompt.erase(0, trim);
+        }
+    }
+    
+    return update;
 }
 
-std::vector<float> WhisperTranscriber::convertToFloat(const std::vector<int16_t>& pcm) {
-    // 3a. convert 16-bit PCM to float [-1.0, 1.0]
-    std::vector<float> result(pcm.size());
+bool WhisperTranscriber::splitBeforeLastWord(whisper_state* state, std::string& head,
+                                             std::string& tail, int64_t& cutMs) const {
+    // tokens of the first segment; a new word is a text token starting with
+    // a space, and ids from end-of-text up are special or timestamps
+    const whisper_token eot = whisper_token_eot(m_ctx);
+    const int nTokens = whisper_full_n_tokens_from_state(state, 0);
+    
+    int lastWord = -1;
+    bool seenText = false;
+    for (int t = 0; t < nTokens; ++t) {
+        if (whisper_full_get_token_data_from_state(state, 0, t).id >= eot) {
+            continue;
+        }
+        const char* text = whisper_full_get_token_text_from_state(m_ctx, state, 0, t);
+        if (seenText && text && text[0] == ' ') {
+            lastWord = t;
+        }
+        seenText = true;
+    }
     
-    for (size_t i = 0; i < pcm.size(); ++i) {
-        result[i] = static_cast<float>(pcm[i]) / 32768.0f;
+    // a single word: nothing to commit yet
+    if (lastWord < 0) {
+        return false;
     }
     
-    return result;
+    for (int t = 0; t < nTokens; ++t) {
+        if (whisper_full_get_token_data_from_state(state, 0, t).id >= eot) {
+            continue;
+        }
+        const char* text = whisper_full_get_token_text_from_state(m_ctx, state, 0, t);
+        (t < lastWord ? head : tail) += text ? text : "";
+    }
+    cutMs = whisper_full_get_token_data_from_state(state, 0, lastWord).t0 * 10;
+    return true;
 }
 
 bool WhisperTranscriber::isModelLoaded() const {
@@ -1,32 +1,108 @@
 #ifndef WHISPERTRANSCRIBER_H
 #define WHISPERTRANSCRIBER_H
 
+#include "transcription/TranscriptionEngine.h"
 #include <QString>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 // Forward declare Whisper types
 struct whisper_context;
+struct whisper_state;
+struct whisper_full_params;
 
-class WhisperTranscriber {
+class WhisperTranscriber : public TranscriptionEngine {
 public:
+    // Called while the model file is read with the fraction loaded (0..1).
+    // Returning false aborts the load.
+    using LoadProgress = std::function<bool(float)>;
+    
     WhisperTranscriber();
-    explicit WhisperTranscriber(const QString& modelPath);
-    ~WhisperTranscriber();
+    explicit WhisperTranscriber(const QString& modelPath, LoadProgress progress = nullptr);
+    ~WhisperTranscriber() override;
+    
+    QString name() const override { return "Whisper"; }
+    Capabilities capabilities() const override;
+    
+    // Per-segment timestamps are in ms from start of audio.
+    // Long recordings are split at silence and decoded in parallel.
+    std::vector<Segment> transcribeSegments(const std::vector<int16_t>& audioData) override;
+    
+    // Workspaces own a whisper_state, so jobs in different workspaces
+    // decode concurrently instead of queueing on the shared context
+    std::unique_ptr<Workspace> createWorkspace() override;
+    std::vector<Segment> transcribeWith(const AudioBuffer& audio, Workspace& workspace) override;
+    
+    // Number of whisper_state decoders used for long audio (0 = auto)
+    void setParallelDecoders(int decoders);
+    
+    // Shrink the encoder context to the clip length for short clips
+    void setAdaptiveAudioContext(bool enabled);
+    int audioContextFor(size_t samples) const;
     
-    // Main transcription method
-    std::string transcribe(const std::vector<int16_t>& audioData);
+    // Streaming mode: sliding window over live capture
+    std::unique_ptr<Stream> beginStream() override;
+    StreamUpdate feedStream(Stream& stream, const int16_t* samples, size_t count) override;
+    StreamUpdate finishStream(Stream& stream, const int16_t* samples, size_t count) override;
     
     // Check if model is loaded
-    bool isModelLoaded() const;
+    bool isModelLoaded() const override;
     
 private:
-    // Convert int16 PCM to float samples for Whisper
-    std::vector<float> convertToFloat(const std::vector<int16_t>& pcm);
+    struct WhisperStream;
+    
+    void loadModel(const LoadProgress& progress);
+    
+    whisper_full_params defaultParams() const;
+    std::vector<Segment> decode(const AudioBuffer& audio, whisper_state* state, int threads,
+                                std::atomic<bool>* cancel, std::vector<float>& scratch);
+    std::vector<Segment> runFull(const whisper_full_params& params,
+                                 const float* samples, size_t count,
+                                 whisper_state* state = nullptr);
+    std::vector<Segment> collectSegments(whisper_state* state, int64_t offsetMs) const;
+    static WhisperStream& streamState(Stream& stream);
+    static void appendStreamAudio(WhisperStream& stream, const int16_t* samples, size_t count);
+    StreamUpdate decodeWindow(WhisperStream& stream, bool final);
+    bool splitBeforeLastWord(whisper_state* state, std::string& head, std::string& tail,
+                             int64_t& cutMs) const;
+    std::vector<Segment> transcribeParallel(const AudioBuffer& audio, int decoders,
+                                            int threadBudget, std::atomic<bool>* cancel,
+                                            whisper_state* workspaceState);
+    static std::vector<size_t> findChunkBoundaries(const int16_t* samples, size_t count);
+    int decoderCount(size_t samples, int threadBudget) const;
+    static float meanConfidence(const std::vector<Segment>& segments);
     
     whisper_context* m_ctx;
     QString m_modelPath;
+    std::mutex m_ctxMutex;   // whisper_full on the shared context isn't reentrant
+    int m_parallelDecoders;
+    bool m_adaptiveAudioCtx;
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr int STREAM_STEP_MS = 2000;     // decode every 2 s of new audio
+    static constexpr int STREAM_WINDOW_MS = 10000;  // commit once the window is this long
+    static constexpr int STREAM_KEEP_MS = 200;      // kept when sliding over silence
+    static constexpr size_t STREAM_PROMPT_CHARS = 200;
+    
+    static constexpr int THREADS_PER_DECODER = 4;
+    static constexpr int MAX_DECODERS = 8;          // each state carries its own KV cache
+    static constexpr int PARALLEL_MIN_MS = 60000;   // below this one decoder is fine
+    static constexpr int CHUNKED_MIN_MS = 600000;   // above this never convert the whole buffer
+    static constexpr int CHUNK_TARGET_MS = 30000;   // whisper's native window
+    static constexpr int CHUNK_SEARCH_MS = 5000;    // look this far back for silence
+    static constexpr int CHUNK_MIN_MS = 2000;       // shortest last chunk
+    static constexpr int ENERGY_FRAME_MS = 10;
+    
+    static constexpr int AUDIO_CTX_MS_PER_FRAME = 20;    // encoder: 1500 frames per 30 s
+    static constexpr int AUDIO_CTX_GRANULARITY = 64;
+    static constexpr int AUDIO_CTX_MIN = 256;            // tiny contexts degrade badly
+    static constexpr int AUDIO_CTX_MARGIN_MS = 500;
+    static constexpr float AUDIO_CTX_MIN_CONFIDENCE = 0.55f;
+    static constexpr float AUDIO_CTX_RETRY_MIN_RMS = 0.003f;    // ~-50 dBFS, below is silence
 };
 
 #endif // WHISPERTRANSCRIBER_H
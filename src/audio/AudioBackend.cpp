@@ -0,0 +1,21 @@
+#include "AudioBackend.h"
+#include "PulseAsyncBackend.h"
+#include "PulseSimpleBackend.h"
+#include <QDebug>
+#include <stdexcept>
+
+std::unique_ptr<AudioBackend> AudioBackend::create(const QString& type, const Config& config) {
+    if (type == "async") {
+        try {
+            return std::make_unique<PulseAsyncBackend>(config);
+        } catch (const std::exception& e) {
+            qWarning() << "Async PulseAudio backend unavailable, falling back to pa_simple:" << e.what();
+        }
+    }
+    
+    return std::make_unique<PulseSimpleBackend>(config);
+}
+
+std::vector<AudioBackend::Device> AudioBackend::devices() {
+    return PulseAsyncBackend::listSources();
+}
@@ -0,0 +1,60 @@
+#ifndef AUDIOBACKEND_H
+#define AUDIOBACKEND_H
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Capture backend used by AudioRecorder. Implementations deliver interleaved
+// S16LE samples in the format requested through Config, or the device's
+// own format where that was left at 0 (see sampleRate() / channels()).
+class AudioBackend {
+public:
+    struct Config {
+        int sampleRate = 16000;  // 0 = whatever the device runs at
+        int channels = 1;        // 0 = the device's channel count
+        int latencyMs = 20;      // fragment size the server should deliver
+        int bufferMs = 500;      // max server-side buffering before dropping
+        QString device;          // empty = server default
+    };
+    
+    struct Device {
+        QString name;            // for Config::device
+        QString description;     // for people
+    };
+    
+    virtual ~AudioBackend() = default;
+    
+    // Begin delivering fresh audio. Anything buffered while idle is dropped.
+    virtual void start() = 0;
+    
+    // Stop delivering audio. Wakes up a reader blocked in read().
+    virtual void stop() = 0;
+    
+    // Block until `samples` samples have been read. Returns false when the
+    // backend was stopped (error left empty) or on failure (error set).
+    virtual bool read(int16_t* buffer, size_t samples, QString& error) = 0;
+    
+    // Format read() delivers; samples above are interleaved values, so a
+    // frame is channels() of them
+    virtual int sampleRate() const = 0;
+    virtual int channels() const = 0;
+    
+    // Measured capture latency in milliseconds, or -1 if unknown.
+    virtual double latencyMs() const = 0;
+    
+    virtual QString name() const = 0;
+    
+    // Pick a backend by name ("async" or "simple"). Falls back to the
+    // simple backend if the async one can't be brought up.
+    static std::unique_ptr<AudioBackend> create(const QString& type, const Config& config);
+    
+    // Capture devices the server knows, monitors of outputs left out.
+    // Empty if the server can't be reached. Can take a couple of seconds
+    // against a server that stalls, so not from the GUI thread.
+    static std::vector<Device> devices();
+};
+
+#endif // AUDIOBACKEND_H
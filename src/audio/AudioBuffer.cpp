@@ -0,0 +1,56 @@
+#include "AudioBuffer.h"
+#include "AudioDsp.h"
+#include "DiskRecording.h"
+
+AudioBuffer::Ptr AudioBuffer::create(std::vector<int16_t> samples, std::vector<float> floats,
+                                     SpeechSpans speech) {
+    std::shared_ptr<AudioBuffer> buffer(new AudioBuffer());
+    buffer->m_owned = std::move(samples);
+    buffer->m_samples = buffer->m_owned.data();
+    buffer->m_size = buffer->m_owned.size();
+    
+    // a view that doesn't line up would be worse than none
+    if (floats.size() == buffer->m_size) {
+        buffer->m_floats = std::move(floats);
+    }
+    buffer->m_speech = std::move(speech);
+    return buffer;
+}
+
+AudioBuffer::Ptr AudioBuffer::create(std::shared_ptr<const DiskRecording> recording,
+                                     SpeechSpans speech) {
+    std::shared_ptr<AudioBuffer> buffer(new AudioBuffer());
+    if (recording) {
+        buffer->m_samples = recording->samples();
+        buffer->m_size = recording->sampleCount();
+        buffer->m_recording = std::move(recording);
+    }
+    buffer->m_speech = std::move(speech);
+    return buffer;
+}
+
+const float* AudioBuffer::toFloat(size_t begin, size_t count, std::vector<float>& scratch) const {
+    if (!m_floats.empty()) {
+        return m_floats.data() + begin;
+    }
+    
+    // grows to the largest request and stays there, so a caller that keeps
+    // its scratch across jobs stops allocating after the first
+    if (scratch.size() < count) {
+        scratch.resize(count);
+    }
+    AudioDsp::convertToFloat(m_samples + begin, scratch.data(), count);
+    return scratch.data();
+}
+
+size_t AudioBuffer::speechSamples() const {
+    if (!m_speech) {
+        return m_size;
+    }
+    
+    size_t total = 0;
+    for (const Span& span : *m_speech) {
+        total += span.end - span.begin;
+    }
+    return total;
+}
@@ -0,0 +1,73 @@
+#ifndef AUDIOBUFFER_H
+#define AUDIOBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class DiskRecording;
+
+// An immutable 16 kHz mono recording, shared by reference from capture to
+// the engines so a take is never copied on its way through the pipeline.
+// The samples live either in memory or in a mapped DiskRecording.
+//
+// The recorder can hand over a float copy made while it drained the capture
+// ring; engines then skip the conversion entirely. Without one, toFloat()
+// converts into a scratch buffer the caller keeps and reuses.
+//
+// Speech spans, if voice activity detection ran, mark the parts worth
+// decoding; TranscriptionEngine::transcribeSpeech() skips the rest.
+class AudioBuffer {
+public:
+    using Ptr = std::shared_ptr<const AudioBuffer>;
+    
+    struct Span {
+        size_t begin;   // samples, end exclusive
+        size_t end;
+    };
+    
+    // No value: not analysed, decode everything. Empty: no speech at all.
+    using SpeechSpans = std::optional<std::vector<Span>>;
+    
+    // `floats` is optional and must match `samples` in length if given
+    static Ptr create(std::vector<int16_t> samples, std::vector<float> floats = {},
+                      SpeechSpans speech = std::nullopt);
+    static Ptr create(std::shared_ptr<const DiskRecording> recording,
+                      SpeechSpans speech = std::nullopt);
+    
+    AudioBuffer(const AudioBuffer&) = delete;
+    AudioBuffer& operator=(const AudioBuffer&) = delete;
+    
+    const int16_t* samples() const { return m_samples; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    double durationSeconds() const { return static_cast<double>(m_size) / SAMPLE_RATE; }
+    bool isMapped() const { return m_recording != nullptr; }
+    
+    // Float view made during capture, or nullptr
+    const float* floatSamples() const { return m_floats.empty() ? nullptr : m_floats.data(); }
+    
+    // Samples [begin, begin + count) as float in [-1.0, 1.0). Points into
+    // the float view if there is one, else into `scratch`, which is resized
+    // as needed and valid until the caller's next use of it.
+    const float* toFloat(size_t begin, size_t count, std::vector<float>& scratch) const;
+    
+    const SpeechSpans& speechSpans() const { return m_speech; }
+    size_t speechSamples() const;   // all of them if not analysed
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    
+private:
+    AudioBuffer() = default;
+    
+    std::vector<int16_t> m_owned;                     // in memory, or
+    std::shared_ptr<const DiskRecording> m_recording; // mapped from disk
+    std::vector<float> m_floats;
+    SpeechSpans m_speech;
+    const int16_t* m_samples = nullptr;
+    size_t m_size = 0;
+};
+
+#endif // AUDIOBUFFER_H
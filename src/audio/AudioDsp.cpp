@@ -0,0 +1,185 @@
+#include "AudioDsp.h"
+#include "AudioDspKernels.h"
+#include <atomic>
+#include <cmath>
+
+static_assert(AudioDsp::DOT_ALIGN == AudioDspKernels::DOT_LANES, "dotProduct contract");
+
+namespace AudioDspKernels {
+
+namespace {
+    void scalarToFloat(const int16_t* in, float* out, size_t count) {
+        // a power of two, so the same as dividing, and what the SIMD paths do
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = static_cast<float>(in[i]) * (1.0f / 32768.0f);
+        }
+    }
+    
+    void scalarLevelStats(const int16_t* samples, size_t count, uint64_t* sumSquares, int32_t* peak) {
+        uint64_t sum = 0;
+        int32_t high = 0;
+        for (size_t i = 0; i < count; ++i) {
+            int32_t sample = samples[i];
+            sum += static_cast<uint64_t>(sample * sample);
+            int32_t magnitude = sample < 0 ? -sample : sample;
+            high = magnitude > high ? magnitude : high;
+        }
+        *sumSquares = sum;
+        *peak = high;
+    }
+    
+    void scalarGain(int16_t* samples, size_t count, float gain) {
+        for (size_t i = 0; i < count; ++i) {
+            float value = static_cast<float>(samples[i]) * gain;
+            
+            // written as maxps/minps behave, NaN included, to match the SIMD paths
+            value = value > -32768.0f ? value : -32768.0f;
+            value = value < 32767.0f ? value : 32767.0f;
+            samples[i] = static_cast<int16_t>(std::nearbyint(value));
+        }
+    }
+    
+    void scalarDownmix(const int16_t* in, size_t frames, int channels, float* out) {
+        const float scale = 1.0f / (32768.0f * channels);
+        for (size_t i = 0; i < frames; ++i) {
+            int32_t sum = 0;
+            for (int c = 0; c < channels; ++c) {
+                sum += in[i * channels + c];
+            }
+            out[i] = static_cast<float>(sum) * scale;
+        }
+    }
+    
+    float scalarDot(const float* a, const float* b, size_t count) {
+        float lanes[DOT_LANES] = {};
+        for (size_t i = 0; i < count; i += DOT_LANES) {
+            for (size_t j = 0; j < DOT_LANES; ++j) {
+                float product = a[i + j] * b[i + j];
+                lanes[j] += product;
+            }
+        }
+        return sumLanes(lanes);
+    }
+}
+
+const Table& scalar() {
+    static const Table table = {scalarToFloat, scalarLevelStats, scalarGain, scalarDownmix, scalarDot};
+    return table;
+}
+
+} // namespace AudioDspKernels
+
+namespace {
+    bool cpuSupports(AudioDsp::Isa isa) {
+        switch (isa) {
+            case AudioDsp::Isa::Scalar:
+                return true;
+#ifdef AUDIODSP_X86
+            case AudioDsp::Isa::SSE2:
+                return __builtin_cpu_supports("sse2");
+            case AudioDsp::Isa::AVX2:
+                return __builtin_cpu_supports("avx2");
+            case AudioDsp::Isa::AVX512:
+                return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+            default:
+                return false;
+        }
+    }
+    
+    const AudioDspKernels::Table& tableFor(AudioDsp::Isa isa) {
+        switch (isa) {
+#ifdef AUDIODSP_X86
+            case AudioDsp::Isa::SSE2:   return AudioDspKernels::sse2();
+            case AudioDsp::Isa::AVX2:   return AudioDspKernels::avx2();
+            case AudioDsp::Isa::AVX512: return AudioDspKernels::avx512();
+#endif
+            default:                    return AudioDspKernels::scalar();
+        }
+    }
+    
+    std::atomic<int>& activeIsa() {
+        // resolved once, on first use
+        static std::atomic<int> isa([]() {
+            for (AudioDsp::Isa candidate : {AudioDsp::Isa::AVX512, AudioDsp::Isa::AVX2, AudioDsp::Isa::SSE2}) {
+                if (cpuSupports(candidate)) {
+                    return static_cast<int>(candidate);
+                }
+            }
+            return static_cast<int>(AudioDsp::Isa::Scalar);
+        }());
+        return isa;
+    }
+    
+    const AudioDspKernels::Table& kernels() {
+        return tableFor(static_cast<AudioDsp::Isa>(activeIsa().load(std::memory_order_relaxed)));
+    }
+}
+
+void AudioDsp::convertToFloat(const int16_t* in, float* out, size_t count) {
+    kernels().toFloat(in, out, count);
+}
+
+std::vector<float> AudioDsp::convertToFloat(const std::vector<int16_t>& pcm) {
+    std::vector<float> result(pcm.size());
+    convertToFloat(pcm.data(), result.data(), pcm.size());
+    return result;
+}
+
+AudioDsp::Level AudioDsp::measureLevel(const int16_t* samples, size_t count) {
+    if (count == 0) return {0.0f, 0.0f};
+    
+    uint64_t sumSquares;
+    int32_t peak;
+    kernels().levelStats(samples, count, &sumSquares, &peak);
+    
+    Level level;
+    level.rms = static_cast<float>(std::sqrt(static_cast<double>(sumSquares) / count) / 32768.0);
+    level.peak = static_cast<float>(peak) / 32768.0f;
+    return level;
+}
+
+float AudioDsp::calculateRMS(const int16_t* samples, size_t count) {
+    return measureLevel(samples, count).rms;
+}
+
+float AudioDsp::calculatePeak(const int16_t* samples, size_t count) {
+    return measureLevel(samples, count).peak;
+}
+
+void AudioDsp::applyGain(int16_t* samples, size_t count, float gain) {
+    kernels().gain(samples, count, gain);
+}
+
+void AudioDsp::downmixToFloat(const int16_t* in, size_t frames, int channels, float* out) {
+    kernels().downmix(in, frames, channels, out);
+}
+
+float AudioDsp::dotProduct(const float* a, const float* b, size_t count) {
+    return kernels().dot(a, b, count);
+}
+
+AudioDsp::Isa AudioDsp::isa() {
+    return static_cast<Isa>(activeIsa().load(std::memory_order_relaxed));
+}
+
+bool AudioDsp::setIsa(Isa isa) {
+    if (!cpuSupports(isa)) {
+        return false;
+    }
+    activeIsa().store(static_cast<int>(isa), std::memory_order_relaxed);
+    return true;
+}
+
+bool AudioDsp::isaSupported(Isa isa) {
+    return cpuSupports(isa);
+}
+
+const char* AudioDsp::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+        default:          return "scalar";
+    }
+}
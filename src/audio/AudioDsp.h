@@ -0,0 +1,61 @@
+#ifndef AUDIODSP_H
+#define AUDIODSP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sample-level kernels shared by capture and the engines. Kept free of Qt
+// and of any state so they can be benchmarked in isolation.
+//
+// Each kernel has a scalar version and SSE2/AVX2/AVX-512 versions picked at
+// runtime from what the CPU supports. All paths return bit-identical
+// results (speech-bench --verify checks this), so which one runs never
+// changes a transcription.
+class AudioDsp {
+public:
+    enum class Isa {
+        Scalar = 0,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+    
+    struct Level {
+        float rms;    // 0.0 to 1.0
+        float peak;   // 0.0 to 1.0
+    };
+    
+    // int16 PCM to float in [-1.0, 1.0)
+    static void convertToFloat(const int16_t* in, float* out, size_t count);
+    static std::vector<float> convertToFloat(const std::vector<int16_t>& pcm);
+    
+    // Root mean square of the block, 0.0 to 1.0
+    static float calculateRMS(const int16_t* samples, size_t count);
+    static float calculatePeak(const int16_t* samples, size_t count);
+    static Level measureLevel(const int16_t* samples, size_t count);
+    
+    // Scales in place, rounding to nearest and saturating to int16
+    static void applyGain(int16_t* samples, size_t count, float gain);
+    
+    // Interleaved int16 frames to mono float in [-1.0, 1.0), channels averaged
+    static void downmixToFloat(const int16_t* in, size_t frames, int channels, float* out);
+    
+    // Sum of a[i] * b[i]. count must be a multiple of DOT_ALIGN; pad with
+    // zeros (filters do this once, up front).
+    static float dotProduct(const float* a, const float* b, size_t count);
+    static constexpr size_t DOT_ALIGN = 16;
+    
+    // Instruction set the kernels run on. Defaults to the best one the CPU
+    // has; setIsa() forces another for benchmarking and verification and
+    // fails if the CPU lacks it.
+    static Isa isa();
+    static bool setIsa(Isa isa);
+    static bool isaSupported(Isa isa);
+    static const char* isaName(Isa isa);
+    
+private:
+    AudioDsp() = default;
+};
+
+#endif // AUDIODSP_H
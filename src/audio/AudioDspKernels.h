@@ -0,0 +1,52 @@
+#ifndef AUDIODSPKERNELS_H
+#define AUDIODSPKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// The per-instruction-set kernels behind AudioDsp, one table each. Only
+// AudioDsp.cpp picks between them; nothing else should include this.
+namespace AudioDspKernels {
+
+struct Table {
+    void (*toFloat)(const int16_t* in, float* out, size_t count);
+    
+    // Exact sum of squares and largest magnitude (0..32768). Integer
+    // results keep every table bit-identical whatever the summation order.
+    void (*levelStats)(const int16_t* samples, size_t count, uint64_t* sumSquares, int32_t* peak);
+    
+    void (*gain)(int16_t* samples, size_t count, float gain);
+    
+    // Interleaved frames to mono float: channel sum in int32, then one
+    // multiply, so the result is exact up to that single rounding.
+    void (*downmix)(const int16_t* in, size_t frames, int channels, float* out);
+    
+    // count is a multiple of DOT_LANES. Lane j sums elements j, j + 16, ...
+    // (multiply, then add) and sumLanes() folds the lanes, which fixes the
+    // order of every float operation across tables.
+    float (*dot)(const float* a, const float* b, size_t count);
+};
+
+constexpr size_t DOT_LANES = 16;
+
+inline float sumLanes(float* lanes) {
+    for (size_t width = DOT_LANES / 2; width > 0; width /= 2) {
+        for (size_t j = 0; j < width; ++j) {
+            lanes[j] += lanes[j + width];
+        }
+    }
+    return lanes[0];
+}
+
+const Table& scalar();
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIODSP_X86 1
+const Table& sse2();
+const Table& avx2();
+const Table& avx512();
+#endif
+
+} // namespace AudioDspKernels
+
+#endif // AUDIODSPKERNELS_H
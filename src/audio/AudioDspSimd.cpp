@@ -0,0 +1,360 @@
+#include "AudioDspKernels.h"
+
+// x86 kernels. Each function is compiled for its own instruction set with a
+// target attribute, so the rest of the build stays at the baseline ISA and
+// AudioDsp only calls a table the CPU reported support for. Tails shorter
+// than a vector go through the scalar table.
+#ifdef AUDIODSP_X86
+
+#include <immintrin.h>
+
+// GCC 12's own _mm512_undefined_* placeholders trip these under -Wall
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace AudioDspKernels {
+
+namespace {
+    // -------- SSE2, 8 samples per step --------
+    
+    __attribute__((target("sse2")))
+    void sse2ToFloat(const int16_t* in, float* out, size_t count) {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            
+            // sign-extend by placing each sample in the high half, then shifting down
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        scalar().toFloat(in + i, out + i, count - i);
+    }
+    
+    __attribute__((target("sse2")))
+    void sse2LevelStats(const int16_t* samples, size_t count, uint64_t* sumSquares, int32_t* peak) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        __m128i high = _mm_set1_epi16(0);
+        __m128i low = _mm_set1_epi16(0);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            
+            // pairs of squares fit 32 bits unsigned (2 * 32768^2 = 2^31), so
+            // zero-extend them into 64-bit lanes before accumulating
+            __m128i squares = _mm_madd_epi16(pcm, pcm);
+            sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+            sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+            high = _mm_max_epi16(high, pcm);
+            low = _mm_min_epi16(low, pcm);
+        }
+        
+        alignas(16) uint64_t sums[2];
+        alignas(16) int16_t highs[8];
+        alignas(16) int16_t lows[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+        _mm_store_si128(reinterpret_cast<__m128i*>(highs), high);
+        _mm_store_si128(reinterpret_cast<__m128i*>(lows), low);
+        
+        uint64_t tailSum;
+        int32_t tailPeak;
+        scalar().levelStats(samples + i, count - i, &tailSum, &tailPeak);
+        
+        *sumSquares = sums[0] + sums[1] + tailSum;
+        *peak = tailPeak;
+        for (int lane = 0; lane < 8; ++lane) {
+            *peak = highs[lane] > *peak ? highs[lane] : *peak;
+            *peak = -lows[lane] > *peak ? -lows[lane] : *peak;
+        }
+    }
+    
+    __attribute__((target("sse2")))
+    void sse2Gain(int16_t* samples, size_t count, float gain) {
+        const __m128 factor = _mm_set1_ps(gain);
+        const __m128 floor = _mm_set1_ps(-32768.0f);
+        const __m128 ceiling = _mm_set1_ps(32767.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16));
+            __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16));
+            
+            // clamp before converting: out-of-range floats convert to INT_MIN
+            lo = _mm_min_ps(_mm_max_ps(_mm_mul_ps(lo, factor), floor), ceiling);
+            hi = _mm_min_ps(_mm_max_ps(_mm_mul_ps(hi, factor), floor), ceiling);
+            __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), packed);
+        }
+        scalar().gain(samples + i, count - i, gain);
+    }
+    
+    __attribute__((target("sse2")))
+    void sse2Downmix(const int16_t* in, size_t frames, int channels, float* out) {
+        if (channels == 1) {
+            sse2ToFloat(in, out, frames);
+            return;
+        }
+        if (channels != 2) {
+            scalar().downmix(in, frames, channels, out);
+            return;
+        }
+        
+        // madd against ones adds each left/right pair into one int32
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128 scale = _mm_set1_ps(1.0f / 65536.0f);
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4) {
+            __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+            __m128 sum = _mm_cvtepi32_ps(_mm_madd_epi16(pcm, ones));
+            _mm_storeu_ps(out + i, _mm_mul_ps(sum, scale));
+        }
+        scalar().downmix(in + i * 2, frames - i, 2, out + i);
+    }
+    
+    __attribute__((target("sse2")))
+    float sse2Dot(const float* a, const float* b, size_t count) {
+        __m128 acc[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+        for (size_t i = 0; i < count; i += DOT_LANES) {
+            for (int k = 0; k < 4; ++k) {
+                __m128 product = _mm_mul_ps(_mm_loadu_ps(a + i + k * 4), _mm_loadu_ps(b + i + k * 4));
+                acc[k] = _mm_add_ps(acc[k], product);
+            }
+        }
+        
+        alignas(16) float lanes[DOT_LANES];
+        for (int k = 0; k < 4; ++k) {
+            _mm_store_ps(lanes + k * 4, acc[k]);
+        }
+        return sumLanes(lanes);
+    }
+    
+    // -------- AVX2, 8 samples per conversion step, 16 per level/gain step --------
+    
+    __attribute__((target("avx2")))
+    void avx2ToFloat(const int16_t* in, float* out, size_t count) {
+        const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m256 value = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(pcm));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(value, scale));
+        }
+        scalar().toFloat(in + i, out + i, count - i);
+    }
+    
+    __attribute__((target("avx2")))
+    void avx2LevelStats(const int16_t* samples, size_t count, uint64_t* sumSquares, int32_t* peak) {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i sum = zero;
+        __m256i high = zero;
+        __m256i low = zero;
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i pcm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+            __m256i squares = _mm256_madd_epi16(pcm, pcm);
+            sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(squares, zero));
+            sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(squares, zero));
+            high = _mm256_max_epi16(high, pcm);
+            low = _mm256_min_epi16(low, pcm);
+        }
+        
+        alignas(32) uint64_t sums[4];
+        alignas(32) int16_t highs[16];
+        alignas(32) int16_t lows[16];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(highs), high);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lows), low);
+        
+        uint64_t tailSum;
+        int32_t tailPeak;
+        scalar().levelStats(samples + i, count - i, &tailSum, &tailPeak);
+        
+        *sumSquares = sums[0] + sums[1] + sums[2] + sums[3] + tailSum;
+        *peak = tailPeak;
+        for (int lane = 0; lane < 16; ++lane) {
+            *peak = highs[lane] > *peak ? highs[lane] : *peak;
+            *peak = -lows[lane] > *peak ? -lows[lane] : *peak;
+        }
+    }
+    
+    __attribute__((target("avx2")))
+    void avx2Gain(int16_t* samples, size_t count, float gain) {
+        const __m256 factor = _mm256_set1_ps(gain);
+        const __m256 floor = _mm256_set1_ps(-32768.0f);
+        const __m256 ceiling = _mm256_set1_ps(32767.0f);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i pcmLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            __m128i pcmHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i + 8));
+            __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(pcmLo));
+            __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(pcmHi));
+            lo = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(lo, factor), floor), ceiling);
+            hi = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(hi, factor), floor), ceiling);
+            
+            // packs works per 128-bit lane; put the quarters back in order
+            __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(lo), _mm256_cvtps_epi32(hi));
+            packed = _mm256_permute4x64_epi64(packed, 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i), packed);
+        }
+        scalar().gain(samples + i, count - i, gain);
+    }
+    
+    __attribute__((target("avx2")))
+    void avx2Downmix(const int16_t* in, size_t frames, int channels, float* out) {
+        if (channels == 1) {
+            avx2ToFloat(in, out, frames);
+            return;
+        }
+        if (channels != 2) {
+            scalar().downmix(in, frames, channels, out);
+            return;
+        }
+        
+        const __m256i ones = _mm256_set1_epi16(1);
+        const __m256 scale = _mm256_set1_ps(1.0f / 65536.0f);
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            __m256i pcm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2));
+            __m256 sum = _mm256_cvtepi32_ps(_mm256_madd_epi16(pcm, ones));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(sum, scale));
+        }
+        scalar().downmix(in + i * 2, frames - i, 2, out + i);
+    }
+    
+    __attribute__((target("avx2")))
+    float avx2Dot(const float* a, const float* b, size_t count) {
+        __m256 acc[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+        for (size_t i = 0; i < count; i += DOT_LANES) {
+            for (int k = 0; k < 2; ++k) {
+                __m256 product = _mm256_mul_ps(_mm256_loadu_ps(a + i + k * 8), _mm256_loadu_ps(b + i + k * 8));
+                acc[k] = _mm256_add_ps(acc[k], product);
+            }
+        }
+        
+        alignas(32) float lanes[DOT_LANES];
+        _mm256_store_ps(lanes, acc[0]);
+        _mm256_store_ps(lanes + 8, acc[1]);
+        return sumLanes(lanes);
+    }
+    
+    // -------- AVX-512 (F + BW), 16 samples per conversion step, 32 per level step --------
+    
+    __attribute__((target("avx512f,avx512bw")))
+    void avx512ToFloat(const int16_t* in, float* out, size_t count) {
+        const __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i pcm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m512 value = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(pcm));
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(value, scale));
+        }
+        scalar().toFloat(in + i, out + i, count - i);
+    }
+    
+    __attribute__((target("avx512f,avx512bw")))
+    void avx512LevelStats(const int16_t* samples, size_t count, uint64_t* sumSquares, int32_t* peak) {
+        const __m512i zero = _mm512_setzero_si512();
+        __m512i sum = zero;
+        __m512i high = zero;
+        __m512i low = zero;
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m512i pcm = _mm512_loadu_si512(samples + i);
+            __m512i squares = _mm512_madd_epi16(pcm, pcm);
+            sum = _mm512_add_epi64(sum, _mm512_unpacklo_epi32(squares, zero));
+            sum = _mm512_add_epi64(sum, _mm512_unpackhi_epi32(squares, zero));
+            high = _mm512_max_epi16(high, pcm);
+            low = _mm512_min_epi16(low, pcm);
+        }
+        
+        alignas(64) int16_t highs[32];
+        alignas(64) int16_t lows[32];
+        _mm512_store_si512(highs, high);
+        _mm512_store_si512(lows, low);
+        
+        uint64_t tailSum;
+        int32_t tailPeak;
+        scalar().levelStats(samples + i, count - i, &tailSum, &tailPeak);
+        
+        *sumSquares = static_cast<uint64_t>(_mm512_reduce_add_epi64(sum)) + tailSum;
+        *peak = tailPeak;
+        for (int lane = 0; lane < 32; ++lane) {
+            *peak = highs[lane] > *peak ? highs[lane] : *peak;
+            *peak = -lows[lane] > *peak ? -lows[lane] : *peak;
+        }
+    }
+    
+    __attribute__((target("avx512f,avx512bw")))
+    void avx512Gain(int16_t* samples, size_t count, float gain) {
+        const __m512 factor = _mm512_set1_ps(gain);
+        const __m512 floor = _mm512_set1_ps(-32768.0f);
+        const __m512 ceiling = _mm512_set1_ps(32767.0f);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m256i pcm = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+            __m512 value = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(pcm));
+            value = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(value, factor), floor), ceiling);
+            __m256i packed = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(value));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i), packed);
+        }
+        scalar().gain(samples + i, count - i, gain);
+    }
+    
+    __attribute__((target("avx512f,avx512bw")))
+    void avx512Downmix(const int16_t* in, size_t frames, int channels, float* out) {
+        if (channels == 1) {
+            avx512ToFloat(in, out, frames);
+            return;
+        }
+        if (channels != 2) {
+            scalar().downmix(in, frames, channels, out);
+            return;
+        }
+        
+        const __m512i ones = _mm512_set1_epi16(1);
+        const __m512 scale = _mm512_set1_ps(1.0f / 65536.0f);
+        size_t i = 0;
+        for (; i + 16 <= frames; i += 16) {
+            __m512i pcm = _mm512_loadu_si512(in + i * 2);
+            __m512 sum = _mm512_cvtepi32_ps(_mm512_madd_epi16(pcm, ones));
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(sum, scale));
+        }
+        scalar().downmix(in + i * 2, frames - i, 2, out + i);
+    }
+    
+    // no FMA: this file is built with -ffp-contract=off, see CMakeLists.txt
+    __attribute__((target("avx512f,avx512bw")))
+    float avx512Dot(const float* a, const float* b, size_t count) {
+        __m512 acc = _mm512_setzero_ps();
+        for (size_t i = 0; i < count; i += DOT_LANES) {
+            __m512 product = _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+            acc = _mm512_add_ps(acc, product);
+        }
+        
+        alignas(64) float lanes[DOT_LANES];
+        _mm512_store_ps(lanes, acc);
+        return sumLanes(lanes);
+    }
+}
+
+const Table& sse2() {
+    static const Table table = {sse2ToFloat, sse2LevelStats, sse2Gain, sse2Downmix, sse2Dot};
+    return table;
+}
+
+const Table& avx2() {
+    static const Table table = {avx2ToFloat, avx2LevelStats, avx2Gain, avx2Downmix, avx2Dot};
+    return table;
+}
+
+const Table& avx512() {
+    static const Table table = {avx512ToFloat, avx512LevelStats, avx512Gain, avx512Downmix, avx512Dot};
+    return table;
+}
+
+} // namespace AudioDspKernels
+
+#endif // AUDIODSP_X86
@@ -0,0 +1,116 @@
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// Fixed-capacity single-producer/single-consumer ring of PCM blocks.
+//
+// The capture thread is the only writer and exactly one other thread is the
+// only reader. All storage is allocated up front, so push() and pop() never
+// allocate and never take a lock. Head and tail live on separate cache lines
+// so the two threads don't false-share.
+template <size_t BlockSamples, size_t Capacity>
+class AudioRingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    
+public:
+    static constexpr size_t CACHE_LINE = 64;
+    
+    struct Block {
+        int16_t samples[BlockSamples];
+        size_t count;
+        uint32_t flags;   // producer's per-block annotations (e.g. VAD result)
+    };
+    
+    AudioRingBuffer()
+        : m_head(0)
+        , m_tail(0)
+        , m_overruns(0) {
+    }
+    
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+    
+    // Producer side. Returns false (and counts an overrun) if the consumer
+    // has fallen a full ring behind; the block is dropped in that case.
+    bool push(const int16_t* data, size_t count, uint32_t flags = 0) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        
+        if (head - tail >= Capacity) {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        Block& block = m_blocks[head & (Capacity - 1)];
+        block.count = std::min(count, BlockSamples);
+        block.flags = flags;
+        std::memcpy(block.samples, data, block.count * sizeof(int16_t));
+        
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side. Peek at the oldest block without copying it out; call
+    // release() once done with it.
+    const Block* front() const {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        
+        if (tail == head) {
+            return nullptr;
+        }
+        return &m_blocks[tail & (Capacity - 1)];
+    }
+    
+    void release() {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+    
+    // Consumer side convenience: copy the oldest block out.
+    bool pop(Block& out) {
+        const Block* block = front();
+        if (!block) {
+            return false;
+        }
+        out.count = block->count;
+        out.flags = block->flags;
+        std::memcpy(out.samples, block->samples, block->count * sizeof(int16_t));
+        release();
+        return true;
+    }
+    
+    // Only safe while neither side is running (e.g. before the capture
+    // thread starts).
+    void reset() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_overruns.store(0, std::memory_order_relaxed);
+    }
+    
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    
+    size_t overruns() const {
+        return m_overruns.load(std::memory_order_relaxed);
+    }
+    
+    static constexpr size_t capacity() { return Capacity; }
+    static constexpr size_t blockSamples() { return BlockSamples; }
+    
+private:
+    alignas(CACHE_LINE) std::atomic<size_t> m_head;     // written by producer
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail;     // written by consumer
+    alignas(CACHE_LINE) std::atomic<size_t> m_overruns;
+    alignas(CACHE_LINE) std::array<Block, Capacity> m_blocks;
+};
+
+#endif // AUDIORINGBUFFER_H
@@ -0,0 +1,89 @@
+#include "DiskRecording.h"
+#include <QDateTime>
+#include <QDir>
+#include <QtEndian>
+#include <cstring>
+
+std::unique_ptr<DiskRecording> DiskRecording::create(const QString& directory, QString& error) {
+    if (!QDir().mkpath(directory)) {
+        error = QString("Cannot create %1").arg(directory);
+        return nullptr;
+    }
+    
+    std::unique_ptr<DiskRecording> recording(new DiskRecording());
+    QString name = QString("recording-%1.wav")
+                       .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz"));
+    recording->m_file.setFileName(QDir(directory).filePath(name));
+    
+    if (!recording->m_file.open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+        !recording->writeHeader(UNKNOWN_SIZE)) {
+        error = QString("%1: %2").arg(recording->path(), recording->errorString());
+        return nullptr;
+    }
+    return recording;
+}
+
+DiskRecording::~DiskRecording() {
+    if (m_file.isOpen()) {
+        if (m_samples) {
+            m_file.unmap(reinterpret_cast<uchar*>(const_cast<int16_t*>(m_samples)));
+        }
+        m_file.close();
+    }
+    m_file.remove();
+}
+
+bool DiskRecording::writeHeader(quint32 dataBytes) {
+    // canonical 44-byte PCM header; an unknown size stays unknown in RIFF too
+    uchar header[HEADER_BYTES];
+    memcpy(header, "RIFF", 4);
+    qToLittleEndian<quint32>(dataBytes == UNKNOWN_SIZE ? UNKNOWN_SIZE : dataBytes + 36, header + 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, header + 16);                      // fmt chunk size
+    qToLittleEndian<quint16>(1, header + 20);                       // PCM
+    qToLittleEndian<quint16>(1, header + 22);                       // mono
+    qToLittleEndian<quint32>(SAMPLE_RATE, header + 24);
+    qToLittleEndian<quint32>(SAMPLE_RATE * sizeof(int16_t), header + 28);   // byte rate
+    qToLittleEndian<quint16>(sizeof(int16_t), header + 32);         // block align
+    qToLittleEndian<quint16>(16, header + 34);                      // bits per sample
+    memcpy(header + 36, "data", 4);
+    qToLittleEndian<quint32>(dataBytes, header + 40);
+    
+    return m_file.seek(0) &&
+           m_file.write(reinterpret_cast<const char*>(header), HEADER_BYTES) == HEADER_BYTES;
+}
+
+bool DiskRecording::append(const int16_t* samples, size_t count) {
+    // host order is little-endian on every platform we build for
+    const qint64 bytes = static_cast<qint64>(count * sizeof(int16_t));
+    if (m_file.write(reinterpret_cast<const char*>(samples), bytes) != bytes) {
+        return false;
+    }
+    m_sampleCount += count;
+    return true;
+}
+
+bool DiskRecording::finish(QString& error) {
+    const qint64 dataBytes = static_cast<qint64>(m_sampleCount * sizeof(int16_t));
+    
+    // 1a. real sizes, where they fit in 32 bits (about 37 hours)
+    if (dataBytes < UNKNOWN_SIZE - 36 && !writeHeader(static_cast<quint32>(dataBytes))) {
+        error = QString("%1: %2").arg(path(), errorString());
+        return false;
+    }
+    if (!m_file.flush()) {
+        error = QString("%1: %2").arg(path(), errorString());
+        return false;
+    }
+    
+    // 1b. map the samples; the page cache holds them, not our heap
+    if (m_sampleCount > 0) {
+        uchar* data = m_file.map(HEADER_BYTES, dataBytes, QFileDevice::MapPrivateOption);
+        if (!data) {
+            error = QString("Cannot map %1: %2").arg(path(), errorString());
+            return false;
+        }
+        m_samples = reinterpret_cast<const int16_t*>(data);
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef DISKRECORDING_H
+#define DISKRECORDING_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <memory>
+
+// A recording spilled to disk as it is captured, so a multi-hour session
+// costs a file instead of RAM. Blocks are appended to a 16 kHz mono S16
+// WAV; finish() fixes up the header and maps the samples read-only, and the
+// engines decode straight from the mapping. The file is removed when the
+// last reference goes away.
+//
+// The header is written with "unknown" sizes up front, so the file is a
+// readable WAV (see WavReader) even if the app dies mid-recording.
+class DiskRecording {
+public:
+    // Creates an empty recording file in `directory`
+    static std::unique_ptr<DiskRecording> create(const QString& directory, QString& error);
+    ~DiskRecording();
+    
+    DiskRecording(const DiskRecording&) = delete;
+    DiskRecording& operator=(const DiskRecording&) = delete;
+    
+    // Writing side, before finish()
+    bool append(const int16_t* samples, size_t count);
+    bool finish(QString& error);
+    
+    // Reading side, after finish(). Valid for the object's lifetime.
+    const int16_t* samples() const { return m_samples; }
+    size_t sampleCount() const { return m_sampleCount; }
+    
+    QString path() const { return m_file.fileName(); }
+    QString errorString() const { return m_file.errorString(); }
+    
+private:
+    DiskRecording() = default;
+    bool writeHeader(quint32 dataBytes);
+    
+    QFile m_file;
+    size_t m_sampleCount = 0;
+    const int16_t* m_samples = nullptr;
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr qint64 HEADER_BYTES = 44;
+    static constexpr quint32 UNKNOWN_SIZE = 0xFFFFFFFFu;
+};
+
+#endif // DISKRECORDING_H
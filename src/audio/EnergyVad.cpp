@@ -0,0 +1,53 @@
+#include "EnergyVad.h"
+#include "AudioDsp.h"
+#include <algorithm>
+#include <cmath>
+
+EnergyVad::EnergyVad() {
+    reset();
+}
+
+void EnergyVad::reset() {
+    m_noiseFloorDb = 0.0f;  // full scale, the first blocks pull it down
+    m_blocksSeen = 0;
+}
+
+bool EnergyVad::isSpeech(const int16_t* samples, size_t count) {
+    if (count == 0) {
+        return false;
+    }
+    
+    // 1a. block level in dBFS
+    float rms = AudioDsp::calculateRMS(samples, count);
+    float db = rms > 0.0f ? 20.0f * std::log10(rms) : SILENCE_DB;
+    
+    // 1b. zero crossings per sample
+    size_t crossings = 0;
+    for (size_t i = 1; i < count; ++i) {
+        crossings += (samples[i - 1] < 0) != (samples[i] < 0);
+    }
+    float zcr = static_cast<float>(crossings) / count;
+    
+    // 1c. still settling: the floor is only the quietest block so far, which
+    //     is speech itself if the user was already talking, so judge against
+    //     the lowest floor there can be
+    bool settling = m_blocksSeen < SETTLE_BLOCKS;
+    float floorDb = settling ? FLOOR_MIN_DB : m_noiseFloorDb;
+    
+    // 2. decide against the floor as it was before this block
+    bool voiced = db > floorDb + SPEECH_MARGIN_DB;
+    bool fricative = db > floorDb + FRICATIVE_MARGIN_DB && zcr > FRICATIVE_MIN_ZCR;
+    bool speech = db > MIN_SPEECH_DB && (voiced || fricative);
+    
+    // 3. track the floor: down at once, up slowly, and not up at all while
+    //    settling (but not below FLOOR_MIN_DB, digital silence would leave it there)
+    if (db < m_noiseFloorDb) {
+        m_noiseFloorDb = std::max(db, FLOOR_MIN_DB);
+    } else if (!settling) {
+        m_noiseFloorDb += (db - m_noiseFloorDb) * FLOOR_RISE;
+    }
+    if (settling) {
+        m_blocksSeen++;
+    }
+    return speech;
+}
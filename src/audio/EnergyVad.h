@@ -0,0 +1,37 @@
+#ifndef ENERGYVAD_H
+#define ENERGYVAD_H
+
+#include "VoiceActivityDetector.h"
+
+// Level against an adaptive noise floor, with the zero-crossing rate to
+// catch fricatives ("s", "f") that are quiet but clearly not background.
+// The floor drops at once to any quieter block and creeps up slowly, so a
+// fan switching on is absorbed in a few seconds while speech, with its
+// gaps, doesn't drag the floor up with it. Until the floor has settled
+// blocks are judged against the lowest it can be, so talking from the
+// first sample isn't taken for the room.
+class EnergyVad : public VoiceActivityDetector {
+public:
+    EnergyVad();
+    
+    void reset() override;
+    bool isSpeech(const int16_t* samples, size_t count) override;
+    QString name() const override { return "energy"; }
+    
+    float noiseFloorDb() const { return m_noiseFloorDb; }
+    
+private:
+    float m_noiseFloorDb;
+    int m_blocksSeen;
+    
+    static constexpr float SILENCE_DB = -90.0f;
+    static constexpr float MIN_SPEECH_DB = -55.0f;      // never speech below this
+    static constexpr float SPEECH_MARGIN_DB = 9.0f;     // voiced: this far above the floor
+    static constexpr float FRICATIVE_MARGIN_DB = 4.0f;  // unvoiced: closer, with a high ZCR
+    static constexpr float FRICATIVE_MIN_ZCR = 0.25f;   // crossings per sample
+    static constexpr float FLOOR_MIN_DB = -70.0f;
+    static constexpr float FLOOR_RISE = 0.02f;          // per block, ~3 s time constant
+    static constexpr int SETTLE_BLOCKS = 8;             // ~0.5 s at 1024 samples a block
+};
+
+#endif // ENERGYVAD_H
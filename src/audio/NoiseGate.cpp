@@ -0,0 +1,100 @@
+#include "NoiseGate.h"
+#include "AudioDsp.h"
+#include "SpectralSubtractor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // per-sample one-pole coefficient reaching ~63% of a step in `ms`
+    float rampCoefficient(float ms, int sampleRate) {
+        return ms <= 0.0f ? 1.0f : 1.0f - std::exp(-1.0f / (ms * 0.001f * sampleRate));
+    }
+}
+
+NoiseGate::NoiseGate()
+    : NoiseGate(Config()) {
+}
+
+NoiseGate::NoiseGate(const Config& config)
+    : m_config(config)
+    , m_attackCoef(rampCoefficient(config.attackMs, SAMPLE_RATE))
+    , m_releaseCoef(rampCoefficient(config.releaseMs, SAMPLE_RATE))
+    , m_rangeGain(std::pow(10.0f, config.rangeDb / 20.0f))
+    , m_holdSamples(static_cast<size_t>(config.holdMs * 0.001f * SAMPLE_RATE)) {
+    
+    if (config.mode == Mode::Spectral) {
+        m_spectral = std::make_unique<SpectralSubtractor>();
+    }
+    reset();
+}
+
+NoiseGate::~NoiseGate() = default;
+
+void NoiseGate::reset() {
+    if (m_spectral) {
+        m_spectral->reset();
+    }
+    m_gain = m_rangeGain;
+    m_floorDb = SILENCE_DB;
+    m_holdLeft = 0;
+    m_open = false;
+    m_primed = false;
+}
+
+void NoiseGate::process(int16_t* samples, size_t count) {
+    if (m_spectral) {
+        m_spectral->process(samples, count);
+    }
+    
+    for (size_t offset = 0; offset < count; offset += DETECT_SAMPLES) {
+        int16_t* chunk = samples + offset;
+        const size_t n = std::min(DETECT_SAMPLES, count - offset);
+        
+        // 1a. sub-block level and the noise floor under it
+        float rms = AudioDsp::calculateRMS(chunk, n);
+        float db = rms > 0.0f ? 20.0f * std::log10(rms) : SILENCE_DB;
+        if (!m_primed) {
+            m_floorDb = std::max(db, FLOOR_MIN_DB);
+            m_primed = true;
+        } else if (db < m_floorDb) {
+            m_floorDb = std::max(m_floorDb + (db - m_floorDb) * FLOOR_FALL, FLOOR_MIN_DB);
+        } else {
+            m_floorDb += (db - m_floorDb) * FLOOR_RISE;
+        }
+        
+        // 1b. open above the open threshold; once open, only a level below
+        //     the close threshold for the whole hold time closes it again
+        if (db > m_floorDb + m_config.openMarginDb) {
+            m_open = true;
+            m_holdLeft = m_holdSamples;
+        } else if (m_open) {
+            if (db > m_floorDb + m_config.closeMarginDb) {
+                m_holdLeft = m_holdSamples;
+            } else if (m_holdLeft > n) {
+                m_holdLeft -= n;
+            } else {
+                m_holdLeft = 0;
+                m_open = false;
+            }
+        }
+        
+        // 2a. settled: fully open costs nothing, fully closed is one gain pass
+        const float target = m_open ? 1.0f : m_rangeGain;
+        if (m_gain == target) {
+            if (target != 1.0f) {
+                AudioDsp::applyGain(chunk, n, target);
+            }
+            continue;
+        }
+        
+        // 2b. ramping, per sample; gains never exceed 1 so no clamping
+        const float coef = m_open ? m_attackCoef : m_releaseCoef;
+        for (size_t i = 0; i < n; ++i) {
+            m_gain += (target - m_gain) * coef;
+            if (std::fabs(target - m_gain) < GAIN_EPSILON) {
+                m_gain = target;
+            }
+            chunk[i] = static_cast<int16_t>(std::nearbyint(chunk[i] * m_gain));
+        }
+    }
+}
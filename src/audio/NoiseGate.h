@@ -0,0 +1,77 @@
+#ifndef NOISEGATE_H
+#define NOISEGATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class SpectralSubtractor;
+
+// Downward noise gate run on the capture thread, on every block before it
+// reaches the ring, the VAD and the level meter. Between phrases the room
+// tone is pulled down by rangeDb, which keeps Whisper from "hearing" words
+// in silence.
+//
+// The threshold follows an adaptive noise floor (open this far above it,
+// close a bit lower for hysteresis), detection runs on 4 ms sub-blocks,
+// and the gain moves with one-pole attack/release ramps after a hold
+// time. Spectral mode also runs a SpectralSubtractor ahead of the gate.
+// Everything is allocated in the constructor; process() never allocates.
+class NoiseGate {
+public:
+    enum class Mode {
+        Gate,
+        Spectral    // spectral subtraction, then the gate
+    };
+    
+    struct Config {
+        Mode mode = Mode::Gate;
+        float attackMs = 5.0f;
+        float holdMs = 200.0f;
+        float releaseMs = 150.0f;
+        float openMarginDb = 9.0f;     // above the noise floor
+        float closeMarginDb = 5.0f;
+        float rangeDb = -40.0f;        // attenuation while closed
+    };
+    
+    NoiseGate();
+    explicit NoiseGate(const Config& config);
+    ~NoiseGate();
+    
+    NoiseGate(const NoiseGate&) = delete;
+    NoiseGate& operator=(const NoiseGate&) = delete;
+    
+    void reset();
+    
+    // 16 kHz mono, in place. Spectral mode delays the audio by
+    // SpectralSubtractor::FRAME samples.
+    void process(int16_t* samples, size_t count);
+    
+    bool isOpen() const { return m_open; }
+    float noiseFloorDb() const { return m_floorDb; }
+    
+private:
+    Config m_config;
+    std::unique_ptr<SpectralSubtractor> m_spectral;
+    float m_attackCoef;
+    float m_releaseCoef;
+    float m_rangeGain;
+    size_t m_holdSamples;
+    
+    float m_gain;
+    float m_floorDb;
+    size_t m_holdLeft;
+    bool m_open;
+    bool m_primed;
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr size_t DETECT_SAMPLES = 64;       // 4 ms
+    static constexpr float SILENCE_DB = -90.0f;
+    static constexpr float FLOOR_MIN_DB = -70.0f;
+    static constexpr float FLOOR_FALL = 0.05f;         // per sub-block, ~80 ms: follows the
+                                                       // noise's level, not its dips
+    static constexpr float FLOOR_RISE = 0.0013f;       // per sub-block, ~3 s time constant
+    static constexpr float GAIN_EPSILON = 1e-4f;       // snap the ramp once this close
+};
+
+#endif // NOISEGATE_H
@@ -0,0 +1,31 @@
+#include "PreRollBuffer.h"
+#include <algorithm>
+
+PreRollBuffer::PreRollBuffer(size_t blockSamples, size_t capacityBlocks)
+    : m_samples(blockSamples * std::max<size_t>(1, capacityBlocks))
+    , m_blockSamples(blockSamples)
+    , m_capacity(std::max<size_t>(1, capacityBlocks))
+    , m_oldest(0)
+    , m_count(0) {
+}
+
+void PreRollBuffer::clear() {
+    m_oldest = 0;
+    m_count = 0;
+}
+
+void PreRollBuffer::push(const int16_t* block) {
+    // full: the new block takes the oldest one's slot
+    size_t slot = (m_oldest + m_count) % m_capacity;
+    if (m_count == m_capacity) {
+        m_oldest = (m_oldest + 1) % m_capacity;
+    } else {
+        ++m_count;
+    }
+    std::copy(block, block + m_blockSamples, m_samples.begin() + slot * m_blockSamples);
+}
+
+int16_t* PreRollBuffer::block(size_t index) {
+    size_t slot = (m_oldest + index) % m_capacity;
+    return m_samples.data() + slot * m_blockSamples;
+}
@@ -0,0 +1,34 @@
+#ifndef PREROLLBUFFER_H
+#define PREROLLBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The last N capture blocks, kept while nothing is recording so a take can
+// start with the audio from just before Record was pressed. A fixed
+// circular buffer: push() overwrites the oldest block once full and never
+// allocates. Used from the capture thread only, so there is no locking.
+class PreRollBuffer {
+public:
+    PreRollBuffer(size_t blockSamples, size_t capacityBlocks);
+    
+    void clear();
+    void push(const int16_t* block);   // blockSamples() samples
+    
+    size_t size() const { return m_count; }                 // blocks held
+    size_t capacity() const { return m_capacity; }
+    size_t blockSamples() const { return m_blockSamples; }
+    
+    // 0 is the oldest block; writable so the take can process it in place
+    int16_t* block(size_t index);
+    
+private:
+    std::vector<int16_t> m_samples;
+    size_t m_blockSamples;
+    size_t m_capacity;
+    size_t m_oldest;
+    size_t m_count;
+};
+
+#endif // PREROLLBUFFER_H
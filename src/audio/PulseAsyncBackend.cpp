@@ -0,0 +1,395 @@
+#include "PulseAsyncBackend.h"
+#include <pulse/pulseaudio.h>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    // Filled by the source info callbacks while the caller waits on the mainloop
+    struct SourceQuery {
+        pa_threaded_mainloop* mainloop;
+        pa_sample_spec spec;
+        bool found;
+        std::vector<AudioBackend::Device> devices;
+        bool timedOut;
+    };
+    
+    void sourceInfoCallback(pa_context* context, const pa_source_info* info, int eol, void* userdata) {
+        Q_UNUSED(context);
+        auto* query = static_cast<SourceQuery*>(userdata);
+        if (!eol && info) {
+            query->spec = info->sample_spec;
+            query->found = true;
+            
+            // monitors record what the speakers play, not a microphone
+            if (info->monitor_of_sink == PA_INVALID_INDEX) {
+                query->devices.push_back({QString::fromUtf8(info->name),
+                                          QString::fromUtf8(info->description)});
+            }
+        }
+        pa_threaded_mainloop_signal(query->mainloop, 0);
+    }
+    
+    // Mainloop lock held. Waits for the operation and drops it, or cancels
+    // it once *timedOut is set.
+    void waitFor(pa_threaded_mainloop* mainloop, pa_operation* op, const bool* timedOut = nullptr) {
+        if (!op) {
+            return;
+        }
+        while (pa_operation_get_state(op) == PA_OPERATION_RUNNING) {
+            if (timedOut && *timedOut) {
+                pa_operation_cancel(op);
+                break;
+            }
+            pa_threaded_mainloop_wait(mainloop);
+        }
+        pa_operation_unref(op);
+    }
+}
+
+PulseAsyncBackend::PulseAsyncBackend(const Config& config)
+    : m_mainloop(nullptr)
+    , m_context(nullptr)
+    , m_stream(nullptr)
+    , m_active(false)
+    , m_sampleRate(config.sampleRate)
+    , m_channels(config.channels)
+    , m_fragment(nullptr)
+    , m_fragmentSize(0)
+    , m_fragmentOffset(0)
+    , m_hasFragment(false) {
+    
+    // 1a. bring up the mainloop thread and connect to the server
+    m_mainloop = pa_threaded_mainloop_new();
+    if (!m_mainloop) {
+        throw std::runtime_error("PulseAudio init failed: cannot create mainloop");
+    }
+    
+    m_context = pa_context_new(pa_threaded_mainloop_get_api(m_mainloop), "SpeechRecorder");
+    pa_context_set_state_callback(m_context, &PulseAsyncBackend::contextStateCallback, this);
+    
+    pa_threaded_mainloop_lock(m_mainloop);
+    
+    if (pa_context_connect(m_context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0
+        || pa_threaded_mainloop_start(m_mainloop) < 0) {
+        QString error = pa_strerror(pa_context_errno(m_context));
+        pa_threaded_mainloop_unlock(m_mainloop);
+        cleanup();
+        throw std::runtime_error(QString("PulseAudio init failed: %1").arg(error).toStdString());
+    }
+    
+    // 1b. wait for the context to become ready
+    for (;;) {
+        pa_context_state_t state = pa_context_get_state(m_context);
+        if (state == PA_CONTEXT_READY) break;
+        if (!PA_CONTEXT_IS_GOOD(state)) {
+            QString error = pa_strerror(pa_context_errno(m_context));
+            pa_threaded_mainloop_unlock(m_mainloop);
+            cleanup();
+            throw std::runtime_error(QString("PulseAudio connect failed: %1").arg(error).toStdString());
+        }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+    
+    // 1c. fill in whatever was left to the device, so the server hands us
+    //     its samples unconverted and our own resampler does the rest
+    QByteArray device = config.device.toUtf8();
+    if (m_sampleRate <= 0 || m_channels <= 0) {
+        int nativeRate = 0;
+        int nativeChannels = 0;
+        if (queryDeviceFormat(device, nativeRate, nativeChannels)) {
+            qDebug() << "Capture device format:" << nativeRate << "Hz," << nativeChannels << "channels";
+        } else {
+            qWarning() << "Cannot query the capture device, asking for 16 kHz mono";
+            nativeRate = 16000;
+            nativeChannels = 1;
+        }
+        m_sampleRate = m_sampleRate > 0 ? m_sampleRate : nativeRate;
+        m_channels = m_channels > 0 ? m_channels : nativeChannels;
+    }
+    
+    // 1d. create the record stream with explicit buffer attrs
+    pa_sample_spec ss;
+    ss.format = PA_SAMPLE_S16LE;
+    ss.channels = static_cast<uint8_t>(m_channels);
+    ss.rate = static_cast<uint32_t>(m_sampleRate);
+    
+    pa_buffer_attr attr;
+    attr.maxlength = pa_usec_to_bytes(static_cast<pa_usec_t>(config.bufferMs) * 1000, &ss);
+    attr.fragsize = pa_usec_to_bytes(static_cast<pa_usec_t>(config.latencyMs) * 1000, &ss);
+    attr.tlength = static_cast<uint32_t>(-1);
+    attr.prebuf = static_cast<uint32_t>(-1);
+    attr.minreq = static_cast<uint32_t>(-1);
+    
+    m_stream = pa_stream_new(m_context, "Speech Input", &ss, nullptr);
+    if (!m_stream) {
+        QString error = pa_strerror(pa_context_errno(m_context));
+        pa_threaded_mainloop_unlock(m_mainloop);
+        cleanup();
+        throw std::runtime_error(QString("PulseAudio stream failed: %1").arg(error).toStdString());
+    }
+    
+    pa_stream_set_state_callback(m_stream, &PulseAsyncBackend::streamStateCallback, this);
+    pa_stream_set_read_callback(m_stream, &PulseAsyncBackend::streamReadCallback, this);
+    
+    // start corked, startRecording() uncorks
+    pa_stream_flags_t flags = static_cast<pa_stream_flags_t>(
+        PA_STREAM_START_CORKED
+        | PA_STREAM_ADJUST_LATENCY
+        | PA_STREAM_INTERPOLATE_TIMING
+        | PA_STREAM_AUTO_TIMING_UPDATE);
+    
+    if (pa_stream_connect_record(m_stream, device.isEmpty() ? nullptr : device.constData(),
+                                 &attr, flags) < 0) {
+        QString error = pa_strerror(pa_context_errno(m_context));
+        pa_threaded_mainloop_unlock(m_mainloop);
+        cleanup();
+        throw std::runtime_error(QString("PulseAudio record failed: %1").arg(error).toStdString());
+    }
+    
+    // 1e. wait for the stream to become ready
+    for (;;) {
+        pa_stream_state_t state = pa_stream_get_state(m_stream);
+        if (state == PA_STREAM_READY) break;
+        if (!PA_STREAM_IS_GOOD(state)) {
+            QString error = pa_strerror(pa_context_errno(m_context));
+            pa_threaded_mainloop_unlock(m_mainloop);
+            cleanup();
+            throw std::runtime_error(QString("PulseAudio stream failed: %1").arg(error).toStdString());
+        }
+        pa_threaded_mainloop_wait(m_mainloop);
+    }
+    
+    const pa_buffer_attr* actual = pa_stream_get_buffer_attr(m_stream);
+    if (actual) {
+        qDebug() << "PulseAudio async stream ready, fragsize" << actual->fragsize
+                 << "maxlength" << actual->maxlength;
+    }
+    
+    pa_threaded_mainloop_unlock(m_mainloop);
+}
+
+PulseAsyncBackend::~PulseAsyncBackend() {
+    cleanup();
+}
+
+void PulseAsyncBackend::cleanup() {
+    if (!m_mainloop) {
+        return;
+    }
+    
+    pa_threaded_mainloop_lock(m_mainloop);
+    if (m_stream) {
+        releaseFragment();
+        pa_stream_disconnect(m_stream);
+        pa_stream_unref(m_stream);
+        m_stream = nullptr;
+    }
+    if (m_context) {
+        pa_context_disconnect(m_context);
+        pa_context_unref(m_context);
+        m_context = nullptr;
+    }
+    pa_threaded_mainloop_unlock(m_mainloop);
+    
+    pa_threaded_mainloop_stop(m_mainloop);
+    pa_threaded_mainloop_free(m_mainloop);
+    m_mainloop = nullptr;
+}
+
+void PulseAsyncBackend::start() {
+    pa_threaded_mainloop_lock(m_mainloop);
+    
+    // 2a. drop anything that was left over from the previous take
+    releaseFragment();
+    const void* data = nullptr;
+    size_t size = 0;
+    while (pa_stream_peek(m_stream, &data, &size) == 0 && size > 0) {
+        pa_stream_drop(m_stream);
+    }
+    
+    // 2b. uncork, audio starts flowing on the next fragment
+    m_active = true;
+    pa_operation* op = pa_stream_cork(m_stream, 0, nullptr, nullptr);
+    if (op) pa_operation_unref(op);
+    
+    pa_threaded_mainloop_unlock(m_mainloop);
+}
+
+void PulseAsyncBackend::stop() {
+    pa_threaded_mainloop_lock(m_mainloop);
+    
+    // 3a. cork so the server stops buffering for us, then wake the reader
+    m_active = false;
+    pa_operation* op = pa_stream_cork(m_stream, 1, nullptr, nullptr);
+    if (op) pa_operation_unref(op);
+    pa_threaded_mainloop_signal(m_mainloop, 0);
+    
+    pa_threaded_mainloop_unlock(m_mainloop);
+}
+
+bool PulseAsyncBackend::read(int16_t* buffer, size_t samples, QString& error) {
+    uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+    size_t needed = samples * sizeof(int16_t);
+    size_t filled = 0;
+    
+    pa_threaded_mainloop_lock(m_mainloop);
+    
+    while (filled < needed) {
+        // 4a. stopped or broken stream ends the read
+        if (!m_active) {
+            pa_threaded_mainloop_unlock(m_mainloop);
+            return false;
+        }
+        if (!PA_STREAM_IS_GOOD(pa_stream_get_state(m_stream))) {
+            error = QString("Read error: %1").arg(pa_strerror(pa_context_errno(m_context)));
+            pa_threaded_mainloop_unlock(m_mainloop);
+            return false;
+        }
+        
+        // 4b. grab the next fragment if we don't have one
+        if (!m_hasFragment) {
+            const void* data = nullptr;
+            size_t size = 0;
+            if (pa_stream_peek(m_stream, &data, &size) < 0) {
+                error = QString("Read error: %1").arg(pa_strerror(pa_context_errno(m_context)));
+                pa_threaded_mainloop_unlock(m_mainloop);
+                return false;
+            }
+            if (size == 0) {
+                // nothing buffered yet, wait for the read callback
+                pa_threaded_mainloop_wait(m_mainloop);
+                continue;
+            }
+            // data == nullptr means a hole in the stream, fill with silence
+            m_fragment = static_cast<const uint8_t*>(data);
+            m_fragmentSize = size;
+            m_fragmentOffset = 0;
+            m_hasFragment = true;
+        }
+        
+        // 4c. copy as much of the fragment as fits
+        size_t chunk = std::min(needed - filled, m_fragmentSize - m_fragmentOffset);
+        if (m_fragment) {
+            std::memcpy(out + filled, m_fragment + m_fragmentOffset, chunk);
+        } else {
+            std::memset(out + filled, 0, chunk);
+        }
+        filled += chunk;
+        m_fragmentOffset += chunk;
+        
+        if (m_fragmentOffset == m_fragmentSize) {
+            releaseFragment();
+        }
+    }
+    
+    pa_threaded_mainloop_unlock(m_mainloop);
+    return true;
+}
+
+bool PulseAsyncBackend::queryDeviceFormat(const QByteArray& device, int& rate, int& channels) {
+    SourceQuery query{m_mainloop, {}, false, {}, false};
+    const char* name = device.isEmpty() ? "@DEFAULT_SOURCE@" : device.constData();
+    waitFor(m_mainloop, pa_context_get_source_info_by_name(m_context, name, &sourceInfoCallback, &query));
+    if (!query.found || !pa_sample_spec_valid(&query.spec)) {
+        return false;
+    }
+    rate = static_cast<int>(query.spec.rate);
+    channels = static_cast<int>(query.spec.channels);
+    return true;
+}
+
+std::vector<AudioBackend::Device> PulseAsyncBackend::listSources() {
+    pa_threaded_mainloop* mainloop = pa_threaded_mainloop_new();
+    if (!mainloop) {
+        return {};
+    }
+    pa_context* context = pa_context_new(pa_threaded_mainloop_get_api(mainloop), "SpeechRecorder");
+    pa_context_set_state_callback(context, [](pa_context*, void* userdata) {
+        pa_threaded_mainloop_signal(static_cast<pa_threaded_mainloop*>(userdata), 0);
+    }, mainloop);
+    
+    SourceQuery query{mainloop, {}, false, {}, false};
+    pa_time_event* deadline = nullptr;
+    pa_threaded_mainloop_lock(mainloop);
+    if (pa_context_connect(context, nullptr, PA_CONTEXT_NOFLAGS, nullptr) >= 0
+        && pa_threaded_mainloop_start(mainloop) >= 0) {
+        // a server that takes the connection and then never answers must
+        // not hang the caller, the settings dialog waits on this
+        deadline = pa_context_rttime_new(context, pa_rtclock_now() + LIST_TIMEOUT_MS * PA_USEC_PER_MSEC,
+            [](pa_mainloop_api*, pa_time_event*, const struct timeval*, void* userdata) {
+                auto* query = static_cast<SourceQuery*>(userdata);
+                query->timedOut = true;
+                pa_threaded_mainloop_signal(query->mainloop, 0);
+            }, &query);
+        
+        pa_context_state_t state;
+        while ((state = pa_context_get_state(context)) != PA_CONTEXT_READY && PA_CONTEXT_IS_GOOD(state)
+               && !query.timedOut) {
+            pa_threaded_mainloop_wait(mainloop);
+        }
+        if (state == PA_CONTEXT_READY) {
+            waitFor(mainloop, pa_context_get_source_info_list(context, &sourceInfoCallback, &query),
+                    &query.timedOut);
+        }
+    }
+    if (deadline) {
+        pa_threaded_mainloop_get_api(mainloop)->time_free(deadline);
+    }
+    if (query.timedOut) {
+        qWarning() << "PulseAudio didn't list its sources within" << LIST_TIMEOUT_MS << "ms";
+    }
+    pa_context_disconnect(context);
+    pa_context_unref(context);
+    pa_threaded_mainloop_unlock(mainloop);
+    
+    pa_threaded_mainloop_stop(mainloop);
+    pa_threaded_mainloop_free(mainloop);
+    return query.devices;
+}
+
+void PulseAsyncBackend::releaseFragment() {
+    if (m_hasFragment) {
+        pa_stream_drop(m_stream);
+        m_hasFragment = false;
+        m_fragment = nullptr;
+        m_fragmentSize = 0;
+        m_fragmentOffset = 0;
+    }
+}
+
+double PulseAsyncBackend::latencyMs() const {
+    pa_threaded_mainloop_lock(m_mainloop);
+    
+    // source latency (device -> server) plus whatever sits in our buffer;
+    // a plain getter, the caller logs it if it wants to
+    double result = -1.0;
+    pa_usec_t usec = 0;
+    int negative = 0;
+    if (pa_stream_get_latency(m_stream, &usec, &negative) == 0) {
+        result = (negative ? -1.0 : 1.0) * usec / 1000.0;
+    }
+    
+    pa_threaded_mainloop_unlock(m_mainloop);
+    return result;
+}
+
+void PulseAsyncBackend::contextStateCallback(pa_context* context, void* userdata) {
+    Q_UNUSED(context);
+    auto* self = static_cast<PulseAsyncBackend*>(userdata);
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
+
+void PulseAsyncBackend::streamStateCallback(pa_stream* stream, void* userdata) {
+    Q_UNUSED(stream);
+    auto* self = static_cast<PulseAsyncBackend*>(userdata);
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
+
+void PulseAsyncBackend::streamReadCallback(pa_stream* stream, size_t nbytes, void* userdata) {
+    Q_UNUSED(stream);
+    Q_UNUSED(nbytes);
+    auto* self = static_cast<PulseAsyncBackend*>(userdata);
+    pa_threaded_mainloop_signal(self->m_mainloop, 0);
+}
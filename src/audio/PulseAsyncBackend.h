@@ -0,0 +1,58 @@
+#ifndef PULSEASYNCBACKEND_H
+#define PULSEASYNCBACKEND_H
+
+#include "AudioBackend.h"
+#include <atomic>
+
+// forward declare to avoid pulse headers in header file
+typedef struct pa_threaded_mainloop pa_threaded_mainloop;
+typedef struct pa_context pa_context;
+typedef struct pa_stream pa_stream;
+
+// pa_stream on a pa_threaded_mainloop. Gives explicit control over fragsize
+// and maxlength, and corks the stream while idle so no stale audio is
+// buffered between recordings. Unlike pa_simple it can look the device up
+// first, so a "native" Config gets the device's own rate and channels.
+class PulseAsyncBackend : public AudioBackend {
+public:
+    explicit PulseAsyncBackend(const Config& config);
+    ~PulseAsyncBackend() override;
+    
+    void start() override;
+    void stop() override;
+    bool read(int16_t* buffer, size_t samples, QString& error) override;
+    double latencyMs() const override;
+    int sampleRate() const override { return m_sampleRate; }
+    int channels() const override { return m_channels; }
+    QString name() const override { return "pulse-async"; }
+    
+    // What AudioBackend::devices() returns; connects just for the query and
+    // gives up after LIST_TIMEOUT_MS with whatever it has
+    static std::vector<Device> listSources();
+    
+private:
+    static void contextStateCallback(pa_context* context, void* userdata);
+    static void streamStateCallback(pa_stream* stream, void* userdata);
+    static void streamReadCallback(pa_stream* stream, size_t nbytes, void* userdata);
+    
+    void releaseFragment();   // mainloop lock must be held
+    bool queryDeviceFormat(const QByteArray& device, int& rate, int& channels);   // same
+    void cleanup();
+    
+    pa_threaded_mainloop* m_mainloop;
+    pa_context* m_context;
+    pa_stream* m_stream;
+    std::atomic<bool> m_active;
+    int m_sampleRate;
+    int m_channels;
+    
+    // fragment currently being consumed by read(), valid until pa_stream_drop
+    const uint8_t* m_fragment;
+    size_t m_fragmentSize;
+    size_t m_fragmentOffset;
+    bool m_hasFragment;
+    
+    static constexpr int LIST_TIMEOUT_MS = 2000;
+};
+
+#endif // PULSEASYNCBACKEND_H
@@ -0,0 +1,83 @@
+#include "PulseSimpleBackend.h"
+#include <pulse/simple.h>
+#include <pulse/error.h>
+#include <QDebug>
+#include <stdexcept>
+
+PulseSimpleBackend::PulseSimpleBackend(const Config& config)
+    : m_handle(nullptr)
+    , m_sampleRate(config.sampleRate > 0 ? config.sampleRate : FALLBACK_RATE)
+    , m_channels(config.channels > 0 ? config.channels : FALLBACK_CHANNELS) {
+    
+    // 1a. setup sample format
+    pa_sample_spec ss;
+    ss.format = PA_SAMPLE_S16LE;   // 16-bit signed little-endian
+    ss.channels = static_cast<uint8_t>(m_channels);
+    ss.rate = static_cast<uint32_t>(m_sampleRate);
+    
+    // 1b. ask for fragments of the requested latency instead of the default
+    pa_buffer_attr attr;
+    attr.maxlength = pa_usec_to_bytes(static_cast<pa_usec_t>(config.bufferMs) * 1000, &ss);
+    attr.fragsize = pa_usec_to_bytes(static_cast<pa_usec_t>(config.latencyMs) * 1000, &ss);
+    attr.tlength = static_cast<uint32_t>(-1);
+    attr.prebuf = static_cast<uint32_t>(-1);
+    attr.minreq = static_cast<uint32_t>(-1);
+    
+    QByteArray device = config.device.toUtf8();
+    int error = 0;
+    
+    // 1c. create pulse simple connection
+    m_handle = pa_simple_new(
+        nullptr,                    // default server
+        "SpeechRecorder",           // app name
+        PA_STREAM_RECORD,           // recording stream
+        device.isEmpty() ? nullptr : device.constData(),
+        "Speech Input",             // stream description
+        &ss,                        // sample spec
+        nullptr,                    // default channel map
+        &attr,                      // buffer attrs
+        &error                      // error code
+    );
+    
+    if (!m_handle) {
+        throw std::runtime_error(
+            QString("PulseAudio init failed: %1").arg(pa_strerror(error)).toStdString()
+        );
+    }
+}
+
+PulseSimpleBackend::~PulseSimpleBackend() {
+    if (m_handle) {
+        pa_simple_free(m_handle);
+    }
+}
+
+void PulseSimpleBackend::start() {
+    // 2a. the stream never stops, drop what accumulated since the last take
+    int error = 0;
+    if (pa_simple_flush(m_handle, &error) < 0) {
+        qWarning() << "pa_simple_flush failed:" << pa_strerror(error);
+    }
+}
+
+void PulseSimpleBackend::stop() {
+    // nothing to do, read() returns after at most one fragment
+}
+
+bool PulseSimpleBackend::read(int16_t* buffer, size_t samples, QString& error) {
+    int code = 0;
+    if (pa_simple_read(m_handle, buffer, samples * sizeof(int16_t), &code) < 0) {
+        error = QString("Read error: %1").arg(pa_strerror(code));
+        return false;
+    }
+    return true;
+}
+
+double PulseSimpleBackend::latencyMs() const {
+    int error = 0;
+    pa_usec_t usec = pa_simple_get_latency(m_handle, &error);
+    if (usec == static_cast<pa_usec_t>(-1)) {
+        return -1.0;
+    }
+    return usec / 1000.0;
+}
@@ -0,0 +1,35 @@
+#ifndef PULSESIMPLEBACKEND_H
+#define PULSESIMPLEBACKEND_H
+
+#include "AudioBackend.h"
+
+// forward declare to avoid pulse headers in header file
+typedef struct pa_simple pa_simple;
+
+// Blocking pa_simple stream. Simple and robust, but the stream keeps running
+// between recordings so start() has to flush whatever piled up. pa_simple
+// can't ask the device for its format, so a "native" request gets 16 kHz
+// mono converted by the server, as before.
+class PulseSimpleBackend : public AudioBackend {
+public:
+    explicit PulseSimpleBackend(const Config& config);
+    ~PulseSimpleBackend() override;
+    
+    void start() override;
+    void stop() override;
+    bool read(int16_t* buffer, size_t samples, QString& error) override;
+    double latencyMs() const override;
+    int sampleRate() const override { return m_sampleRate; }
+    int channels() const override { return m_channels; }
+    QString name() const override { return "pulse-simple"; }
+    
+private:
+    pa_simple* m_handle;
+    int m_sampleRate;
+    int m_channels;
+    
+    static constexpr int FALLBACK_RATE = 16000;
+    static constexpr int FALLBACK_CHANNELS = 1;
+};
+
+#endif // PULSESIMPLEBACKEND_H
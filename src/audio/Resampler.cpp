@@ -0,0 +1,220 @@
+#include "Resampler.h"
+#include "AudioDsp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    struct Design {
+        size_t taps;       // per phase, counted at the lower of the two rates
+        double beta;       // Kaiser window shape, sets the stopband depth
+        double rolloff;    // cutoff as a fraction of the lower Nyquist
+    };
+    
+    Design designFor(Resampler::Quality quality) {
+        switch (quality) {
+            case Resampler::Quality::Fast: return {16, 5.0, 0.80};
+            case Resampler::Quality::Best: return {64, 9.0, 0.92};
+            default:                       return {32, 7.0, 0.88};
+        }
+    }
+    
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 50; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+    
+    int16_t toPcm(float value) {
+        value *= 32768.0f;
+        value = std::max(-32768.0f, std::min(32767.0f, value));
+        return static_cast<int16_t>(std::nearbyint(value));
+    }
+}
+
+Resampler::Resampler(int inputRate, int channels, int outputRate, Quality quality)
+    : m_inputRate(inputRate)
+    , m_outputRate(outputRate)
+    , m_channels(channels)
+    , m_up(1)
+    , m_down(1)
+    , m_taps(0)
+    , m_direct(inputRate == outputRate) {
+    
+    if (inputRate <= 0 || outputRate <= 0 || channels <= 0) {
+        throw std::invalid_argument("Resampler: rates and channel count must be positive");
+    }
+    
+    if (!m_direct) {
+        design(quality);
+    }
+    m_history.resize(m_taps + CHUNK_FRAMES);
+    reset();
+}
+
+void Resampler::design(Quality quality) {
+    // 1a. reduce the ratio: 48000 -> 16000 is 1/3, 44100 -> 16000 is 160/441
+    size_t divisor = std::gcd(static_cast<size_t>(m_inputRate), static_cast<size_t>(m_outputRate));
+    m_up = m_outputRate / divisor;
+    m_down = m_inputRate / divisor;
+    
+    // 1b. taps per phase: longer when decimating so the transition band
+    //     stays as narrow relative to the output rate
+    const Design params = designFor(quality);
+    const double decimation = std::max(1.0, static_cast<double>(m_inputRate) / m_outputRate);
+    m_taps = static_cast<size_t>(std::ceil(params.taps * decimation));
+    m_taps = (m_taps + AudioDsp::DOT_ALIGN - 1) / AudioDsp::DOT_ALIGN * AudioDsp::DOT_ALIGN;
+    m_taps = std::min(m_taps, CHUNK_FRAMES);   // only for absurd ratios; drain() relies on it
+    
+    // 1c. prototype lowpass at the upsampled rate, cutoff below the lower
+    //     of the two Nyquist frequencies
+    const size_t length = m_taps * m_up;
+    const double pi = 3.14159265358979323846;
+    const double cutoff = params.rolloff * 0.5 * std::min(m_inputRate, m_outputRate)
+                          / (static_cast<double>(m_inputRate) * m_up);   // cycles per sample
+    
+    // centred on an output sample rather than mid-filter, so the delay is
+    // a whole number of output samples and align() can remove it exactly
+    const double center = static_cast<double>(delay() * m_down);
+    const double halfWidth = std::min(center, length - 1 - center);
+    const double windowNorm = besselI0(params.beta);
+    
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+    for (size_t m = 0; m < length; ++m) {
+        double t = m - center;
+        double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * t) / (pi * t);
+        double r = t / halfWidth;
+        double window = std::fabs(r) > 1.0 ? 0.0
+                      : besselI0(params.beta * std::sqrt(1.0 - r * r)) / windowNorm;
+        prototype[m] = sinc * window;
+        sum += prototype[m];
+    }
+    
+    // 1d. split into phases, reversed so each output is a forward dot
+    //     product over the history; unity gain at DC for every phase
+    //     (zero-stuffing by L would otherwise scale the signal by 1/L)
+    m_phases.assign(m_up * m_taps, 0.0f);
+    for (size_t p = 0; p < m_up; ++p) {
+        for (size_t k = 0; k < m_taps; ++k) {
+            m_phases[p * m_taps + (m_taps - 1 - k)] = static_cast<float>(prototype[p + k * m_up] * m_up / sum);
+        }
+    }
+}
+
+void Resampler::reset() {
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_fill = m_direct ? 0 : m_taps - 1;
+    m_next = m_fill;
+    m_phase = 0;
+}
+
+size_t Resampler::process(const int16_t* input, size_t frames, int16_t* output) {
+    size_t written = 0;
+    while (frames > 0) {
+        const size_t n = std::min(frames, CHUNK_FRAMES);
+        
+        // 2a. downmix into the history, after what the filter still needs
+        AudioDsp::downmixToFloat(input, n, m_channels, m_history.data() + m_fill);
+        written += filter(n, output + written);
+        input += n * m_channels;
+        frames -= n;
+    }
+    return written;
+}
+
+size_t Resampler::drain(int16_t* output) {
+    if (m_direct) {
+        return 0;
+    }
+    std::fill(m_history.begin() + m_fill, m_history.begin() + m_fill + m_taps, 0.0f);
+    return filter(m_taps, output);
+}
+
+size_t Resampler::filter(size_t added, int16_t* output) {
+    size_t written = 0;
+    if (m_direct) {
+        for (size_t i = 0; i < added; ++i) {
+            output[written++] = toPcm(m_history[i]);
+        }
+        return written;
+    }
+    m_fill += added;
+    
+    // 2b. every output whose newest input sample has arrived
+    while (m_next < m_fill) {
+        const float* phase = m_phases.data() + m_phase * m_taps;
+        const float* window = m_history.data() + m_next + 1 - m_taps;
+        output[written++] = toPcm(AudioDsp::dotProduct(phase, window, m_taps));
+        
+        m_phase += m_down;
+        m_next += m_phase / m_up;
+        m_phase %= m_up;
+    }
+    
+    // 2c. keep only the history the next output reaches back to
+    size_t keepFrom = std::min(m_next + 1 - m_taps, m_fill);
+    std::memmove(m_history.data(), m_history.data() + keepFrom, (m_fill - keepFrom) * sizeof(float));
+    m_fill -= keepFrom;
+    m_next -= keepFrom;
+    return written;
+}
+
+size_t Resampler::maxOutput(size_t frames) const {
+    if (m_direct) {
+        return frames;
+    }
+    return frames * m_up / m_down + 2;
+}
+
+size_t Resampler::delay() const {
+    if (m_direct) {
+        return 0;
+    }
+    // the prototype's centre, at the upsampled rate, in output samples
+    return (m_taps * m_up - 1) / 2 / m_down;
+}
+
+std::vector<int16_t> Resampler::convert(const int16_t* input, size_t frames, int channels,
+                                        int inputRate, int outputRate, Quality quality) {
+    Resampler resampler(inputRate, channels, outputRate, quality);
+    std::vector<int16_t> output(resampler.maxOutput(frames) + resampler.maxOutput(resampler.taps()));
+    size_t written = resampler.process(input, frames, output.data());
+    written += resampler.drain(output.data() + written);
+    output.resize(written);
+    resampler.align(output, frames);
+    return output;
+}
+
+size_t Resampler::outputLength(size_t frames) const {
+    return static_cast<size_t>((static_cast<uint64_t>(frames) * m_outputRate + m_inputRate - 1) / m_inputRate);
+}
+
+void Resampler::align(std::vector<int16_t>& output, size_t frames) const {
+    output.erase(output.begin(), output.begin() + std::min(delay(), output.size()));
+    output.resize(outputLength(frames));
+}
+
+Resampler::Quality Resampler::qualityFromName(const char* name) {
+    std::string value = name ? name : "";
+    if (value == "fast") return Quality::Fast;
+    if (value == "best") return Quality::Best;
+    return Quality::Balanced;
+}
+
+const char* Resampler::qualityName(Quality quality) {
+    switch (quality) {
+        case Quality::Fast: return "fast";
+        case Quality::Best: return "best";
+        default:            return "balanced";
+    }
+}
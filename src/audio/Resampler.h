@@ -0,0 +1,92 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Downmix and sample rate conversion to what the engines take (16 kHz
+// mono), for capture at the device's native format and for files.
+//
+// Polyphase FIR: the rate ratio is reduced to L/M, a Kaiser-windowed sinc
+// is designed once for the upsampled-by-L rate and split into L phases,
+// and every output sample is one AudioDsp::dotProduct of a phase against
+// the input history. Each phase is stored reversed and zero-padded to
+// DOT_ALIGN taps, so the inner loop is the vectorized kernel with no tail.
+// The filter length grows with the decimation factor, which keeps the
+// transition band the same width in output terms whatever the input rate.
+//
+// Streaming: process() can be fed any number of frames at a time and
+// carries the filter history across calls. All buffers are allocated in
+// the constructor; process() never allocates.
+class Resampler {
+public:
+    enum class Quality {
+        Fast,        // ~50 dB stopband, shortest filter
+        Balanced,    // ~70 dB
+        Best         // ~90 dB, flattest passband
+    };
+    
+    Resampler(int inputRate, int channels, int outputRate = 16000,
+              Quality quality = Quality::Balanced);
+    
+    Resampler(const Resampler&) = delete;
+    Resampler& operator=(const Resampler&) = delete;
+    
+    void reset();
+    
+    // Consumes `frames` interleaved frames and writes the mono output
+    // samples they complete, at most maxOutput(frames). Returns the count.
+    size_t process(const int16_t* input, size_t frames, int16_t* output);
+    size_t maxOutput(size_t frames) const;
+    
+    // End of input: pushes silence through so the last frames' output comes
+    // out too. Writes at most maxOutput(taps()) samples.
+    size_t drain(int16_t* output);
+    
+    // For a stream that was drained: trims the filter delay off the front
+    // and cuts to the length `frames` input frames map to, so the result
+    // lines up with the input sample for sample.
+    void align(std::vector<int16_t>& output, size_t frames) const;
+    size_t outputLength(size_t frames) const;
+    
+    // All of the above, for audio already in memory
+    static std::vector<int16_t> convert(const int16_t* input, size_t frames, int channels,
+                                        int inputRate, int outputRate = 16000,
+                                        Quality quality = Quality::Best);
+    
+    int inputRate() const { return m_inputRate; }
+    int outputRate() const { return m_outputRate; }
+    int channels() const { return m_channels; }
+    size_t taps() const { return m_taps; }   // per phase, padded
+    bool isPassthrough() const { return m_direct; }
+    
+    // Output samples of delay the filter adds
+    size_t delay() const;
+    
+    // "fast", "balanced", "best"; anything else is Balanced
+    static Quality qualityFromName(const char* name);
+    static const char* qualityName(Quality quality);
+    
+private:
+    void design(Quality quality);
+    size_t filter(size_t added, int16_t* output);
+    
+    int m_inputRate;
+    int m_outputRate;
+    int m_channels;
+    size_t m_up;          // L
+    size_t m_down;        // M
+    size_t m_taps;        // per phase, a multiple of AudioDsp::DOT_ALIGN
+    bool m_direct;        // same rate: downmix only
+    
+    std::vector<float> m_phases;    // m_up phases of m_taps, each reversed
+    std::vector<float> m_history;   // m_taps - 1 samples of history + CHUNK_FRAMES
+    size_t m_fill;        // samples in m_history
+    size_t m_next;        // index of the newest sample the next output needs
+    size_t m_phase;       // 0..m_up-1
+    
+    static constexpr size_t CHUNK_FRAMES = 4096;   // input frames downmixed per pass
+};
+
+#endif // RESAMPLER_H
@@ -0,0 +1,143 @@
+#include "SpectralSubtractor.h"
+#include <algorithm>
+#include <cmath>
+
+SpectralSubtractor::SpectralSubtractor() {
+    const double pi = 3.14159265358979323846;
+    
+    // 1a. periodic sqrt-Hann: applied twice it is a Hann window, which sums
+    //     to exactly one at 50% overlap, so clean input comes out unchanged
+    for (size_t i = 0; i < FRAME; ++i) {
+        m_window[i] = static_cast<float>(std::sqrt(0.5 - 0.5 * std::cos(2.0 * pi * i / FRAME)));
+    }
+    
+    // 1b. FFT tables
+    for (size_t i = 0; i < FRAME / 2; ++i) {
+        m_twiddles[i] = std::polar(1.0f, static_cast<float>(-2.0 * pi * i / FRAME));
+    }
+    size_t bits = 0;
+    while ((size_t(1) << bits) < FRAME) {
+        ++bits;
+    }
+    for (size_t i = 0; i < FRAME; ++i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = static_cast<uint16_t>(reversed);
+    }
+    
+    reset();
+}
+
+void SpectralSubtractor::reset() {
+    m_input.fill(0.0f);
+    m_noise.fill(0.0f);
+    m_overlap.fill(0.0f);
+    m_ready.fill(0.0f);
+    m_hopFill = 0;
+    m_floorDb = 0.0f;
+    m_noiseKnown = false;
+}
+
+void SpectralSubtractor::process(int16_t* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // swap the incoming sample for the delayed output
+        m_input[FRAME - HOP + m_hopFill] = samples[i];
+        float out = std::nearbyint(m_ready[m_hopFill]);
+        samples[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, out)));
+        
+        if (++m_hopFill == HOP) {
+            processFrame();
+            m_hopFill = 0;
+        }
+    }
+}
+
+void SpectralSubtractor::processFrame() {
+    // 2a. analysis
+    for (size_t i = 0; i < FRAME; ++i) {
+        m_spectrum[i] = std::complex<float>(m_input[i] * m_window[i], 0.0f);
+    }
+    fft(false);
+    
+    // 2b. frame energy against a floor that drops at once and rises slowly
+    std::array<float, BINS> power;
+    float energy = 0.0f;
+    for (size_t k = 0; k < BINS; ++k) {
+        power[k] = std::norm(m_spectrum[k]);
+        energy += power[k];
+    }
+    float db = 10.0f * std::log10(energy + 1.0f);
+    if (!m_noiseKnown || db < m_floorDb) {
+        m_floorDb = db;
+    } else {
+        m_floorDb += (db - m_floorDb) * FLOOR_RISE;
+    }
+    
+    // 2c. frames near the floor are background: learn their spectrum
+    if (!m_noiseKnown) {
+        m_noise = power;
+        m_noiseKnown = true;
+    } else if (db < m_floorDb + NOISE_FRAME_DB) {
+        for (size_t k = 0; k < BINS; ++k) {
+            m_noise[k] += (power[k] - m_noise[k]) * NOISE_SMOOTHING;
+        }
+    }
+    
+    // 2d. power subtraction, bounded below by the spectral floor; the
+    //     spectrum of real input is symmetric, so mirror each gain
+    for (size_t k = 0; k < BINS; ++k) {
+        float ratio = power[k] > 0.0f ? m_noise[k] / power[k] : 1.0f;
+        float gain = std::sqrt(std::max(1.0f - OVER_SUBTRACTION * ratio,
+                                        SPECTRAL_FLOOR * SPECTRAL_FLOOR));
+        m_spectrum[k] *= gain;
+        if (k > 0 && k < FRAME / 2) {
+            m_spectrum[FRAME - k] *= gain;
+        }
+    }
+    
+    // 2e. synthesis and overlap-add
+    fft(true);
+    for (size_t i = 0; i < FRAME; ++i) {
+        m_overlap[i] += m_spectrum[i].real() * m_window[i];
+    }
+    std::copy(m_overlap.begin(), m_overlap.begin() + HOP, m_ready.begin());
+    std::copy(m_overlap.begin() + HOP, m_overlap.end(), m_overlap.begin());
+    std::fill(m_overlap.begin() + HOP, m_overlap.end(), 0.0f);
+    
+    // 2f. slide the input window by one hop
+    std::copy(m_input.begin() + HOP, m_input.end(), m_input.begin());
+}
+
+void SpectralSubtractor::fft(bool inverse) {
+    // iterative radix-2, in place on m_spectrum
+    for (size_t i = 0; i < FRAME; ++i) {
+        if (i < m_bitReverse[i]) {
+            std::swap(m_spectrum[i], m_spectrum[m_bitReverse[i]]);
+        }
+    }
+    
+    for (size_t length = 2; length <= FRAME; length <<= 1) {
+        const size_t half = length / 2;
+        const size_t stride = FRAME / length;
+        for (size_t start = 0; start < FRAME; start += length) {
+            for (size_t j = 0; j < half; ++j) {
+                std::complex<float> twiddle = m_twiddles[j * stride];
+                if (inverse) {
+                    twiddle = std::conj(twiddle);
+                }
+                std::complex<float> odd = m_spectrum[start + j + half] * twiddle;
+                m_spectrum[start + j + half] = m_spectrum[start + j] - odd;
+                m_spectrum[start + j] += odd;
+            }
+        }
+    }
+    
+    if (inverse) {
+        const float scale = 1.0f / FRAME;
+        for (std::complex<float>& value : m_spectrum) {
+            value *= scale;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef SPECTRALSUBTRACTOR_H
+#define SPECTRALSUBTRACTOR_H
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+// Streaming spectral subtraction for steady background noise (fans, hum,
+// hiss). Short-time spectra over 32 ms frames with 50% overlap; the noise
+// spectrum is learned from the quietest frames and subtracted with a
+// spectral floor so it doesn't leave "musical" artefacts behind.
+//
+// All state is fixed-size and set up in the constructor, so process()
+// never allocates and can run on the capture thread. Output is delayed by
+// FRAME samples (32 ms at 16 kHz).
+class SpectralSubtractor {
+public:
+    static constexpr size_t FRAME = 512;
+    static constexpr size_t HOP = FRAME / 2;
+    
+    SpectralSubtractor();
+    
+    void reset();
+    
+    // In place, any block size
+    void process(int16_t* samples, size_t count);
+    
+private:
+    void processFrame();
+    void fft(bool inverse);
+    
+    static constexpr size_t BINS = FRAME / 2 + 1;
+    
+    std::array<float, FRAME> m_window;        // sqrt-Hann, used for analysis and synthesis
+    std::array<std::complex<float>, FRAME / 2> m_twiddles;
+    std::array<uint16_t, FRAME> m_bitReverse;
+    
+    std::array<float, FRAME> m_input;         // last FRAME input samples
+    std::array<std::complex<float>, FRAME> m_spectrum;
+    std::array<float, BINS> m_noise;          // estimated noise power per bin
+    std::array<float, FRAME> m_overlap;       // synthesis tail carried to the next frame
+    std::array<float, HOP> m_ready;           // output for the hop being filled
+    size_t m_hopFill;
+    float m_floorDb;                          // quietest recent frame energy
+    bool m_noiseKnown;
+    
+    static constexpr float OVER_SUBTRACTION = 2.0f;
+    static constexpr float SPECTRAL_FLOOR = 0.1f;     // never attenuate a bin below -20 dB
+    static constexpr float NOISE_FRAME_DB = 3.0f;     // frames this close to the floor are noise
+    static constexpr float NOISE_SMOOTHING = 0.1f;
+    static constexpr float FLOOR_RISE = 0.005f;       // per frame, ~3 s time constant
+};
+
+#endif // SPECTRALSUBTRACTOR_H
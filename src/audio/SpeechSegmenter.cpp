@@ -0,0 +1,62 @@
+#include "SpeechSegmenter.h"
+#include "VoiceActivityDetector.h"
+#include <algorithm>
+
+SpeechSegmenter::SpeechSegmenter()
+    : m_position(0)
+    , m_inSpeech(false) {
+}
+
+void SpeechSegmenter::reset() {
+    m_raw.clear();
+    m_position = 0;
+    m_inSpeech = false;
+}
+
+void SpeechSegmenter::add(size_t samples, bool speech) {
+    if (speech) {
+        if (m_inSpeech) {
+            m_raw.back().end = m_position + samples;
+        } else {
+            m_raw.push_back({m_position, m_position + samples});
+        }
+    }
+    m_inSpeech = speech;
+    m_position += samples;
+}
+
+std::vector<SpeechSegmenter::Span> SpeechSegmenter::finish() const {
+    std::vector<Span> spans;
+    
+    for (const Span& raw : m_raw) {
+        // 1a. blips too short to be a word
+        if (raw.end - raw.begin < MIN_SPEECH_SAMPLES) {
+            continue;
+        }
+        
+        // 1b. pad, clamped to the recording
+        Span span;
+        span.begin = raw.begin > PAD_SAMPLES ? raw.begin - PAD_SAMPLES : 0;
+        span.end = std::min(raw.end + PAD_SAMPLES, m_position);
+        
+        // 1c. bridge short pauses into the previous span
+        if (!spans.empty() && span.begin < spans.back().end + MIN_GAP_SAMPLES) {
+            spans.back().end = std::max(spans.back().end, span.end);
+        } else {
+            spans.push_back(span);
+        }
+    }
+    return spans;
+}
+
+std::vector<SpeechSegmenter::Span> SpeechSegmenter::analyse(const int16_t* samples, size_t count,
+                                                            VoiceActivityDetector& detector,
+                                                            size_t blockSamples) {
+    SpeechSegmenter segmenter;
+    detector.reset();
+    for (size_t offset = 0; offset < count; offset += blockSamples) {
+        size_t n = std::min(blockSamples, count - offset);
+        segmenter.add(n, detector.isSpeech(samples + offset, n));
+    }
+    return segmenter.finish();
+}
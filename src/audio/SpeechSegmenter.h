@@ -0,0 +1,46 @@
+#ifndef SPEECHSEGMENTER_H
+#define SPEECHSEGMENTER_H
+
+#include "AudioBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class VoiceActivityDetector;
+
+// Turns per-block VAD decisions into the speech spans stored with an
+// AudioBuffer. Spans are padded so word onsets and tails survive, short
+// gaps are bridged so a sentence isn't cut into pieces, and isolated
+// blips (a click, a cough of one block) are dropped.
+//
+// Fed on the GUI thread as the capture ring is drained; the capture thread
+// only makes the decisions.
+class SpeechSegmenter {
+public:
+    using Span = AudioBuffer::Span;
+    
+    SpeechSegmenter();
+    
+    void reset();
+    void add(size_t samples, bool speech);
+    
+    // Spans over everything added so far, in samples
+    std::vector<Span> finish() const;
+    
+    // Runs `detector` over a whole recording in blocks, for audio that
+    // didn't come through the capture loop (files)
+    static std::vector<Span> analyse(const int16_t* samples, size_t count,
+                                     VoiceActivityDetector& detector, size_t blockSamples = 1024);
+    
+private:
+    std::vector<Span> m_raw;   // unpadded runs of speech blocks
+    size_t m_position;
+    bool m_inSpeech;
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr size_t PAD_SAMPLES = SAMPLE_RATE * 300 / 1000;        // both sides
+    static constexpr size_t MIN_GAP_SAMPLES = SAMPLE_RATE * 800 / 1000;    // bridged below this
+    static constexpr size_t MIN_SPEECH_SAMPLES = SAMPLE_RATE * 100 / 1000; // dropped below this
+};
+
+#endif // SPEECHSEGMENTER_H
@@ -0,0 +1,10 @@
+#include "VoiceActivityDetector.h"
+#include "EnergyVad.h"
+#include <QDebug>
+
+std::unique_ptr<VoiceActivityDetector> VoiceActivityDetector::create(const QString& type) {
+    if (type != "energy") {
+        qWarning() << "Unknown voice activity detector" << type << "- using energy";
+    }
+    return std::make_unique<EnergyVad>();
+}
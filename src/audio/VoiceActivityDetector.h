@@ -0,0 +1,31 @@
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Per-block speech/non-speech decision, made on the capture thread for
+// every block AudioRecorder reads. Implementations must not allocate or
+// block in isSpeech(); a model-based detector plugs in here next to the
+// energy one. Turning decisions into padded speech spans is SpeechSegmenter's
+// job, so detectors only judge the block in front of them.
+class VoiceActivityDetector {
+public:
+    virtual ~VoiceActivityDetector() = default;
+    
+    // Forget adaptive state before a new recording
+    virtual void reset() = 0;
+    
+    // 16 kHz mono block, typically AudioRecorder::BUFFER_SIZE samples
+    virtual bool isSpeech(const int16_t* samples, size_t count) = 0;
+    
+    virtual QString name() const = 0;
+    
+    // Pick a detector by name. Only "energy" exists so far; unknown names
+    // fall back to it.
+    static std::unique_ptr<VoiceActivityDetector> create(const QString& type = "energy");
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
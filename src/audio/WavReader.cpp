@@ -0,0 +1,142 @@
+#include "WavReader.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+bool WavReader::fail(const QString& error) {
+    m_error = QString("%1: %2").arg(m_file.fileName(), error);
+    m_file.close();
+    return false;
+}
+
+bool WavReader::open(const QString& path) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = QString("%1: %2").arg(path, m_file.errorString());
+        return false;
+    }
+    
+    // 1a. RIFF header
+    char riff[12];
+    if (m_file.read(riff, 12) != 12 || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return fail("not a RIFF/WAVE file");
+    }
+    
+    // 1b. walk the chunks until "data", picking up "fmt " on the way
+    bool haveFormat = false;
+    for (;;) {
+        char header[8];
+        if (m_file.read(header, 8) != 8) {
+            return fail("no data chunk");
+        }
+        quint32 size = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(header + 4));
+        
+        if (memcmp(header, "fmt ", 4) == 0) {
+            QByteArray fmt = m_file.read(size);
+            if (fmt.size() < 16) {
+                return fail("truncated fmt chunk");
+            }
+            const uchar* p = reinterpret_cast<const uchar*>(fmt.constData());
+            quint16 format = qFromLittleEndian<quint16>(p);
+            m_channels = qFromLittleEndian<quint16>(p + 2);
+            m_sampleRate = static_cast<int>(qFromLittleEndian<quint32>(p + 4));
+            m_bitsPerSample = qFromLittleEndian<quint16>(p + 14);
+            
+            // extensible: the real format is the first two bytes of the GUID
+            if (format == FORMAT_EXTENSIBLE && fmt.size() >= 26) {
+                format = qFromLittleEndian<quint16>(p + 24);
+            }
+            
+            m_isFloat = format == FORMAT_FLOAT;
+            if (format != FORMAT_PCM && format != FORMAT_FLOAT) {
+                return fail(QString("unsupported WAV format %1").arg(format));
+            }
+            if (m_isFloat ? m_bitsPerSample != 32
+                          : (m_bitsPerSample % 8 != 0 || m_bitsPerSample < 8 || m_bitsPerSample > 32)) {
+                return fail(QString("unsupported sample size %1 bits").arg(m_bitsPerSample));
+            }
+            if (m_channels < 1 || m_sampleRate < 1) {
+                return fail("invalid fmt chunk");
+            }
+            haveFormat = true;
+        } else if (memcmp(header, "data", 4) == 0) {
+            if (!haveFormat) {
+                return fail("data chunk before fmt chunk");
+            }
+            // streamed files leave the size at 0 or 0xFFFFFFFF
+            m_dataRemaining = (size == 0 || size == 0xFFFFFFFFu) ? -1 : static_cast<qint64>(size);
+            return true;
+        } else {
+            if (!m_file.seek(m_file.pos() + size)) {
+                return fail("truncated file");
+            }
+        }
+        
+        // chunks are word aligned
+        if (size & 1) {
+            m_file.seek(m_file.pos() + 1);
+        }
+    }
+}
+
+qint64 WavReader::frameCount() const {
+    if (m_dataRemaining < 0 || m_channels == 0) {
+        return -1;
+    }
+    return m_dataRemaining / (m_channels * (m_bitsPerSample / 8));
+}
+
+size_t WavReader::readMono(int16_t* out, size_t maxFrames) {
+    if (!m_file.isOpen() || maxFrames == 0) {
+        return 0;
+    }
+    
+    const size_t bytesPerSample = static_cast<size_t>(m_bitsPerSample / 8);
+    const size_t frameBytes = bytesPerSample * m_channels;
+    
+    // 2a. one block of raw frames into the reused buffer
+    qint64 want = static_cast<qint64>(maxFrames * frameBytes);
+    if (m_dataRemaining >= 0) {
+        want = std::min(want, m_dataRemaining);
+    }
+    m_raw.resize(static_cast<size_t>(want));
+    qint64 got = m_file.read(m_raw.data(), want);
+    if (got <= 0) {
+        return 0;
+    }
+    if (m_dataRemaining >= 0) {
+        m_dataRemaining -= got;
+    }
+    const size_t frames = static_cast<size_t>(got) / frameBytes;
+    
+    // 2b. convert each sample to a common scale and average the channels
+    const uchar* p = reinterpret_cast<const uchar*>(m_raw.data());
+    for (size_t f = 0; f < frames; ++f) {
+        float sum = 0.0f;
+        for (int c = 0; c < m_channels; ++c, p += bytesPerSample) {
+            float value;
+            if (m_isFloat) {
+                float sample;
+                memcpy(&sample, p, sizeof(float));
+                value = sample * 32768.0f;
+            } else if (bytesPerSample == 1) {
+                value = (static_cast<int>(p[0]) - 128) * 256.0f;        // 8-bit is unsigned
+            } else if (bytesPerSample == 2) {
+                value = qFromLittleEndian<qint16>(p);
+            } else if (bytesPerSample == 3) {
+                int32_t sample = static_cast<int32_t>((uint32_t(p[0]) << 8) |
+                                                      (uint32_t(p[1]) << 16) |
+                                                      (uint32_t(p[2]) << 24));
+                value = sample / 65536.0f;
+            } else {
+                value = qFromLittleEndian<qint32>(p) / 65536.0f;
+            }
+            sum += value;
+        }
+        
+        float mono = sum / m_channels;
+        out[f] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, mono)));
+    }
+    
+    return frames;
+}
@@ -0,0 +1,46 @@
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+// Reads RIFF/WAVE files block by block, so a long recording is never held
+// in memory in its on-disk format. Handles 8/16/24/32-bit integer and
+// 32-bit float PCM, plain or WAVE_FORMAT_EXTENSIBLE, any channel count.
+class WavReader {
+public:
+    WavReader() = default;
+    
+    // Parses the header and positions at the first sample
+    bool open(const QString& path);
+    QString errorString() const { return m_error; }
+    
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    int bitsPerSample() const { return m_bitsPerSample; }
+    qint64 frameCount() const;   // -1 if the header doesn't say
+    
+    // Reads up to maxFrames frames, averaged down to mono S16 at the file's
+    // own rate. Returns the number of frames read, 0 at the end of data.
+    size_t readMono(int16_t* out, size_t maxFrames);
+    
+private:
+    bool fail(const QString& error);
+    
+    QFile m_file;
+    QString m_error;
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    int m_bitsPerSample = 0;
+    bool m_isFloat = false;
+    qint64 m_dataRemaining = 0;     // bytes of sample data left, -1 = until EOF
+    std::vector<char> m_raw;        // reused block buffer
+    
+    static constexpr quint16 FORMAT_PCM = 1;
+    static constexpr quint16 FORMAT_FLOAT = 3;
+    static constexpr quint16 FORMAT_EXTENSIBLE = 0xFFFE;
+};
+
+#endif // WAVREADER_H
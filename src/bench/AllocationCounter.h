@@ -0,0 +1,39 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Heap allocations per thread, for the benchmarks and stress tests that
+// check a hot path never allocates. Per thread, so a consumer growing its
+// vectors doesn't show up in the producer's count.
+//
+// Works by replacing the global operator new/delete, which can't be
+// inline: include this from exactly one source file of an executable.
+namespace AllocationCounter {
+    inline thread_local size_t t_allocations = 0;
+    
+    // allocations made by the calling thread so far
+    inline size_t count() {
+        return t_allocations;
+    }
+}
+
+void* operator new(size_t size) {
+    ++AllocationCounter::t_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+#endif // ALLOCATIONCOUNTER_H
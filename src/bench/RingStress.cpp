@@ -0,0 +1,148 @@
+#include "AllocationCounter.h"
+#include "audio/AudioRingBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// ring-stress: hammers AudioRingBuffer from a producer and a consumer
+// thread and checks what comes out. Every block carries its sequence number
+// and a pattern derived from it, so a block seen twice, out of order, torn
+// or lost without being counted as an overrun fails the run. Exits non-zero
+// on any failure; registered with CTest.
+//
+//   ring-stress [blocks]     default 500,000 per pass
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t BLOCK_SAMPLES = 1024;   // AudioRecorder::BUFFER_SIZE
+constexpr size_t SMALL_RING = 4;         // overruns all the time
+constexpr size_t CAPTURE_RING = 256;     // AudioRecorder::RING_BLOCKS
+
+// Sample i of block `seq`; the first two samples hold the sequence number
+// itself, the rest a pattern a torn copy wouldn't reproduce
+int16_t sampleOf(uint32_t seq, size_t i) {
+    if (i == 0) return static_cast<int16_t>(seq & 0xFFFF);
+    if (i == 1) return static_cast<int16_t>(seq >> 16);
+    return static_cast<int16_t>((seq * 2654435761u + i * 40503u) >> 16);
+}
+
+struct PassResult {
+    size_t pushed = 0;
+    size_t dropped = 0;             // push() returned false
+    size_t received = 0;
+    size_t outOfOrder = 0;
+    size_t torn = 0;
+    size_t producerAllocations = 0;
+    size_t overruns = 0;            // as the ring counted them
+    double ms = 0.0;
+};
+
+// `wait`: the producer retries a full ring instead of dropping, so every
+// block has to arrive. Otherwise it behaves like the capture thread.
+template <size_t Capacity>
+PassResult runPass(size_t blocks, bool wait) {
+    using Ring = AudioRingBuffer<BLOCK_SAMPLES, Capacity>;
+    Ring* ring = new Ring();
+    PassResult result;
+    std::atomic<bool> producerDone{false};
+    
+    auto start = Clock::now();
+    std::thread consumer([&]() {
+        int64_t last = -1;
+        for (;;) {
+            bool done = producerDone.load(std::memory_order_acquire);
+            while (const typename Ring::Block* block = ring->front()) {
+                uint32_t seq = static_cast<uint16_t>(block->samples[0])
+                             | (static_cast<uint32_t>(static_cast<uint16_t>(block->samples[1])) << 16);
+                if (static_cast<int64_t>(seq) <= last) {
+                    ++result.outOfOrder;
+                }
+                last = seq;
+                
+                bool intact = block->count == BLOCK_SAMPLES - (seq % 7) && block->flags == (seq & 3);
+                for (size_t i = 2; intact && i < block->count; ++i) {
+                    intact = block->samples[i] == sampleOf(seq, i);
+                }
+                if (!intact) {
+                    ++result.torn;
+                }
+                ++result.received;
+                ring->release();
+            }
+            if (done) break;
+            std::this_thread::yield();
+        }
+    });
+    
+    std::thread producer([&]() {
+        int16_t pcm[BLOCK_SAMPLES];
+        size_t allocationsBefore = AllocationCounter::count();
+        for (uint32_t seq = 0; seq < blocks; ++seq) {
+            // short blocks and flags vary too, so they're checked as well
+            size_t count = BLOCK_SAMPLES - (seq % 7);
+            for (size_t i = 0; i < count; ++i) {
+                pcm[i] = sampleOf(seq, i);
+            }
+            bool pushed = ring->push(pcm, count, seq & 3);
+            while (!pushed && wait) {
+                std::this_thread::yield();
+                pushed = ring->push(pcm, count, seq & 3);
+            }
+            if (pushed) {
+                ++result.pushed;
+            } else {
+                ++result.dropped;
+            }
+        }
+        result.producerAllocations = AllocationCounter::count() - allocationsBefore;
+        producerDone.store(true, std::memory_order_release);
+    });
+    
+    producer.join();
+    consumer.join();
+    result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    result.overruns = ring->overruns();
+    delete ring;
+    return result;
+}
+
+bool check(const char* name, const PassResult& r, size_t blocks, bool wait) {
+    bool ok = r.pushed + r.dropped == blocks
+           && r.received == r.pushed
+           && r.overruns >= r.dropped
+           && r.outOfOrder == 0
+           && r.torn == 0
+           && r.producerAllocations == 0;
+    // waiting on a full ring counts each failed attempt as an overrun, so
+    // only dropping passes can compare the two exactly
+    if (!wait) {
+        ok = ok && r.overruns == r.dropped;
+    } else {
+        ok = ok && r.dropped == 0;
+    }
+    std::printf("%-22s %s  pushed %zu  dropped %zu  received %zu  overruns %zu  "
+                "out-of-order %zu  torn %zu  producer allocations %zu  %.0f ns/block\n",
+                name, ok ? "ok  " : "FAIL", r.pushed, r.dropped, r.received, r.overruns,
+                r.outOfOrder, r.torn, r.producerAllocations, r.ms * 1e6 / blocks);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t blocks = argc > 1 ? std::stoul(argv[1]) : 500000;
+    
+    bool ok = true;
+    ok = check("capture ring, lossless", runPass<CAPTURE_RING>(blocks, true), blocks, true) && ok;
+    ok = check("capture ring, dropping", runPass<CAPTURE_RING>(blocks, false), blocks, false) && ok;
+    ok = check("small ring, lossless", runPass<SMALL_RING>(blocks, true), blocks, true) && ok;
+    ok = check("small ring, dropping", runPass<SMALL_RING>(blocks, false), blocks, false) && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
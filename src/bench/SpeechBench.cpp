@@ -0,0 +1,909 @@
+#include "AllocationCounter.h"
+#include "WhisperTranscriber.h"
+#include "audio/AudioBuffer.h"
+#include "audio/AudioDsp.h"
+#include "audio/AudioRingBuffer.h"
+#include "audio/EnergyVad.h"
+#include "audio/NoiseGate.h"
+#include "audio/PreRollBuffer.h"
+#include "audio/Resampler.h"
+#include "audio/WavReader.h"
+#include "transcription/VoskEngine.h"
+#include "utils/SystemInfo.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+// speech-bench: real-time factor of the engines per model, thread count and
+// clip length, plus microbenchmarks of the sample kernels and the capture
+// path, the resampler, the noise gate and the armed pre-roll. Everything is reported as one
+// JSON document.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int SAMPLE_RATE = 16000;
+constexpr size_t CAPTURE_BLOCK = 1024;      // AudioRecorder::BUFFER_SIZE
+constexpr size_t CAPTURE_RING = 256;        // AudioRecorder::RING_BLOCKS
+constexpr double KERNEL_MIN_MS = 200.0;     // run each kernel at least this long
+constexpr double GATE_MAX_BUDGET = 0.1;     // noise gate may use this much of a block's duration
+constexpr double RESAMPLER_SECONDS = 30.0;  // native-rate audio per resampler configuration
+constexpr int PRE_ROLL_SECONDS = 3;         // pre-roll length for the idle cost
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+QList<int> parseList(const QString& text) {
+    QList<int> values;
+    for (const QString& part : text.split(',', QString::SkipEmptyParts)) {
+        int value = part.trimmed().toInt();
+        if (value > 0) {
+            values << value;
+        }
+    }
+    return values;
+}
+
+// Voiced bursts at syllable rate with pauses, so the engines see something
+// shaped like speech rather than a pure tone or silence
+std::vector<int16_t> syntheticSpeech(size_t samples) {
+    std::vector<int16_t> audio(samples);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 300.0f);
+    
+    const double twoPi = 6.283185307179586;
+    double phase = 0.0;
+    for (size_t i = 0; i < samples; ++i) {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        bool pause = std::fmod(t, 4.0) > 3.2;                        // 0.8 s gap every 4 s
+        double envelope = pause ? 0.0 : std::pow(std::sin(twoPi * 2.0 * t), 2.0);  // 4 syllables/s
+        double pitch = 120.0 + 30.0 * std::sin(twoPi * 0.5 * t);
+        phase += twoPi * pitch / SAMPLE_RATE;
+        
+        double voiced = 0.0;
+        for (int harmonic = 1; harmonic <= 8; ++harmonic) {
+            voiced += std::sin(phase * harmonic) / harmonic;
+        }
+        float value = static_cast<float>(6000.0 * envelope * voiced) + noise(rng);
+        audio[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, value)));
+    }
+    return audio;
+}
+
+bool loadAudio(const QString& path, std::vector<int16_t>& audio, QString& error) {
+    WavReader reader;
+    if (!reader.open(path)) {
+        error = reader.errorString();
+        return false;
+    }
+    
+    std::vector<int16_t> block(65536);
+    size_t n;
+    while ((n = reader.readMono(block.data(), block.size())) > 0) {
+        audio.insert(audio.end(), block.begin(), block.begin() + n);
+    }
+    if (audio.empty()) {
+        error = path + ": no audio data";
+        return false;
+    }
+    if (reader.sampleRate() != SAMPLE_RATE) {
+        audio = Resampler::convert(audio.data(), audio.size(), 1, reader.sampleRate());
+    }
+    return true;
+}
+
+// Repeat (or cut) the source to exactly `samples` samples
+std::vector<int16_t> clipOf(const std::vector<int16_t>& source, size_t samples) {
+    std::vector<int16_t> clip(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        clip[i] = source[i % source.size()];
+    }
+    return clip;
+}
+
+// Runs fn(iteration) until KERNEL_MIN_MS has passed, returns ms per call
+template <typename Fn>
+double timeKernel(Fn fn, int& calls) {
+    fn(0);   // warm caches
+    calls = 0;
+    auto start = Clock::now();
+    double ms;
+    do {
+        fn(calls++);
+        ms = elapsedMs(start);
+    } while (ms < KERNEL_MIN_MS);
+    return ms / calls;
+}
+
+QJsonObject kernelResult(const QString& name, AudioDsp::Isa isa, size_t samples,
+                         double msPerCall, int calls) {
+    QJsonObject result;
+    result["kernel"] = name;
+    result["isa"] = AudioDsp::isaName(isa);
+    result["samples"] = static_cast<qint64>(samples);
+    result["calls"] = calls;
+    result["usPerCall"] = msPerCall * 1000.0;
+    result["nsPerSample"] = msPerCall * 1e6 / samples;
+    result["msamplesPerSec"] = samples / (msPerCall * 1000.0);
+    return result;
+}
+
+const AudioDsp::Isa ALL_ISAS[] = {
+    AudioDsp::Isa::Scalar, AudioDsp::Isa::SSE2, AudioDsp::Isa::AVX2, AudioDsp::Isa::AVX512
+};
+
+QJsonArray benchKernels(const std::vector<int16_t>& source) {
+    QJsonArray results;
+    volatile float sink = 0.0f;
+    const AudioDsp::Isa defaultIsa = AudioDsp::isa();
+    
+    // every instruction set the CPU has, so the speedup over scalar is visible
+    for (AudioDsp::Isa isa : ALL_ISAS) {
+        if (!AudioDsp::setIsa(isa)) {
+            continue;
+        }
+        
+        // the capture block and a 30 s clip: per-block and whole-recording costs
+        for (size_t samples : {CAPTURE_BLOCK, size_t(30 * SAMPLE_RATE)}) {
+            std::vector<int16_t> pcm = clipOf(source, samples);
+            std::vector<int16_t> scaled(samples);
+            std::vector<float> out(samples);
+            int calls;
+            
+            double ms = timeKernel([&](int) {
+                AudioDsp::convertToFloat(pcm.data(), out.data(), samples);
+                sink = out[samples / 2];
+            }, calls);
+            results.append(kernelResult("convertToFloat", isa, samples, ms, calls));
+            
+            ms = timeKernel([&](int) {
+                AudioDsp::Level level = AudioDsp::measureLevel(pcm.data(), samples);
+                sink = level.rms + level.peak;
+            }, calls);
+            results.append(kernelResult("measureLevel", isa, samples, ms, calls));
+            
+            // gain runs in place; copying the input back each call is part
+            // of the cost, but the same for every instruction set
+            ms = timeKernel([&](int) {
+                std::copy(pcm.begin(), pcm.end(), scaled.begin());
+                AudioDsp::applyGain(scaled.data(), samples, 1.5f);
+                sink = scaled[samples / 2];
+            }, calls);
+            results.append(kernelResult("applyGain", isa, samples, ms, calls));
+            
+            // the same samples read as stereo frames, and as resampler taps
+            ms = timeKernel([&](int) {
+                AudioDsp::downmixToFloat(pcm.data(), samples / 2, 2, out.data());
+                sink = out[samples / 4];
+            }, calls);
+            results.append(kernelResult("downmixToFloat", isa, samples, ms, calls));
+            
+            AudioDsp::convertToFloat(pcm.data(), out.data(), samples);
+            const size_t taps = samples / AudioDsp::DOT_ALIGN * AudioDsp::DOT_ALIGN;
+            ms = timeKernel([&](int iteration) {
+                size_t shift = static_cast<size_t>(iteration) % 2;
+                sink = AudioDsp::dotProduct(out.data(), out.data() + shift, taps - AudioDsp::DOT_ALIGN);
+            }, calls);
+            results.append(kernelResult("dotProduct", isa, taps - AudioDsp::DOT_ALIGN, ms, calls));
+        }
+    }
+    
+    AudioDsp::setIsa(defaultIsa);
+    (void)sink;
+    return results;
+}
+
+// Every SIMD path against the scalar one: random and full-scale input,
+// lengths around the vector widths and misaligned starts. Returns the
+// number of mismatches, each printed to stderr.
+int verifyKernels() {
+    std::vector<int16_t> input(CAPTURE_BLOCK * 4 + 37);
+    std::mt19937 rng(7);
+    for (int16_t& sample : input) {
+        sample = static_cast<int16_t>(rng() & 0xFFFF);
+    }
+    for (size_t i = 0; i < input.size(); i += 29) {
+        input[i] = (i / 29) % 2 ? 32767 : -32768;
+    }
+    
+    const AudioDsp::Isa defaultIsa = AudioDsp::isa();
+    const float gains[] = {0.0f, 0.25f, 1.0f, 1.37f, 4.0f, -1.0f, 1e20f};
+    int mismatches = 0;
+    auto report = [&](AudioDsp::Isa isa, const char* kernel, size_t offset, size_t count) {
+        fprintf(stderr, "MISMATCH %s %s offset %zu count %zu\n",
+                AudioDsp::isaName(isa), kernel, offset, count);
+        ++mismatches;
+    };
+    
+    for (size_t offset : {size_t(0), size_t(1), size_t(3)}) {
+        for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(15), size_t(16),
+                             size_t(31), size_t(33), size_t(63), size_t(65), CAPTURE_BLOCK,
+                             CAPTURE_BLOCK * 4 + 33}) {
+            const int16_t* pcm = input.data() + offset;
+            
+            // 1. reference results
+            AudioDsp::setIsa(AudioDsp::Isa::Scalar);
+            std::vector<float> floats(count);
+            AudioDsp::convertToFloat(pcm, floats.data(), count);
+            AudioDsp::Level level = AudioDsp::measureLevel(pcm, count);
+            std::vector<std::vector<int16_t>> scaled;
+            for (float gain : gains) {
+                scaled.emplace_back(pcm, pcm + count);
+                AudioDsp::applyGain(scaled.back().data(), count, gain);
+            }
+            std::vector<std::vector<float>> mixed;
+            for (int channels = 1; channels <= 3; ++channels) {
+                mixed.emplace_back(count / channels);
+                AudioDsp::downmixToFloat(pcm, count / channels, channels, mixed.back().data());
+            }
+            const size_t dotCount = count / AudioDsp::DOT_ALIGN * AudioDsp::DOT_ALIGN;
+            float dot = AudioDsp::dotProduct(floats.data(), floats.data() + count - dotCount, dotCount);
+            
+            // 2. compare bit for bit
+            for (AudioDsp::Isa isa : ALL_ISAS) {
+                if (isa == AudioDsp::Isa::Scalar || !AudioDsp::setIsa(isa)) {
+                    continue;
+                }
+                std::vector<float> simdFloats(count);
+                AudioDsp::convertToFloat(pcm, simdFloats.data(), count);
+                if (memcmp(simdFloats.data(), floats.data(), count * sizeof(float)) != 0) {
+                    report(isa, "convertToFloat", offset, count);
+                }
+                
+                AudioDsp::Level simdLevel = AudioDsp::measureLevel(pcm, count);
+                if (memcmp(&simdLevel, &level, sizeof(level)) != 0) {
+                    report(isa, "measureLevel", offset, count);
+                }
+                
+                for (size_t g = 0; g < scaled.size(); ++g) {
+                    std::vector<int16_t> simdScaled(pcm, pcm + count);
+                    AudioDsp::applyGain(simdScaled.data(), count, gains[g]);
+                    if (simdScaled != scaled[g]) {
+                        report(isa, "applyGain", offset, count);
+                    }
+                }
+                
+                for (int channels = 1; channels <= 3; ++channels) {
+                    std::vector<float> simdMixed(count / channels);
+                    AudioDsp::downmixToFloat(pcm, count / channels, channels, simdMixed.data());
+                    if (simdMixed != mixed[channels - 1]) {
+                        report(isa, "downmixToFloat", offset, count);
+                    }
+                }
+                
+                float simdDot = AudioDsp::dotProduct(floats.data(), floats.data() + count - dotCount, dotCount);
+                if (memcmp(&simdDot, &dot, sizeof(dot)) != 0) {
+                    report(isa, "dotProduct", offset, count);
+                }
+            }
+        }
+    }
+    
+    AudioDsp::setIsa(defaultIsa);
+    return mismatches;
+}
+
+// The capture thread's per-block work (ring push + level) against a
+// consumer draining into a growing buffer, as AudioRecorder does. The
+// producer must not allocate.
+QJsonObject benchCapture(const std::vector<int16_t>& source, double audioSeconds) {
+    using Ring = AudioRingBuffer<CAPTURE_BLOCK, CAPTURE_RING>;
+    auto ring = std::make_unique<Ring>();
+    
+    const size_t blocks = std::max<size_t>(1, static_cast<size_t>(audioSeconds * SAMPLE_RATE / CAPTURE_BLOCK));
+    std::vector<int16_t> pcm = clipOf(source, CAPTURE_BLOCK * 64);
+    std::atomic<bool> producerDone{false};
+    size_t producerAllocations = 0;
+    size_t ringFull = 0;
+    double producerMs = 0.0;
+    std::vector<int16_t> captured;
+    
+    auto start = Clock::now();
+    std::thread consumer([&]() {
+        for (;;) {
+            bool done = producerDone.load(std::memory_order_acquire);
+            while (const Ring::Block* block = ring->front()) {
+                captured.insert(captured.end(), block->samples, block->samples + block->count);
+                ring->release();
+            }
+            if (done) break;
+            std::this_thread::yield();
+        }
+    });
+    
+    std::thread producer([&]() {
+        size_t allocationsBefore = AllocationCounter::count();
+        volatile float level = 0.0f;
+        auto producerStart = Clock::now();
+        for (size_t i = 0; i < blocks; ++i) {
+            const int16_t* block = pcm.data() + (i % 64) * CAPTURE_BLOCK;
+            // a real device would drop here; the bench waits so every
+            // block is measured
+            while (!ring->push(block, CAPTURE_BLOCK)) {
+                ++ringFull;
+                std::this_thread::yield();
+            }
+            level = AudioDsp::calculateRMS(block, CAPTURE_BLOCK);
+        }
+        producerMs = elapsedMs(producerStart);
+        producerAllocations = AllocationCounter::count() - allocationsBefore;
+        (void)level;
+        producerDone.store(true, std::memory_order_release);
+    });
+    
+    producer.join();
+    consumer.join();
+    double totalMs = elapsedMs(start);
+    
+    QJsonObject result;
+    result["blocks"] = static_cast<qint64>(blocks);
+    result["blockSamples"] = static_cast<qint64>(CAPTURE_BLOCK);
+    result["audioSeconds"] = audioSeconds;
+    result["producerNsPerBlock"] = producerMs * 1e6 / blocks;
+    result["endToEndNsPerBlock"] = totalMs * 1e6 / blocks;
+    result["realtimeMultiple"] = audioSeconds * 1000.0 / totalMs;
+    result["producerAllocations"] = static_cast<qint64>(producerAllocations);
+    result["ringFullWaits"] = static_cast<qint64>(ringFull);
+    result["capturedSamples"] = static_cast<qint64>(captured.size());
+    return result;
+}
+
+// The noise gate as the capture thread runs it: one capture block at a
+// time, in place. Reports the cost against the block's duration and the
+// allocations made while processing (must be none).
+QJsonArray benchNoiseGate(const std::vector<int16_t>& source) {
+    QJsonArray results;
+    const std::vector<int16_t> input = clipOf(source, size_t(30 * SAMPLE_RATE));
+    const size_t blocks = input.size() / CAPTURE_BLOCK;
+    const double blockMs = CAPTURE_BLOCK * 1000.0 / SAMPLE_RATE;
+    
+    for (NoiseGate::Mode mode : {NoiseGate::Mode::Gate, NoiseGate::Mode::Spectral}) {
+        NoiseGate::Config config;
+        config.mode = mode;
+        NoiseGate gate(config);
+        std::vector<int16_t> pcm = input;
+        
+        size_t allocationsBefore = AllocationCounter::count();
+        auto start = Clock::now();
+        for (size_t i = 0; i < blocks; ++i) {
+            gate.process(pcm.data() + i * CAPTURE_BLOCK, CAPTURE_BLOCK);
+        }
+        double ms = elapsedMs(start);
+        size_t allocations = AllocationCounter::count() - allocationsBefore;
+        
+        double msPerBlock = ms / blocks;
+        fprintf(stderr, "Noise gate %s: %.1f us per block, %.2f%% of the block\n",
+                mode == NoiseGate::Mode::Spectral ? "spectral" : "gate",
+                msPerBlock * 1000.0, 100.0 * msPerBlock / blockMs);
+        
+        QJsonObject result;
+        result["mode"] = mode == NoiseGate::Mode::Spectral ? "spectral" : "gate";
+        result["blocks"] = static_cast<qint64>(blocks);
+        result["usPerBlock"] = msPerBlock * 1000.0;
+        result["blockBudget"] = msPerBlock / blockMs;
+        result["allocations"] = static_cast<qint64>(allocations);
+        results.append(result);
+    }
+    return results;
+}
+
+// Capture formats worth converting from: what USB and onboard mics report
+// natively, plus an upsampling case
+struct NativeFormat {
+    int rate;
+    int channels;
+};
+
+const NativeFormat NATIVE_FORMATS[] = {{48000, 2}, {48000, 1}, {44100, 2}, {8000, 1}};
+
+const Resampler::Quality ALL_QUALITIES[] = {
+    Resampler::Quality::Fast, Resampler::Quality::Balanced, Resampler::Quality::Best
+};
+
+// The capture thread's resampling: device-rate blocks of 64 ms in, 16 kHz
+// mono out. Reports the cost per second of audio and the allocations made
+// while processing (must be none).
+QJsonArray benchResampler(const std::vector<int16_t>& source) {
+    QJsonArray results;
+    const std::vector<int16_t> clip = clipOf(source, static_cast<size_t>(RESAMPLER_SECONDS * SAMPLE_RATE));
+    
+    for (const NativeFormat& format : NATIVE_FORMATS) {
+        // the source brought to the device format, channels duplicated
+        std::vector<int16_t> mono = Resampler::convert(clip.data(), clip.size(), 1, SAMPLE_RATE, format.rate);
+        std::vector<int16_t> native(mono.size() * format.channels);
+        for (size_t i = 0; i < native.size(); ++i) {
+            native[i] = mono[i / format.channels];
+        }
+        const size_t frames = mono.size();
+        const size_t blockFrames = CAPTURE_BLOCK * format.rate / SAMPLE_RATE;
+        
+        for (Resampler::Quality quality : ALL_QUALITIES) {
+            Resampler resampler(format.rate, format.channels, SAMPLE_RATE, quality);
+            std::vector<int16_t> out(resampler.maxOutput(blockFrames));
+            
+            size_t allocationsBefore = AllocationCounter::count();
+            auto start = Clock::now();
+            for (size_t frame = 0; frame < frames; frame += blockFrames) {
+                size_t n = std::min(blockFrames, frames - frame);
+                resampler.process(native.data() + frame * format.channels, n, out.data());
+            }
+            double ms = elapsedMs(start);
+            size_t allocations = AllocationCounter::count() - allocationsBefore;
+            
+            double msPerSecond = ms / RESAMPLER_SECONDS;
+            fprintf(stderr, "Resampler %d Hz x%d -> 16 kHz, %s: %.3f ms per second of audio (%.0fx real time)\n",
+                    format.rate, format.channels, Resampler::qualityName(quality),
+                    msPerSecond, 1000.0 / msPerSecond);
+            
+            QJsonObject result;
+            result["inputRate"] = format.rate;
+            result["channels"] = format.channels;
+            result["quality"] = Resampler::qualityName(quality);
+            result["taps"] = static_cast<qint64>(resampler.taps());
+            result["msPerSecond"] = msPerSecond;
+            result["realTimeFactor"] = msPerSecond / 1000.0;
+            result["allocations"] = static_cast<qint64>(allocations);
+            results.append(result);
+        }
+    }
+    return results;
+}
+
+// What keeping the microphone armed costs between takes: per block, the
+// read's conversion to 16 kHz mono (nothing at 16 kHz mono) and the copy
+// into the pre-roll; the gate, VAD and meter only run during a take.
+// Reported as a share of one core; must not allocate.
+QJsonArray benchPreRoll(const std::vector<int16_t>& source) {
+    QJsonArray results;
+    const std::vector<int16_t> clip = clipOf(source, static_cast<size_t>(RESAMPLER_SECONDS * SAMPLE_RATE));
+    const NativeFormat formats[] = {{SAMPLE_RATE, 1}, {48000, 2}, {44100, 2}};
+    
+    for (const NativeFormat& format : formats) {
+        std::vector<int16_t> mono = Resampler::convert(clip.data(), clip.size(), 1, SAMPLE_RATE, format.rate);
+        std::vector<int16_t> native(mono.size() * format.channels);
+        for (size_t i = 0; i < native.size(); ++i) {
+            native[i] = mono[i / format.channels];
+        }
+        const size_t frames = mono.size();
+        const size_t blockFrames = CAPTURE_BLOCK * format.rate / SAMPLE_RATE;
+        
+        Resampler resampler(format.rate, format.channels, SAMPLE_RATE, Resampler::Quality::Balanced);
+        PreRollBuffer preRoll(CAPTURE_BLOCK, PRE_ROLL_SECONDS * SAMPLE_RATE / CAPTURE_BLOCK);
+        std::vector<int16_t> out(CAPTURE_BLOCK + resampler.maxOutput(blockFrames));
+        size_t fill = 0;
+        size_t blocks = 0;
+        
+        // same re-blocking as AudioRecorder::recordingLoop()
+        size_t allocationsBefore = AllocationCounter::count();
+        auto start = Clock::now();
+        for (size_t frame = 0; frame < frames; frame += blockFrames) {
+            size_t n = std::min(blockFrames, frames - frame);
+            if (format.rate == SAMPLE_RATE && format.channels == 1) {
+                if (n == CAPTURE_BLOCK) {
+                    preRoll.push(native.data() + frame);
+                    blocks++;
+                }
+                continue;
+            }
+            fill += resampler.process(native.data() + frame * format.channels, n, out.data() + fill);
+            size_t offset = 0;
+            for (; offset + CAPTURE_BLOCK <= fill; offset += CAPTURE_BLOCK) {
+                preRoll.push(out.data() + offset);
+                blocks++;
+            }
+            std::copy(out.begin() + offset, out.begin() + fill, out.begin());
+            fill -= offset;
+        }
+        double ms = elapsedMs(start);
+        size_t allocations = AllocationCounter::count() - allocationsBefore;
+        
+        double usPerBlock = blocks ? ms * 1000.0 / blocks : 0.0;
+        double coreShare = ms / (RESAMPLER_SECONDS * 1000.0);
+        fprintf(stderr, "Pre-roll idle at %d Hz x%d: %.2f us per block, %.3f%% of a core\n",
+                format.rate, format.channels, usPerBlock, 100.0 * coreShare);
+        
+        QJsonObject result;
+        result["inputRate"] = format.rate;
+        result["channels"] = format.channels;
+        result["seconds"] = PRE_ROLL_SECONDS;
+        result["usPerBlock"] = usPerBlock;
+        result["coreShare"] = coreShare;
+        result["allocations"] = static_cast<qint64>(allocations);
+        results.append(result);
+    }
+    return results;
+}
+
+// Gain of a full-scale tone through the resampler, in dB. Measured away
+// from the edges so the filter's start-up doesn't count.
+double toneGainDb(int rate, Resampler::Quality quality, double hz) {
+    const double amplitude = 30000.0;
+    const double twoPi = 6.283185307179586;
+    std::vector<int16_t> tone(static_cast<size_t>(rate));
+    for (size_t i = 0; i < tone.size(); ++i) {
+        tone[i] = static_cast<int16_t>(std::lround(amplitude * std::sin(twoPi * hz * i / rate)));
+    }
+    
+    std::vector<int16_t> out = Resampler::convert(tone.data(), tone.size(), 1, rate, SAMPLE_RATE, quality);
+    const size_t margin = SAMPLE_RATE / 10;
+    double sum = 0.0;
+    for (size_t i = margin; i + margin < out.size(); ++i) {
+        sum += static_cast<double>(out[i]) * out[i];
+    }
+    double rms = std::sqrt(sum / (out.size() - 2 * margin));
+    return 20.0 * std::log10(std::max(rms, 1e-3) / (amplitude / std::sqrt(2.0)));
+}
+
+// Frequency response per quality level: flat up to the passband edge, and
+// anything that would alias (above 8 kHz) pushed under the stopband
+// target. Returns the number of failures, each printed to stderr.
+int verifyResampler() {
+    struct Target {
+        Resampler::Quality quality;
+        double passbandHz;
+        double stopbandDb;
+    };
+    const Target targets[] = {
+        {Resampler::Quality::Fast, 4000.0, -50.0},
+        {Resampler::Quality::Balanced, 6000.0, -70.0},
+        {Resampler::Quality::Best, 6500.0, -85.0},
+    };
+    const double passbandTolerance = 0.5;
+    const double stopbandHz = 8500.0;
+    
+    int failures = 0;
+    for (const Target& target : targets) {
+        for (int rate : {48000, 44100, 22050}) {
+            double passWorst = 0.0;
+            double stopWorst = -200.0;
+            for (double hz = 250.0; hz < rate / 2.0; hz += 250.0) {
+                if (hz <= target.passbandHz) {
+                    double gain = toneGainDb(rate, target.quality, hz);
+                    passWorst = std::fabs(gain) > std::fabs(passWorst) ? gain : passWorst;
+                } else if (hz >= stopbandHz) {
+                    stopWorst = std::max(stopWorst, toneGainDb(rate, target.quality, hz));
+                }
+            }
+            
+            bool ok = std::fabs(passWorst) <= passbandTolerance && stopWorst <= target.stopbandDb;
+            fprintf(stderr, "%s resampler %-8s %5d Hz: passband %+.2f dB to %.0f Hz, stopband %.1f dB%s\n",
+                    ok ? "ok      " : "FAILED  ", Resampler::qualityName(target.quality), rate,
+                    passWorst, target.passbandHz, stopWorst, ok ? "" : " (out of spec)");
+            failures += ok ? 0 : 1;
+        }
+    }
+    return failures;
+}
+
+// The energy VAD on the synthetic speech: talking from the very first
+// sample must be caught, and a steady noisy room let go of once the floor
+// has settled. Returns the number of failures, each printed to stderr.
+int verifyVad() {
+    std::mt19937 rng(11);
+    std::normal_distribution<float> hiss(0.0f, 300.0f);
+    std::vector<int16_t> room(4 * SAMPLE_RATE);
+    for (int16_t& sample : room) {
+        sample = static_cast<int16_t>(hiss(rng));
+    }
+    
+    // start on the peak of the first syllable
+    std::vector<int16_t> speech = syntheticSpeech(3 * SAMPLE_RATE);
+    speech.erase(speech.begin(), speech.begin() + SAMPLE_RATE / 8);
+    
+    std::vector<int16_t> roomThenSpeech(room.begin(), room.begin() + 2 * SAMPLE_RATE);
+    roomThenSpeech.insert(roomThenSpeech.end(), speech.begin(), speech.end());
+    
+    auto detect = [](const std::vector<int16_t>& audio) {
+        EnergyVad vad;
+        std::vector<bool> flags;
+        for (size_t offset = 0; offset + CAPTURE_BLOCK <= audio.size(); offset += CAPTURE_BLOCK) {
+            flags.push_back(vad.isSpeech(audio.data() + offset, CAPTURE_BLOCK));
+        }
+        return flags;
+    };
+    auto anySpeech = [](const std::vector<bool>& flags, double fromSeconds, double toSeconds) {
+        size_t from = static_cast<size_t>(fromSeconds * SAMPLE_RATE / CAPTURE_BLOCK);
+        size_t to = static_cast<size_t>(toSeconds * SAMPLE_RATE / CAPTURE_BLOCK);
+        to = std::min(to, flags.size());
+        return from < to && std::find(flags.begin() + from, flags.begin() + to, true) != flags.begin() + to;
+    };
+    
+    const std::vector<bool> fromStart = detect(speech);
+    const std::vector<bool> roomOnly = detect(room);
+    const std::vector<bool> afterRoom = detect(roomThenSpeech);
+    struct Check {
+        const char* name;
+        bool ok;
+    };
+    const Check checks[] = {
+        {"speech from sample 0", !fromStart.empty() && fromStart[0]},
+        {"speech from sample 0, a second on", anySpeech(fromStart, 1.0, 1.25)},
+        {"noisy room after settling", !anySpeech(roomOnly, 1.0, 4.0)},
+        {"speech after a noisy room", anySpeech(afterRoom, 2.0, 2.25)},
+    };
+    
+    int failures = 0;
+    for (const Check& check : checks) {
+        fprintf(stderr, "%s vad %s\n", check.ok ? "ok      " : "FAILED  ", check.name);
+        failures += check.ok ? 0 : 1;
+    }
+    return failures;
+}
+
+struct EngineOptions {
+    QList<int> threads;
+    QList<int> lengths;
+    int repeat;
+    bool compareAdaptiveCtx;
+};
+
+QJsonArray benchEngine(const QString& modelPath, const std::vector<int16_t>& source,
+                       const EngineOptions& options) {
+    QJsonArray results;
+    
+    // 1a. load, timing it as its own result
+    std::shared_ptr<TranscriptionEngine> engine;
+    auto loadStart = Clock::now();
+    try {
+        if (QFileInfo(modelPath).isDir()) {
+            engine = std::make_shared<VoskEngine>(modelPath.toStdString());
+        } else {
+            engine = std::make_shared<WhisperTranscriber>(modelPath);
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s: %s\n", qPrintable(modelPath), e.what());
+        return results;
+    }
+    if (!engine->isModelLoaded()) {
+        fprintf(stderr, "%s: failed to load\n", qPrintable(modelPath));
+        return results;
+    }
+    double loadMs = elapsedMs(loadStart);
+    
+    auto whisper = std::dynamic_pointer_cast<WhisperTranscriber>(engine);
+    const QString modelName = QFileInfo(modelPath).fileName();
+    
+    // 1b. Vosk decodes on one thread whatever the workspace says
+    QList<int> threadCounts = whisper ? options.threads : QList<int>{1};
+    QList<bool> ctxModes = {false};
+    if (whisper && options.compareAdaptiveCtx) {
+        ctxModes << true;
+    }
+    
+    // 1c. warm up once so the first measurement doesn't pay for page faults
+    {
+        auto workspace = engine->createWorkspace();
+        engine->transcribeWith(*AudioBuffer::create(clipOf(source, SAMPLE_RATE)), *workspace);
+    }
+    
+    for (int seconds : options.lengths) {
+        // int16 only, like a file from disk: the engine's own conversion is timed
+        AudioBuffer::Ptr clip = AudioBuffer::create(clipOf(source, static_cast<size_t>(seconds) * SAMPLE_RATE));
+        for (int threads : threadCounts) {
+            for (bool adaptive : ctxModes) {
+                if (whisper) {
+                    whisper->setAdaptiveAudioContext(adaptive);
+                }
+                auto workspace = engine->createWorkspace();
+                workspace->threads = threads;
+                
+                // 2a. repeat and keep the median, one slow run shouldn't skew it
+                std::vector<double> runs;
+                size_t segments = 0;
+                for (int r = 0; r < options.repeat; ++r) {
+                    auto start = Clock::now();
+                    segments = engine->transcribeWith(*clip, *workspace).size();
+                    runs.push_back(elapsedMs(start));
+                }
+                double ms = median(runs);
+                double rtf = ms / (seconds * 1000.0);
+                
+                fprintf(stderr, "%s %s %ds x%d threads%s: %.0f ms, RTF %.3f\n",
+                        qPrintable(engine->name()), qPrintable(modelName), seconds, threads,
+                        adaptive ? " adaptive ctx" : "", ms, rtf);
+                
+                QJsonObject result;
+                result["engine"] = engine->name();
+                result["model"] = modelName;
+                result["loadMs"] = loadMs;
+                result["clipSeconds"] = seconds;
+                result["threads"] = threads;
+                if (whisper) {
+                    result["adaptiveAudioCtx"] = adaptive;
+                    result["audioCtx"] = adaptive ? whisper->audioContextFor(clip->size()) : 0;
+                }
+                result["runs"] = options.repeat;
+                result["medianMs"] = ms;
+                result["minMs"] = *std::min_element(runs.begin(), runs.end());
+                result["rtf"] = rtf;
+                result["segments"] = static_cast<qint64>(segments);
+                results.append(result);
+            }
+        }
+    }
+    
+    return results;
+}
+
+QList<int> defaultThreadCounts() {
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    QList<int> counts;
+    for (int threads = 1; threads < cores; threads *= 2) {
+        counts << threads;
+    }
+    counts << cores;
+    return counts;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("speech-bench");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark transcription engines and audio kernels.");
+    parser.addHelpOption();
+    
+    QCommandLineOption modelOption({"m", "model"},
+        "Whisper ggml file or Vosk model directory. Repeat for several models.", "path");
+    QCommandLineOption audioOption({"a", "audio"},
+        "WAV to use instead of synthetic audio (resampled to 16 kHz).", "file");
+    QCommandLineOption threadsOption({"t", "threads"},
+        "Comma-separated thread counts (default: powers of two up to the core count).", "list");
+    QCommandLineOption lengthsOption({"l", "lengths"},
+        "Comma-separated clip lengths in seconds.", "list", "5,30,120");
+    QCommandLineOption repeatOption({"r", "repeat"}, "Runs per configuration.", "n", "3");
+    QCommandLineOption adaptiveOption("adaptive-ctx",
+        "Also run Whisper with the encoder context shrunk to the clip length.");
+    QCommandLineOption captureOption("capture-seconds",
+        "Audio pushed through the capture path benchmark.", "seconds", "3600");
+    QCommandLineOption outputOption({"o", "output"}, "Write JSON here instead of stdout.", "file");
+    QCommandLineOption verifyOption("verify",
+        "Only check that every SIMD kernel matches the scalar one bit for bit, "
+        "the resampler's frequency response and the voice activity detector.");
+    parser.addOptions({modelOption, audioOption, threadsOption, lengthsOption, repeatOption,
+                       adaptiveOption, captureOption, outputOption, verifyOption});
+    parser.process(app);
+    
+    if (parser.isSet(verifyOption)) {
+        int mismatches = verifyKernels();
+        for (AudioDsp::Isa isa : ALL_ISAS) {
+            fprintf(stderr, "%-7s %s\n", AudioDsp::isaName(isa),
+                    AudioDsp::isaSupported(isa) ? "checked" : "not supported by this CPU");
+        }
+        fprintf(stderr, "%d mismatches\n", mismatches);
+        int failures = verifyResampler() + verifyVad();
+        return mismatches == 0 && failures == 0 ? 0 : 1;
+    }
+    
+    // 1. source audio
+    std::vector<int16_t> source;
+    QString audioName = "synthetic";
+    if (parser.isSet(audioOption)) {
+        QString error;
+        if (!loadAudio(parser.value(audioOption), source, error)) {
+            fprintf(stderr, "%s\n", qPrintable(error));
+            return 2;
+        }
+        audioName = QFileInfo(parser.value(audioOption)).fileName();
+    } else {
+        source = syntheticSpeech(30 * SAMPLE_RATE);
+    }
+    
+    EngineOptions engineOptions;
+    engineOptions.threads = parser.isSet(threadsOption) ? parseList(parser.value(threadsOption))
+                                                        : defaultThreadCounts();
+    engineOptions.lengths = parseList(parser.value(lengthsOption));
+    engineOptions.repeat = std::max(1, parser.value(repeatOption).toInt());
+    engineOptions.compareAdaptiveCtx = parser.isSet(adaptiveOption);
+    if (engineOptions.threads.isEmpty() || engineOptions.lengths.isEmpty()) {
+        fprintf(stderr, "Thread counts and clip lengths must be positive integers\n");
+        return 2;
+    }
+    
+    QJsonObject report;
+    QJsonObject host;
+    host["cores"] = static_cast<int>(std::thread::hardware_concurrency());
+    host["system"] = SystemInfo::getDescription();
+    host["dspIsa"] = AudioDsp::isaName(AudioDsp::isa());
+    report["host"] = host;
+    report["audio"] = audioName;
+    
+    // 2. kernels and capture path, always
+    fprintf(stderr, "Benchmarking kernels...\n");
+    report["kernels"] = benchKernels(source);
+    
+    fprintf(stderr, "Benchmarking capture path...\n");
+    QJsonObject capture = benchCapture(source, parser.value(captureOption).toDouble());
+    report["capture"] = capture;
+    
+    fprintf(stderr, "Benchmarking noise gate...\n");
+    QJsonArray noiseGate = benchNoiseGate(source);
+    report["noiseGate"] = noiseGate;
+    
+    fprintf(stderr, "Benchmarking resampler...\n");
+    QJsonArray resampler = benchResampler(source);
+    report["resampler"] = resampler;
+    
+    fprintf(stderr, "Benchmarking pre-roll...\n");
+    QJsonArray preRoll = benchPreRoll(source);
+    report["preRoll"] = preRoll;
+    
+    // 3. engines, one entry per model x length x threads
+    QJsonArray engines;
+    for (const QString& model : parser.values(modelOption)) {
+        for (const QJsonValue& result : benchEngine(model, source, engineOptions)) {
+            engines.append(result);
+        }
+    }
+    report["engines"] = engines;
+    
+    QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "%s: %s\n", qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return 1;
+        }
+        file.write(json);
+    } else {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+    
+    // a capture producer that allocates is a regression, fail the run
+    if (capture["producerAllocations"].toInt() != 0) {
+        fprintf(stderr, "Capture path allocated %d times\n", capture["producerAllocations"].toInt());
+        return 1;
+    }
+    
+    // same for the gate, which also has to stay well inside the block time
+    for (const QJsonValue& value : noiseGate) {
+        QJsonObject gate = value.toObject();
+        if (gate["allocations"].toInt() != 0 || gate["blockBudget"].toDouble() > GATE_MAX_BUDGET) {
+            fprintf(stderr, "Noise gate (%s) allocated %d times, used %.1f%% of the block\n",
+                    qPrintable(gate["mode"].toString()), gate["allocations"].toInt(),
+                    100.0 * gate["blockBudget"].toDouble());
+            return 1;
+        }
+    }
+    for (const QJsonValue& value : resampler) {
+        QJsonObject result = value.toObject();
+        if (result["allocations"].toInt() != 0) {
+            fprintf(stderr, "Resampler (%d Hz, %s) allocated %d times\n", result["inputRate"].toInt(),
+                    qPrintable(result["quality"].toString()), result["allocations"].toInt());
+            return 1;
+        }
+    }
+    for (const QJsonValue& value : preRoll) {
+        QJsonObject result = value.toObject();
+        if (result["allocations"].toInt() != 0) {
+            fprintf(stderr, "Pre-roll (%d Hz) allocated %d times\n", result["inputRate"].toInt(),
+                    result["allocations"].toInt());
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,396 @@
+#include "BatchTranscriber.h"
+#include "WhisperTranscriber.h"
+#include "audio/Resampler.h"
+#include "audio/SpeechSegmenter.h"
+#include "audio/VoiceActivityDetector.h"
+#include "audio/WavReader.h"
+#include "transcription/VoskEngine.h"
+#include "utils/Settings.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+BatchTranscriber::BatchTranscriber(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_nextFile(0)
+    , m_done(0)
+    , m_failed(0)
+    , m_audioSamples(0) {
+}
+
+BatchTranscriber::~BatchTranscriber() {
+    // workers hold workspaces of m_engine, stop them first
+    m_scheduler.reset();
+}
+
+bool BatchTranscriber::start(QString& error) {
+    m_wallClock.start();
+    
+    if (!collectFiles(error)) {
+        return false;
+    }
+    if (m_files.isEmpty()) {
+        error = "No WAV files found";
+        return false;
+    }
+    
+    // 1a. load the model, a directory is a Vosk model
+    try {
+        if (QFileInfo(m_options.modelPath).isDir()) {
+            auto vosk = std::make_shared<VoskEngine>(m_options.modelPath.toStdString());
+            if (!vosk->isModelLoaded()) {
+                error = "Failed to load Vosk model: " + m_options.modelPath;
+                return false;
+            }
+            m_engine = vosk;
+        } else {
+            m_engine = std::make_shared<WhisperTranscriber>(m_options.modelPath);
+        }
+    } catch (const std::exception& e) {
+        error = QString::fromStdString(e.what());
+        return false;
+    }
+    
+    // 1b. split the cores between files in flight and threads per file.
+    //     Few files get more threads each instead of leaving cores idle.
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int threads = m_options.threadsPerJob;
+    int jobs = m_options.jobs;
+    if (jobs <= 0) {
+        jobs = std::max(1, cores / (threads > 0 ? threads : DEFAULT_THREADS_PER_JOB));
+    }
+    jobs = std::min(jobs, m_files.size());
+    if (threads <= 0) {
+        threads = std::max(1, cores / jobs);
+    }
+    
+    fprintf(stderr, "%d files, %d at a time x %d threads, %s\n",
+            m_files.size(), jobs, threads, qPrintable(m_engine->name()));
+    
+    // 1c. the queue only runs one file ahead per worker, which bounds
+    //     how much decoded audio sits in memory
+    m_scheduler = std::make_unique<TranscriptionScheduler>(jobs, jobs);
+    m_scheduler->setThreadsPerWorker(threads);
+    connect(m_scheduler.get(), &TranscriptionScheduler::jobFinished,
+            this, &BatchTranscriber::onJobFinished);
+    connect(m_scheduler.get(), &TranscriptionScheduler::jobFailed,
+            this, &BatchTranscriber::onJobFailed);
+    
+    submitMore();
+    return true;
+}
+
+bool BatchTranscriber::collectFiles(QString& error) {
+    QSet<QString> seen;                 // absolute input paths
+    QHash<QString, QString> writers;    // absolute result file -> input
+    
+    auto addFile = [&](const QString& path, const QString& relativePath) {
+        // the same file named twice, e.g. on its own and inside a directory
+        if (seen.contains(QFileInfo(path).absoluteFilePath())) {
+            return true;
+        }
+        seen.insert(QFileInfo(path).absoluteFilePath());
+        
+        // two inputs that would write the same result (talk.wav in two
+        // directories given side by side, talk.wav next to talk.WAV) are
+        // refused up front rather than one silently overwriting the other
+        const QString output = QFileInfo(outputPath(path, relativePath)).absoluteFilePath();
+        if (writers.contains(output)) {
+            error = QString("%1 and %2 would both be written to %3")
+                        .arg(writers.value(output), path, output);
+            return false;
+        }
+        writers.insert(output, path);
+        
+        m_files << path;
+        m_outputs.insert(path, output);
+        return true;
+    };
+    
+    for (const QString& input : m_options.inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDirIterator it(input, {"*.wav", "*.WAV"}, QDir::Files,
+                            m_options.recursive ? QDirIterator::Subdirectories
+                                                : QDirIterator::NoIteratorFlags);
+            QStringList found;
+            while (it.hasNext()) {
+                found << it.next();
+            }
+            found.sort();
+            
+            // results mirror the tree below the directory given
+            QDir root(input);
+            for (const QString& path : found) {
+                if (!addFile(path, root.relativeFilePath(path))) {
+                    return false;
+                }
+            }
+        } else if (info.isFile()) {
+            if (!addFile(input, info.fileName())) {
+                return false;
+            }
+        } else {
+            fprintf(stderr, "Skipping %s: not found\n", qPrintable(input));
+        }
+    }
+    return true;
+}
+
+void BatchTranscriber::submitMore() {
+    while (m_nextFile < m_files.size() && !m_scheduler->isFull()) {
+        const QString path = m_files[m_nextFile++];
+        
+        std::vector<int16_t> audio;
+        QString error;
+        if (!decodeFile(path, audio, error)) {
+            fprintf(stderr, "FAILED %s: %s\n", qPrintable(path), qPrintable(error));
+            m_failed++;
+            fileDone();
+            continue;
+        }
+        
+        // same detector as live capture, run over the whole file
+        AudioBuffer::SpeechSpans speech;
+        if (m_options.skipSilence) {
+            std::unique_ptr<VoiceActivityDetector> vad = VoiceActivityDetector::create();
+            speech = SpeechSegmenter::analyse(audio.data(), audio.size(), *vad);
+        }
+        
+        FileJob job{path, static_cast<qint64>(audio.size())};
+        quint64 id = m_scheduler->submit(m_engine, AudioBuffer::create(std::move(audio), {}, std::move(speech)));
+        m_running.insert(id, job);
+    }
+    
+    if (m_running.isEmpty() && m_nextFile >= m_files.size()) {
+        printSummary();
+        emit finished(m_failed > 0 ? 1 : 0);
+    }
+}
+
+bool BatchTranscriber::decodeFile(const QString& path, std::vector<int16_t>& audio,
+                                  QString& error) const {
+    WavReader reader;
+    if (!reader.open(path)) {
+        error = reader.errorString();
+        return false;
+    }
+    
+    // offline, so the best filter; it runs hundreds of times real time
+    Resampler resampler(reader.sampleRate(), 1, SAMPLE_RATE, Resampler::Quality::Best);
+    qint64 frames = reader.frameCount();
+    if (frames > 0) {
+        audio.reserve(resampler.maxOutput(static_cast<size_t>(frames)) + resampler.maxOutput(resampler.taps()));
+    }
+    
+    // 2a. block by block; anything not at 16 kHz is resampled on the way
+    //     through, so the file's own format is never held whole
+    std::vector<int16_t> block(READ_BLOCK_FRAMES);
+    std::vector<int16_t> converted(resampler.maxOutput(READ_BLOCK_FRAMES));
+    size_t total = 0;
+    
+    size_t n;
+    while ((n = reader.readMono(block.data(), block.size())) > 0) {
+        size_t written = resampler.process(block.data(), n, converted.data());
+        audio.insert(audio.end(), converted.begin(), converted.begin() + written);
+        total += n;
+    }
+    
+    // 2b. flush the filter and take its delay back out, so timestamps
+    //     line up with the file
+    if (!resampler.isPassthrough()) {
+        converted.resize(std::max(converted.size(), resampler.maxOutput(resampler.taps())));
+        size_t written = resampler.drain(converted.data());
+        audio.insert(audio.end(), converted.begin(), converted.begin() + written);
+        resampler.align(audio, total);
+    }
+    
+    if (total == 0) {
+        error = "no audio data";
+        return false;
+    }
+    return true;
+}
+
+void BatchTranscriber::onJobFinished(quint64 jobId, const QString& text,
+                                     const TranscriptionScheduler::Segments& segments) {
+    FileJob job = m_running.take(jobId);
+    
+    QString error;
+    if (writeResult(job, text, segments, error)) {
+        m_audioSamples += job.samples;
+        fprintf(stderr, "[%d/%d] %s (%.1f s audio)\n", m_done + 1, m_files.size(),
+                qPrintable(QFileInfo(job.path).fileName()), job.samples / double(SAMPLE_RATE));
+    } else {
+        fprintf(stderr, "FAILED %s: %s\n", qPrintable(job.path), qPrintable(error));
+        m_failed++;
+    }
+    
+    fileDone();
+    submitMore();
+}
+
+void BatchTranscriber::onJobFailed(quint64 jobId, const QString& error) {
+    FileJob job = m_running.take(jobId);
+    fprintf(stderr, "FAILED %s: %s\n", qPrintable(job.path), qPrintable(error));
+    m_failed++;
+    
+    fileDone();
+    submitMore();
+}
+
+void BatchTranscriber::fileDone() {
+    m_done++;
+}
+
+QString BatchTranscriber::outputPath(const QString& input, const QString& relativePath) const {
+    QFileInfo info(input);
+    QString name = info.completeBaseName() + "." + m_options.format;
+    if (m_options.outputDir.isEmpty()) {
+        return info.dir().filePath(name);
+    }
+    
+    // keep the input's subdirectory, so a/talk.wav and b/talk.wav under
+    // one -r directory don't land on the same file
+    QString subdir = QFileInfo(relativePath).path();
+    if (subdir != ".") {
+        name = subdir + "/" + name;
+    }
+    return QDir(m_options.outputDir).filePath(name);
+}
+
+bool BatchTranscriber::writeResult(const FileJob& job, const QString& text,
+                                   const TranscriptionScheduler::Segments& segments,
+                                   QString& error) const {
+    QFile file(m_outputs.value(job.path));
+    if (!QDir().mkpath(QFileInfo(file).path())) {
+        error = "Cannot create " + QFileInfo(file).path();
+        return false;
+    }
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.fileName() + ": " + file.errorString();
+        return false;
+    }
+    
+    if (m_options.format == "json") {
+        TranscriptionEngine::Capabilities caps = m_engine->capabilities();
+        
+        QJsonArray segmentArray;
+        for (const TranscriptionEngine::Segment& segment : segments) {
+            QJsonObject object;
+            object["text"] = QString::fromStdString(segment.text).trimmed();
+            if (caps.timestamps) {
+                object["start"] = segment.startMs / 1000.0;
+                object["end"] = segment.endMs / 1000.0;
+            }
+            if (caps.confidences) {
+                object["confidence"] = segment.confidence;
+            }
+            segmentArray.append(object);
+        }
+        
+        QJsonObject root;
+        root["file"] = QFileInfo(job.path).absoluteFilePath();
+        root["engine"] = m_engine->name();
+        root["duration"] = job.samples / double(SAMPLE_RATE);
+        root["text"] = text;
+        root["segments"] = segmentArray;
+        file.write(QJsonDocument(root).toJson());
+    } else {
+        QTextStream out(&file);
+        out.setCodec("UTF-8");
+        out << text << "\n";
+    }
+    
+    return true;
+}
+
+void BatchTranscriber::printSummary() const {
+    const double wallSeconds = m_wallClock.elapsed() / 1000.0;
+    const double audioSeconds = m_audioSamples / double(SAMPLE_RATE);
+    TranscriptionScheduler::Metrics metrics = m_scheduler->metrics();
+    
+    // audio-hours per wall-hour is the same ratio as seconds per second
+    printf("Files:      %d transcribed, %d failed\n", m_done - m_failed, m_failed);
+    printf("Audio:      %.2f h\n", audioSeconds / 3600.0);
+    printf("Wall time:  %.2f h (%.1f s)\n", wallSeconds / 3600.0, wallSeconds);
+    if (wallSeconds > 0.0 && audioSeconds > 0.0) {
+        printf("Throughput: %.2f audio-hours per wall-hour (RTF %.3f)\n",
+               audioSeconds / wallSeconds, wallSeconds / audioSeconds);
+    }
+    printf("Per file:   %.1f s mean decode, %.1f s mean queue wait\n",
+           metrics.meanRunMs / 1000.0, metrics.meanWaitMs / 1000.0);
+}
+
+int BatchTranscriber::runCommandLine(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Speech Recorder");
+    app.setOrganizationName("SparklyLabz");
+    app.setOrganizationDomain("sparklylabz.com");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Transcribe WAV files without the GUI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "WAV files or directories", "<file|dir>...");
+    
+    QCommandLineOption batchOption("batch", "Accepted for speech-recorder --batch, which runs this tool.");
+    QCommandLineOption modelOption({"m", "model"},
+        "Whisper ggml file or Vosk model directory.", "path",
+        Settings::instance().modelDirectory() + "/ggml-base.bin");
+    QCommandLineOption formatOption({"f", "format"}, "Output format: txt or json.", "format", "txt");
+    QCommandLineOption outputOption({"o", "output-dir"}, "Write results here instead of next to the input, mirroring subdirectories.", "dir");
+    QCommandLineOption jobsOption({"j", "jobs"}, "Files transcribed at the same time (0 = auto).", "n", "0");
+    QCommandLineOption threadsOption({"t", "threads"}, "CPU threads per file (0 = auto).", "n", "0");
+    QCommandLineOption recursiveOption({"r", "recursive"}, "Descend into subdirectories.");
+    QCommandLineOption keepSilenceOption("keep-silence", "Decode silent stretches too (no VAD).");
+    parser.addOptions({batchOption, modelOption, formatOption, outputOption,
+                       jobsOption, threadsOption, recursiveOption, keepSilenceOption});
+    parser.process(app);
+    
+    Options options;
+    options.modelPath = parser.value(modelOption);
+    options.inputs = parser.positionalArguments();
+    options.recursive = parser.isSet(recursiveOption);
+    options.format = parser.value(formatOption).toLower();
+    options.outputDir = parser.value(outputOption);
+    options.jobs = parser.value(jobsOption).toInt();
+    options.threadsPerJob = parser.value(threadsOption).toInt();
+    options.skipSilence = !parser.isSet(keepSilenceOption);
+    
+    if (options.inputs.isEmpty()) {
+        parser.showHelp(2);
+    }
+    if (options.format != "txt" && options.format != "json") {
+        fprintf(stderr, "Unknown format: %s\n", qPrintable(options.format));
+        return 2;
+    }
+    if (!options.outputDir.isEmpty() && !QDir().mkpath(options.outputDir)) {
+        fprintf(stderr, "Cannot create %s\n", qPrintable(options.outputDir));
+        return 2;
+    }
+    
+    BatchTranscriber batch(options);
+    QObject::connect(&batch, &BatchTranscriber::finished, &app, &QCoreApplication::exit,
+                     Qt::QueuedConnection);
+    
+    QString error;
+    if (!batch.start(error)) {
+        fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+    
+    return app.exec();
+}
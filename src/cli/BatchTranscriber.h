@@ -0,0 +1,82 @@
+#ifndef BATCHTRANSCRIBER_H
+#define BATCHTRANSCRIBER_H
+
+#include "transcription/TranscriptionScheduler.h"
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+#include <memory>
+
+class TranscriptionEngine;
+
+// Headless transcription of WAV files and directories. Files are decoded
+// one at a time on the calling thread and fanned out over a
+// TranscriptionScheduler; `jobs` files are decoded concurrently, each with
+// `threadsPerJob` CPU threads. Needs only QtCore.
+class BatchTranscriber : public QObject {
+    Q_OBJECT
+    
+public:
+    struct Options {
+        QString modelPath;          // ggml file = Whisper, directory = Vosk
+        QStringList inputs;         // files and/or directories
+        bool recursive = false;
+        QString format = "txt";     // "txt" or "json"
+        QString outputDir;          // empty = next to each input
+        int jobs = 0;               // files in flight, 0 = auto
+        int threadsPerJob = 0;      // threads per file, 0 = auto
+        bool skipSilence = true;    // decode only what the VAD marks as speech
+    };
+    
+    explicit BatchTranscriber(const Options& options, QObject* parent = nullptr);
+    ~BatchTranscriber() override;
+    
+    // Loads the model and queues the first files. finished() is emitted
+    // once every file is done.
+    bool start(QString& error);
+    
+    // Entry point for speech-transcribe and `speech-recorder --batch`
+    static int runCommandLine(int argc, char* argv[]);
+    
+signals:
+    void finished(int exitCode);
+    
+private slots:
+    void onJobFinished(quint64 jobId, const QString& text,
+                       const TranscriptionScheduler::Segments& segments);
+    void onJobFailed(quint64 jobId, const QString& error);
+    
+private:
+    struct FileJob {
+        QString path;
+        qint64 samples;
+    };
+    
+    bool collectFiles(QString& error);
+    void submitMore();
+    bool decodeFile(const QString& path, std::vector<int16_t>& audio, QString& error) const;
+    bool writeResult(const FileJob& job, const QString& text,
+                     const TranscriptionScheduler::Segments& segments, QString& error) const;
+    QString outputPath(const QString& input, const QString& relativePath) const;
+    void fileDone();
+    void printSummary() const;
+    
+    Options m_options;
+    std::shared_ptr<TranscriptionEngine> m_engine;
+    std::unique_ptr<TranscriptionScheduler> m_scheduler;
+    QStringList m_files;
+    QMap<QString, QString> m_outputs;   // input -> result file
+    int m_nextFile;
+    int m_done;
+    int m_failed;
+    qint64 m_audioSamples;
+    QMap<quint64, FileJob> m_running;
+    QElapsedTimer m_wallClock;
+    
+    static constexpr int SAMPLE_RATE = 16000;
+    static constexpr size_t READ_BLOCK_FRAMES = 65536;
+    static constexpr int DEFAULT_THREADS_PER_JOB = 4;
+};
+
+#endif // BATCHTRANSCRIBER_H
@@ -0,0 +1,5 @@
+#include "BatchTranscriber.h"
+
+int main(int argc, char *argv[]) {
+    return BatchTranscriber::runCommandLine(argc, argv);
+}
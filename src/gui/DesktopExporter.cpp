@@ -0,0 +1,43 @@
+#include "DesktopExporter.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QPrinter>
+#include <QTextDocument>
+#include <QDebug>
+
+bool DesktopExporter::exportToPDF(const QString& text, const QString& filepath) {
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(filepath);
+    printer.setPageSize(QPrinter::A4);
+    
+    // Set margins (works across Qt 5.12-5.15)
+    QMarginsF margins(15, 15, 15, 15);
+    printer.setPageMargins(margins, QPageLayout::Millimeter);
+    
+    QTextDocument document;
+    document.setDefaultFont(QFont("Arial", 12));
+    document.setPlainText(text);
+    
+    // Add a header
+    QString htmlContent = QString(
+        "<html><body>"
+        "<h2 style='text-align: center;'>Speech Transcription</h2>"
+        "<p style='font-size: 10pt; color: #666; text-align: center;'>Generated by Speech Recorder - SparklyLabz</p>"
+        "<hr>"
+        "<p style='font-size: 12pt; line-height: 1.6;'>%1</p>"
+        "</body></html>"
+    ).arg(text.toHtmlEscaped().replace("\n", "<br>"));
+    
+    document.setHtml(htmlContent);
+    document.print(&printer);
+    
+    qDebug() << "Exported to PDF:" << filepath;
+    return true;
+}
+
+void DesktopExporter::copyToClipboard(const QString& text) {
+    QClipboard* clipboard = QApplication::clipboard();
+    clipboard->setText(text);
+    qDebug() << "Copied" << text.length() << "characters to clipboard";
+}
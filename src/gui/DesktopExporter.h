@@ -0,0 +1,13 @@
+#ifndef DESKTOPEXPORTER_H
+#define DESKTOPEXPORTER_H
+
+#include <QString>
+
+// Exports that need QtWidgets/QtPrintSupport, kept out of speechcore
+class DesktopExporter {
+public:
+    static bool exportToPDF(const QString& text, const QString& filepath);
+    static void copyToClipboard(const QString& text);
+};
+
+#endif // DESKTOPEXPORTER_H
@@ -0,0 +1,217 @@
+#include "DownloadSegment.h"
+#include <QDebug>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <algorithm>
+
+DownloadSegment::DownloadSegment(QNetworkAccessManager* network, const QUrl& url, const QString& path,
+                                 qint64 first, qint64 end, QObject* parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_reply(nullptr)
+    , m_stallTimer(new QTimer(this))
+    , m_url(url)
+    , m_file(path)
+    , m_chunk(CHUNK_BYTES)
+    , m_first(first)
+    , m_end(end)
+    , m_received(0)
+    , m_accepted(false)
+    , m_finished(false)
+    , m_attempts(0) {
+    
+    m_stallTimer->setSingleShot(true);
+    m_stallTimer->setInterval(STALL_TIMEOUT_MS);
+    connect(m_stallTimer, &QTimer::timeout, this, &DownloadSegment::onStalled);
+}
+
+DownloadSegment::~DownloadSegment() {
+    dropReply();
+}
+
+void DownloadSegment::start(const QByteArray& validator) {
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        m_error = QString("Cannot write %1: %2").arg(m_file.fileName()).arg(m_file.errorString());
+    }
+    m_validator = validator;
+    m_received = m_file.size();
+    m_attempts = 0;
+    
+    // from the event loop, so a segment that fails or is already complete
+    // reports after its owner has finished setting up
+    QTimer::singleShot(0, this, &DownloadSegment::begin);
+}
+
+void DownloadSegment::begin() {
+    if (!m_error.isEmpty()) {
+        emit failed(m_error);
+    } else if (!m_file.isOpen()) {
+        return;   // cancelled meanwhile
+    } else if (m_end >= 0 && m_first + m_received >= m_end) {
+        m_finished = true;
+        m_file.close();
+        emit finished();
+    } else {
+        request();
+    }
+}
+
+void DownloadSegment::cancel() {
+    m_stallTimer->stop();
+    dropReply();
+    m_file.close();
+}
+
+void DownloadSegment::request() {
+    // a start or retry scheduled before cancel() or a failure
+    if (!m_file.isOpen()) {
+        return;
+    }
+    
+    QNetworkRequest request(m_url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "SpeechRecorder/1.0");
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::NoLessSafeRedirectPolicy);
+    QByteArray range = "bytes=" + QByteArray::number(m_first + m_received) + "-";
+    if (m_end >= 0) {
+        range += QByteArray::number(m_end - 1);
+    }
+    request.setRawHeader("Range", range);
+    if (!m_validator.isEmpty()) {
+        request.setRawHeader("If-Range", m_validator);
+    }
+    
+    m_accepted = false;
+    m_reply = m_network->get(request);
+    m_reply->setReadBufferSize(READ_BUFFER_BYTES);
+    connect(m_reply, &QNetworkReply::readyRead, this, &DownloadSegment::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &DownloadSegment::onReplyFinished);
+    m_stallTimer->start();
+}
+
+bool DownloadSegment::acceptResponse() {
+    // only the exact range will do: a 200 is the whole file (no range
+    // support, or it changed upstream) and is not ours to write
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray range = m_reply->rawHeader("Content-Range");
+    int dash = range.indexOf('-');
+    qint64 first = dash > 6 ? range.mid(6, dash - 6).toLongLong() : -1;
+    if (status != 206 || !range.startsWith("bytes ") || first != m_first + m_received) {
+        qWarning() << "Server did not send the range at" << m_first + m_received
+                   << "(HTTP" << status << range << ")";
+        cancel();
+        emit rangeRejected();
+        return false;
+    }
+    m_accepted = true;
+    
+    // the last segment learns where it ends from the total
+    bool known = false;
+    qint64 total = range.mid(range.indexOf('/') + 1).toLongLong(&known);
+    if (m_end < 0 && known) {
+        m_end = total;
+    }
+    emit progress(m_received, known ? total : -1);
+    return true;
+}
+
+bool DownloadSegment::writeAvailable() {
+    while (m_reply->bytesAvailable() > 0) {
+        qint64 n = m_reply->read(m_chunk.data(), CHUNK_BYTES);
+        if (n <= 0) {
+            break;
+        }
+        // a server that ignores the end of the range sends more than asked
+        if (m_end >= 0) {
+            n = std::min(n, m_end - m_first - m_received);
+        }
+        if (m_file.write(m_chunk.data(), n) != n) {
+            QString error = QString("Cannot write %1: %2").arg(m_file.fileName()).arg(m_file.errorString());
+            cancel();
+            emit failed(error);
+            return false;
+        }
+        m_received += n;
+        m_attempts = 0;
+    }
+    return true;
+}
+
+void DownloadSegment::onReadyRead() {
+    m_stallTimer->start();
+    if (!m_accepted) {
+        int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status >= 300 || !acceptResponse()) {
+            // error bodies are left for onReplyFinished, and a rejected
+            // range has already dropped the reply
+            if (m_reply) {
+                m_reply->readAll();
+            }
+            return;
+        }
+    }
+    if (writeAvailable()) {
+        emit progress(m_received, -1);
+    }
+}
+
+void DownloadSegment::onReplyFinished() {
+    m_stallTimer->stop();
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    if (m_reply->error() != QNetworkReply::NoError) {
+        QString error = m_reply->errorString();
+        dropReply();
+        if (status >= 400 && status < 500) {
+            cancel();
+            emit failed(error);
+        } else {
+            retryOrFail(error);
+        }
+        return;
+    }
+    if (!m_accepted && !acceptResponse()) {
+        return;
+    }
+    if (!writeAvailable()) {
+        return;
+    }
+    dropReply();
+    
+    // a connection that closed cleanly but early is a drop too
+    if (m_end >= 0 && m_first + m_received < m_end) {
+        retryOrFail(QString("Connection closed %1 bytes short").arg(m_end - m_first - m_received));
+        return;
+    }
+    m_finished = true;
+    m_file.close();
+    emit finished();
+}
+
+void DownloadSegment::onStalled() {
+    dropReply();
+    retryOrFail(QString("No data received for %1 s").arg(STALL_TIMEOUT_MS / 1000));
+}
+
+void DownloadSegment::retryOrFail(const QString& error) {
+    if (++m_attempts >= MAX_ATTEMPTS) {
+        cancel();
+        emit failed(error);
+        return;
+    }
+    int delay = RETRY_DELAY_MS << (m_attempts - 1);
+    qWarning() << "Segment at" << m_first << "of" << m_url.toString() << "interrupted:" << error
+               << "- resuming in" << delay << "ms";
+    QTimer::singleShot(delay, this, &DownloadSegment::request);
+}
+
+void DownloadSegment::dropReply() {
+    if (m_reply) {
+        disconnect(m_reply, nullptr, this, nullptr);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef DOWNLOADSEGMENT_H
+#define DOWNLOADSEGMENT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <vector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// One byte range of a model fetched on a connection of its own, for
+// ModelDownload's segmented mode. The range [first, end) is written to a
+// file of its own ("<part>.<first>") from the start, so the .part itself
+// always holds an unbroken prefix of the model; ModelDownload appends the
+// segments once everything has arrived.
+//
+// Like the main connection it resumes from whatever its file already
+// holds, sends the download's If-Range validator, and retries drops and
+// stalls with backoff. A server that answers with anything but the exact
+// range asked for gets rangeRejected(), and ModelDownload goes back to a
+// single connection.
+class DownloadSegment : public QObject {
+    Q_OBJECT
+    
+public:
+    // `end` is exclusive; -1 = to the end of the file
+    DownloadSegment(QNetworkAccessManager* network, const QUrl& url, const QString& path,
+                    qint64 first, qint64 end, QObject* parent = nullptr);
+    ~DownloadSegment();
+    
+    void start(const QByteArray& validator);
+    void cancel();   // keeps the file
+    
+    QString path() const { return m_file.fileName(); }
+    qint64 first() const { return m_first; }
+    qint64 received() const { return m_received; }
+    bool isFinished() const { return m_finished; }
+    
+signals:
+    void progress(qint64 received, qint64 total);   // this segment's bytes; file total, -1 if unknown
+    void finished();
+    void failed(const QString& error);
+    void rangeRejected();
+    
+private slots:
+    void begin();
+    void request();
+    void onReadyRead();
+    void onReplyFinished();
+    void onStalled();
+    
+private:
+    bool acceptResponse();
+    bool writeAvailable();
+    void retryOrFail(const QString& error);
+    void dropReply();
+    
+    QNetworkAccessManager* m_network;
+    QNetworkReply* m_reply;
+    QTimer* m_stallTimer;
+    QUrl m_url;
+    QFile m_file;
+    QByteArray m_validator;
+    QString m_error;             // from start(), reported by begin()
+    std::vector<char> m_chunk;
+    qint64 m_first;
+    qint64 m_end;
+    qint64 m_received;
+    bool m_accepted;
+    bool m_finished;
+    int m_attempts;
+    
+    static constexpr qint64 READ_BUFFER_BYTES = 4 * 1024 * 1024;
+    static constexpr qint64 CHUNK_BYTES = 256 * 1024;
+    static constexpr int STALL_TIMEOUT_MS = 30000;
+    static constexpr int MAX_ATTEMPTS = 5;
+    static constexpr int RETRY_DELAY_MS = 2000;
+};
+
+#endif // DOWNLOADSEGMENT_H
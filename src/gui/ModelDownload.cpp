@@ -0,0 +1,670 @@
+#include "ModelDownload.h"
+#include "DownloadSegment.h"
+#include "ModelVerifier.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QStringList>
+#include <QTimer>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+ModelDownload::ModelDownload(QNetworkAccessManager* network, const QUrl& url, const QString& destination,
+                             QObject* parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_reply(nullptr)
+    , m_pointerReply(nullptr)
+    , m_stallTimer(new QTimer(this))
+    , m_url(mirrored(url))
+    , m_destination(destination)
+    , m_chunk(CHUNK_BYTES)
+    , m_offset(0)
+    , m_total(-1)
+    , m_accepted(false)
+    , m_written(0)
+    , m_end(-1)
+    , m_headDone(false)
+    , m_connections(1)
+    , m_attempts(0)
+    , m_hash(QCryptographicHash::Sha256)
+    , m_stopHashing(false) {
+    
+    m_stallTimer->setSingleShot(true);
+    m_stallTimer->setInterval(STALL_TIMEOUT_MS);
+    connect(m_stallTimer, &QTimer::timeout, this, &ModelDownload::onStalled);
+}
+
+ModelDownload::~ModelDownload() {
+    stopHashing();
+    dropReply();
+}
+
+void ModelDownload::setExpectedSha256(const QByteArray& digest) {
+    m_expected = digest.trimmed().toLower();
+}
+
+void ModelDownload::setConnections(int count) {
+    m_connections = std::max(1, count);
+}
+
+void ModelDownload::start() {
+    // appending: whatever an earlier attempt left is the start of the file
+    m_part.setFileName(partPath(m_destination));
+    if (!m_part.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        fail(QString("Cannot write %1: %2").arg(m_part.fileName()).arg(m_part.errorString()));
+        return;
+    }
+    m_attempts = 0;
+    m_headDone = false;
+    
+    // an earlier segmented attempt: this connection only fills up to the
+    // first segment. Anything past it is from an append that was cut
+    // short, and the segment file still has it
+    QList<qint64> starts = segmentStarts(m_destination);
+    m_end = starts.isEmpty() ? -1 : starts.first();
+    if (m_end >= 0 && m_part.size() > m_end) {
+        m_part.resize(m_end);
+    }
+    m_written = m_part.size();
+    
+    // 0a. no digest from the catalog: the LFS pointer has one, if the
+    //     host publishes it
+    if (m_expected.isEmpty()) {
+        m_pointerReply = requestPointer(m_network, m_url);
+        if (m_pointerReply) {
+            connect(m_pointerReply, &QNetworkReply::finished, this, &ModelDownload::onPointerFinished);
+            return;
+        }
+    }
+    resume();
+}
+
+void ModelDownload::onPointerFinished() {
+    m_expected = pointerDigest(m_pointerReply);
+    if (m_expected.isEmpty()) {
+        qDebug() << "No published checksum for" << m_url.toString() << "- checking the size only";
+    }
+    m_pointerReply->deleteLater();
+    m_pointerReply = nullptr;
+    resume();
+}
+
+void ModelDownload::resume() {
+    // 0b. the hash has to have seen what the .part already holds; that is
+    //     up to gigabytes, so it is read on a thread of its own
+    m_hash.reset();
+    qint64 prefix = m_written;
+    if (prefix == 0) {
+        request();
+        return;
+    }
+    QString path = m_part.fileName();
+    m_prefixThread = std::thread([this, path, prefix]() {
+        bool ok = ModelVerifier::addFile(m_hash, path, prefix, nullptr, &m_stopHashing);
+        QMetaObject::invokeMethod(this, "onPrefixHashed", Qt::QueuedConnection, Q_ARG(bool, ok));
+    });
+}
+
+void ModelDownload::onPrefixHashed(bool ok) {
+    if (m_prefixThread.joinable()) {
+        m_prefixThread.join();
+    }
+    if (!ok && m_part.isOpen()) {
+        qWarning() << "Cannot read back" << m_part.fileName() << "- starting over";
+        restartPart();
+    }
+    request();
+}
+
+void ModelDownload::stopHashing() {
+    m_stopHashing = true;
+    if (m_prefixThread.joinable()) {
+        m_prefixThread.join();
+    }
+    m_stopHashing = false;
+}
+
+void ModelDownload::cancel() {
+    m_stallTimer->stop();
+    stopHashing();
+    dropReply();
+    dropSegments(false);
+    m_part.close();
+}
+
+void ModelDownload::request() {
+    // a retry or continuation that was scheduled before cancel() or a failure
+    if (!m_part.isOpen()) {
+        return;
+    }
+    
+    QNetworkRequest request(m_url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "SpeechRecorder/1.0");
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::NoLessSafeRedirectPolicy);
+    
+    // 1a. segments left by an earlier attempt carry on alongside
+    m_offset = m_written;
+    if (m_end >= 0 && m_segments.isEmpty()) {
+        startSegments();
+    }
+    if (m_end >= 0 && m_offset >= m_end) {
+        finishHead();
+        return;
+    }
+    
+    // 1b. resume from the end of the .part, but only if it is still the
+    //     same file upstream; otherwise the server sends all of it
+    if (m_offset > 0 || m_end >= 0) {
+        QByteArray range = "bytes=" + QByteArray::number(m_offset) + "-";
+        if (m_end >= 0) {
+            range += QByteArray::number(m_end - 1);
+        }
+        request.setRawHeader("Range", range);
+        QByteArray validator = storedValidator();
+        if (!validator.isEmpty()) {
+            request.setRawHeader("If-Range", validator);
+        }
+        qDebug() << "Resuming" << m_url.toString() << "at" << m_offset << "bytes";
+    }
+    
+    // 1c. a full read buffer stops Qt reading the socket until we catch
+    //     up, which is what keeps memory flat on a fast link
+    m_accepted = false;
+    m_reply = m_network->get(request);
+    m_reply->setReadBufferSize(READ_BUFFER_BYTES);
+    connect(m_reply, &QNetworkReply::readyRead, this, &ModelDownload::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &ModelDownload::onReplyFinished);
+    m_stallTimer->start();
+}
+
+bool ModelDownload::acceptResponse() {
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    if (status == 206) {
+        // 2a. "bytes <first>-<last>/<total>", and it has to start where we are
+        QByteArray range = m_reply->rawHeader("Content-Range");
+        int dash = range.indexOf('-');
+        int slash = range.indexOf('/');
+        qint64 first = dash > 6 ? range.mid(6, dash - 6).toLongLong() : -1;
+        if (!range.startsWith("bytes ") || first != m_offset) {
+            qWarning() << "Server resumed at the wrong place:" << range;
+            restartPart();   // the retry asks for all of it
+            return false;
+        }
+        bool known = false;
+        m_total = slash > 0 ? range.mid(slash + 1).toLongLong(&known) : -1;
+        if (!known) {
+            m_total = -1;
+        }
+    } else if (status == 200) {
+        // 2b. no resume (first request, changed file or no Range support)
+        if (m_offset > 0) {
+            qDebug() << "Server sent the whole file, starting" << m_destination << "over";
+        }
+        restartPart();
+        m_offset = 0;
+        QVariant length = m_reply->header(QNetworkRequest::ContentLengthHeader);
+        m_total = length.isValid() ? length.toLongLong() : -1;
+        
+        // remember what identifies this version of the file, for If-Range
+        QByteArray validator = m_reply->rawHeader("ETag");
+        if (validator.isEmpty()) {
+            validator = m_reply->rawHeader("Last-Modified");
+        }
+        QFile file(validatorPath(m_destination));
+        if (validator.isEmpty()) {
+            file.remove();
+        } else if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(validator);
+        }
+    } else {
+        return false;
+    }
+    
+    m_accepted = true;
+    
+    // 2c. a large file from a server that takes ranges: the rest is split
+    //     over more connections. Only with a validator, or nothing would
+    //     notice the file changing between one connection and the next
+    bool ranges = status == 206 || m_reply->rawHeader("Accept-Ranges") == "bytes";
+    if (m_connections > 1 && m_segments.isEmpty() && m_end < 0 && ranges
+        && m_total - m_offset >= SEGMENT_MIN_BYTES && !storedValidator().isEmpty()) {
+        splitRemaining();
+    }
+    return true;
+}
+
+void ModelDownload::restartPart() {
+    m_part.resize(0);
+    m_written = 0;
+    m_hash.reset();
+    dropSegments(true);
+    m_end = -1;
+    emit restarted();
+}
+
+bool ModelDownload::writeAvailable() {
+    while (m_reply->bytesAvailable() > 0) {
+        qint64 n = m_reply->read(m_chunk.data(), CHUNK_BYTES);
+        if (n <= 0) {
+            break;
+        }
+        // the first segment starts here; the reply may run on past it
+        if (m_end >= 0) {
+            n = std::min(n, m_end - m_written);
+        }
+        if (m_part.write(m_chunk.data(), n) != n) {
+            fail(QString("Cannot write %1: %2").arg(m_part.fileName()).arg(m_part.errorString()));
+            return false;
+        }
+        m_hash.addData(m_chunk.data(), static_cast<int>(n));
+        m_written += n;
+        m_attempts = 0;
+    }
+    
+    // in the OS before anyone reading the .part is told about it
+    if (!m_part.flush()) {
+        fail(QString("Cannot write %1: %2").arg(m_part.fileName()).arg(m_part.errorString()));
+        return false;
+    }
+    return true;
+}
+
+void ModelDownload::onReadyRead() {
+    m_stallTimer->start();
+    
+    // 3a. error pages and redirects' bodies are not part of the file
+    if (!m_accepted && !acceptResponse()) {
+        m_reply->readAll();
+        return;
+    }
+    
+    // 3b. straight to disk, one bounded chunk at a time
+    if (!writeAvailable()) {
+        return;
+    }
+    emit progress(m_written + segmentBytes(), m_total);
+    
+    // 3c. up to the first segment: this connection is done
+    if (m_end >= 0 && m_written >= m_end) {
+        m_stallTimer->stop();
+        dropReply();
+        finishHead();
+    }
+}
+
+void ModelDownload::onReplyFinished() {
+    m_stallTimer->stop();
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    // 4a. range past the end: the .part is either complete already (we
+    //     stopped between the last byte and the rename) or stale
+    if (status == 416 && m_offset > 0) {
+        QByteArray range = m_reply->rawHeader("Content-Range");
+        qint64 total = range.mid(range.indexOf('/') + 1).toLongLong();
+        dropReply();
+        if (total == m_offset) {
+            finishHead();
+        } else {
+            restartPart();
+            retryOrFail("Server rejected the resume request");
+        }
+        return;
+    }
+    
+    if (m_reply->error() != QNetworkReply::NoError) {
+        // 4b. the server said no: retrying will not change its mind
+        QString error = m_reply->errorString();
+        dropReply();
+        if (status >= 400 && status < 500) {
+            fail(error);
+        } else {
+            retryOrFail(error);
+        }
+        return;
+    }
+    
+    if (!m_accepted && !acceptResponse()) {
+        dropReply();
+        retryOrFail(QString("Unexpected response from server (HTTP %1)").arg(status));
+        return;
+    }
+    if (!writeAvailable()) {
+        return;
+    }
+    dropReply();
+    
+    // 4c. a connection that closed cleanly but early is a drop too
+    qint64 end = m_end >= 0 ? m_end : m_total;
+    if (end >= 0 && m_written != end) {
+        retryOrFail(QString("Connection closed after %1 of %2 bytes").arg(m_written).arg(end));
+        return;
+    }
+    finishHead();
+}
+
+void ModelDownload::onStalled() {
+    dropReply();
+    retryOrFail(QString("No data received for %1 s").arg(STALL_TIMEOUT_MS / 1000));
+}
+
+void ModelDownload::retryOrFail(const QString& error) {
+    if (++m_attempts >= MAX_ATTEMPTS) {
+        fail(error);
+        return;
+    }
+    int delay = RETRY_DELAY_MS << (m_attempts - 1);
+    qWarning() << "Download of" << m_url.toString() << "interrupted:" << error
+               << "- resuming in" << delay << "ms";
+    QTimer::singleShot(delay, this, &ModelDownload::request);
+}
+
+void ModelDownload::fail(const QString& error) {
+    m_stallTimer->stop();
+    dropReply();
+    dropSegments(false);
+    m_part.close();
+    m_error = error;
+    emit failed(error);
+}
+
+void ModelDownload::finishHead() {
+    // 5. with segments, the file is complete once the last of them is
+    m_headDone = true;
+    for (DownloadSegment* segment : m_segments) {
+        if (!segment->isFinished()) {
+            return;
+        }
+    }
+    if (m_segments.isEmpty()) {
+        complete();
+    } else {
+        mergeSegments();
+    }
+}
+
+void ModelDownload::complete() {
+    // 6a. on disk before anything else looks at it
+    if (!m_part.flush() || ::fsync(m_part.handle()) != 0) {
+        fail(QString("Cannot write %1: %2").arg(m_part.fileName()).arg(m_part.errorString()));
+        return;
+    }
+    m_part.close();
+    
+    // 6b. every byte arrived but not the right ones: a corrupted transfer,
+    //     or a resume that spliced two versions; the .part is no use
+    m_digest = m_hash.result().toHex();
+    if (!m_expected.isEmpty() && m_digest != m_expected) {
+        QFile::remove(m_part.fileName());
+        QFile::remove(validatorPath(m_destination));
+        qWarning() << "Expected" << m_expected << "got" << m_digest;
+        fail(QString("Checksum mismatch for %1, the download was corrupted. Please download it again.")
+             .arg(m_destination));
+        return;
+    }
+    
+    // 6c. one atomic rename; anything already at the destination is replaced
+    if (std::rename(QFile::encodeName(m_part.fileName()).constData(),
+                    QFile::encodeName(m_destination).constData()) != 0) {
+        fail(QString("Cannot move %1 into place: %2").arg(m_part.fileName()).arg(strerror(errno)));
+        return;
+    }
+    QFile::remove(validatorPath(m_destination));
+    
+    qDebug() << "Download completed:" << m_destination;
+    emit finished();
+}
+
+void ModelDownload::dropReply() {
+    // disconnected first: abort() emits finished() right away
+    for (QNetworkReply** reply : {&m_reply, &m_pointerReply}) {
+        if (*reply) {
+            disconnect(*reply, nullptr, this, nullptr);
+            (*reply)->abort();
+            (*reply)->deleteLater();
+            *reply = nullptr;
+        }
+    }
+}
+
+void ModelDownload::splitRemaining() {
+    // equal shares of what is left; this connection keeps the first and
+    // stops where the second begins
+    qint64 share = (m_total - m_offset) / m_connections;
+    for (int i = 1; i < m_connections; ++i) {
+        qint64 first = m_offset + share * i;
+        qint64 end = i + 1 < m_connections ? first + share : m_total;
+        addSegment(first, end)->start(storedValidator());
+    }
+    m_end = m_offset + share;
+    qDebug() << "Fetching" << m_url.toString() << "on" << m_connections << "connections";
+}
+
+void ModelDownload::startSegments() {
+    // each ends where the next begins; the last one finds out from the server
+    QList<qint64> starts = segmentStarts(m_destination);
+    for (int i = 0; i < starts.size(); ++i) {
+        addSegment(starts[i], i + 1 < starts.size() ? starts[i + 1] : m_total);
+    }
+    QByteArray validator = storedValidator();
+    for (DownloadSegment* segment : m_segments) {
+        segment->start(validator);
+    }
+}
+
+DownloadSegment* ModelDownload::addSegment(qint64 first, qint64 end) {
+    DownloadSegment* segment = new DownloadSegment(m_network, m_url, segmentPath(m_destination, first),
+                                                   first, end, this);
+    connect(segment, &DownloadSegment::progress, this, &ModelDownload::onSegmentProgress);
+    connect(segment, &DownloadSegment::finished, this, &ModelDownload::onSegmentFinished);
+    connect(segment, &DownloadSegment::failed, this, &ModelDownload::fail);
+    connect(segment, &DownloadSegment::rangeRejected, this, &ModelDownload::onSegmentRangeRejected);
+    m_segments.append(segment);
+    return segment;
+}
+
+void ModelDownload::onSegmentProgress(qint64 received, qint64 total) {
+    Q_UNUSED(received);
+    if (m_total < 0 && total >= 0) {
+        m_total = total;
+    }
+    emit progress(m_written + segmentBytes(), m_total);
+}
+
+void ModelDownload::onSegmentFinished() {
+    if (m_headDone) {
+        finishHead();
+    }
+}
+
+void ModelDownload::onSegmentRangeRejected() {
+    // back to one connection, which has to go on to the end of the file now
+    qWarning() << "Server would not split" << m_url.toString() << "- continuing on one connection";
+    dropSegments(true);
+    m_end = -1;
+    if (m_reply || m_headDone) {
+        m_stallTimer->stop();
+        dropReply();
+        m_headDone = false;
+        request();
+    }
+}
+
+void ModelDownload::dropSegments(bool remove) {
+    // from inside a segment's own signal too, hence deleteLater
+    for (DownloadSegment* segment : m_segments) {
+        disconnect(segment, nullptr, this, nullptr);
+        segment->cancel();
+        segment->deleteLater();
+    }
+    m_segments.clear();
+    if (remove) {
+        for (qint64 first : segmentStarts(m_destination)) {
+            QFile::remove(segmentPath(m_destination, first));
+        }
+    }
+}
+
+void ModelDownload::mergeSegments() {
+    // 5a. appended in order and hashed on the way, on the hashing thread:
+    //     it is a local copy of up to gigabytes. Each segment file goes
+    //     once it is in, so an interrupted append resumes cleanly
+    QStringList paths;
+    for (DownloadSegment* segment : m_segments) {
+        paths.append(segment->path());
+    }
+    dropSegments(false);
+    
+    m_prefixThread = std::thread([this, paths]() {
+        bool ok = true;
+        std::vector<char> buffer(CHUNK_BYTES);
+        for (const QString& path : paths) {
+            QFile segment(path);
+            ok = segment.open(QIODevice::ReadOnly);
+            for (qint64 n = 0; ok && !m_stopHashing && (n = segment.read(buffer.data(), CHUNK_BYTES)) != 0;) {
+                ok = n > 0 && m_part.write(buffer.data(), n) == n;
+                if (ok) {
+                    m_hash.addData(buffer.data(), static_cast<int>(n));
+                }
+            }
+            if (!ok || m_stopHashing || !m_part.flush()) {
+                ok = false;
+                break;
+            }
+            segment.remove();
+        }
+        QMetaObject::invokeMethod(this, "onSegmentsMerged", Qt::QueuedConnection, Q_ARG(bool, ok));
+    });
+}
+
+void ModelDownload::onSegmentsMerged(bool ok) {
+    if (m_prefixThread.joinable()) {
+        m_prefixThread.join();
+    }
+    if (!m_part.isOpen()) {
+        return;   // cancelled
+    }
+    m_written = m_part.size();
+    m_end = -1;
+    if (!ok) {
+        fail(QString("Cannot write %1: %2").arg(m_part.fileName()).arg(m_part.errorString()));
+        return;
+    }
+    complete();
+}
+
+qint64 ModelDownload::segmentBytes() const {
+    qint64 bytes = 0;
+    for (DownloadSegment* segment : m_segments) {
+        bytes += segment->received();
+    }
+    return bytes;
+}
+
+QString ModelDownload::validatorPath(const QString& destination) {
+    return partPath(destination) + ".etag";
+}
+
+QByteArray ModelDownload::storedValidator() const {
+    QFile validator(validatorPath(m_destination));
+    if (!validator.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return validator.readAll().trimmed();
+}
+
+QString ModelDownload::partPath(const QString& destination) {
+    return destination + ".part";
+}
+
+void ModelDownload::discard(const QString& destination) {
+    QFile::remove(partPath(destination));
+    QFile::remove(validatorPath(destination));
+    for (qint64 first : segmentStarts(destination)) {
+        QFile::remove(segmentPath(destination, first));
+    }
+}
+
+QString ModelDownload::segmentPath(const QString& destination, qint64 first) {
+    return partPath(destination) + "." + QString::number(first);
+}
+
+QList<qint64> ModelDownload::segmentStarts(const QString& destination) {
+    // "<model>.part.<first byte>"; the ".etag" beside them is no number
+    QFileInfo part(partPath(destination));
+    QList<qint64> starts;
+    for (const QString& name : part.dir().entryList({part.fileName() + ".*"}, QDir::Files)) {
+        bool number = false;
+        qint64 first = name.mid(part.fileName().length() + 1).toLongLong(&number);
+        if (number) {
+            starts.append(first);
+        }
+    }
+    std::sort(starts.begin(), starts.end());
+    return starts;
+}
+
+qint64 ModelDownload::partSize(const QString& destination) {
+    QFile part(partPath(destination));
+    qint64 size = part.exists() ? part.size() : 0;
+    for (qint64 first : segmentStarts(destination)) {
+        size += QFileInfo(segmentPath(destination, first)).size();
+    }
+    return size;
+}
+
+QNetworkReply* ModelDownload::requestPointer(QNetworkAccessManager* network, const QUrl& url) {
+    QUrl pointer = ModelVerifier::pointerUrl(url);
+    if (pointer.isEmpty()) {
+        return nullptr;
+    }
+    QNetworkRequest request(pointer);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "SpeechRecorder/1.0");
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::NoLessSafeRedirectPolicy);
+    QNetworkReply* reply = network->get(request);
+    
+    // a file too small for LFS comes back whole; that is no pointer
+    connect(reply, &QNetworkReply::readyRead, reply, [reply]() {
+        if (reply->bytesAvailable() > POINTER_MAX_BYTES) {
+            reply->abort();
+        }
+    });
+    return reply;
+}
+
+QByteArray ModelDownload::pointerDigest(QNetworkReply* reply) {
+    if (reply->error() != QNetworkReply::NoError) {
+        return QByteArray();
+    }
+    return ModelVerifier::parsePointer(reply->readAll());
+}
+
+QUrl ModelDownload::mirrored(const QUrl& url) {
+    QByteArray mirror = qgetenv("SPEECH_RECORDER_MODEL_MIRROR");
+    if (mirror.isEmpty()) {
+        return url;
+    }
+    
+    // the mirror's own path, if any, goes in front of the original one
+    QUrl base(QString::fromUtf8(mirror));
+    QString prefix = base.path();
+    while (prefix.endsWith('/')) {
+        prefix.chop(1);
+    }
+    QUrl result = url;
+    result.setScheme(base.scheme());
+    result.setHost(base.host());
+    result.setPort(base.port());
+    result.setPath(prefix + url.path());
+    return result;
+}
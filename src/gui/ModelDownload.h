@@ -0,0 +1,152 @@
+#ifndef MODELDOWNLOAD_H
+#define MODELDOWNLOAD_H
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class DownloadSegment;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// One model file, streamed to "<destination>.part" as it arrives and
+// renamed onto the destination once complete, so a half-written model is
+// never picked up as ready.
+//
+// Memory stays bounded whatever the file size: the reply's read buffer is
+// capped, which makes Qt stop reading from the socket until the data has
+// been written out. A dropped or stalled connection is retried with an
+// HTTP Range request from the end of the .part file, and so is a download
+// started again after a restart. The server's ETag (or Last-Modified) is
+// kept next to the .part and sent as If-Range, so a file that changed
+// upstream is fetched from the start instead of spliced.
+//
+// Every byte is fed to SHA-256 as it is written, so checking the finished
+// file costs no second pass over it. A resumed download first hashes what
+// the .part already holds, off the GUI thread. The expected digest is the
+// one given with setExpectedSha256() or, failing that, the one in the file's
+// Git LFS pointer (see ModelVerifier). A mismatch deletes the .part; the
+// file is never moved into place.
+//
+// With setConnections() above one, a large file from a server that takes
+// ranges is split: this connection fetches the first part into the .part
+// and DownloadSegments fetch the others into files of their own, which are
+// appended (and hashed) once all are in. Segments resume on their own too.
+//
+// SPEECH_RECORDER_MODEL_MIRROR replaces the scheme, host and port of every
+// model URL, e.g. "http://localhost:8000" to test against a local server.
+class ModelDownload : public QObject {
+    Q_OBJECT
+    
+public:
+    ModelDownload(QNetworkAccessManager* network, const QUrl& url, const QString& destination,
+                  QObject* parent = nullptr);
+    ~ModelDownload();
+    
+    // Hex; empty = look for the LFS pointer. Call before start().
+    void setExpectedSha256(const QByteArray& digest);
+    void setConnections(int count);   // 1 = no segments; call before start()
+    void start();
+    
+    // Stops without emitting anything; the .part stays for a later resume
+    void cancel();
+    
+    QUrl url() const { return m_url; }
+    QString destination() const { return m_destination; }
+    QString errorString() const { return m_error; }
+    QByteArray expectedSha256() const { return m_expected; }   // empty if none was found
+    QByteArray sha256() const { return m_digest; }             // once finished
+    qint64 written() const { return m_written; }   // unbroken bytes at the start of the .part
+    
+    static QString partPath(const QString& destination);
+    static qint64 partSize(const QString& destination);   // 0 if none; segments included
+    static void discard(const QString& destination);      // deletes .part, segments and ETag; not while running
+    static QUrl mirrored(const QUrl& url);
+    
+    // GET of the LFS pointer for a model URL, nullptr if it has none; the
+    // caller owns the reply and reads it with pointerDigest() when finished
+    static QNetworkReply* requestPointer(QNetworkAccessManager* network, const QUrl& url);
+    static QByteArray pointerDigest(QNetworkReply* reply);
+    
+signals:
+    void progress(qint64 received, qint64 total);   // total is -1 until known
+    void finished();
+    void failed(const QString& error);
+    void restarted();   // the .part was emptied and is being fetched again
+    
+private slots:
+    void onPointerFinished();
+    void onPrefixHashed(bool ok);
+    void onReadyRead();
+    void onReplyFinished();
+    void onStalled();
+    void onSegmentProgress(qint64 received, qint64 total);
+    void onSegmentFinished();
+    void onSegmentRangeRejected();
+    void onSegmentsMerged(bool ok);
+    
+private:
+    void resume();
+    void stopHashing();
+    void request();
+    bool acceptResponse();
+    void restartPart();
+    bool writeAvailable();
+    void retryOrFail(const QString& error);
+    void fail(const QString& error);
+    void finishHead();
+    void complete();
+    void dropReply();
+    void splitRemaining();
+    void startSegments();
+    DownloadSegment* addSegment(qint64 first, qint64 end);
+    void dropSegments(bool remove);
+    void mergeSegments();
+    qint64 segmentBytes() const;
+    QByteArray storedValidator() const;
+    
+    static QString validatorPath(const QString& destination);
+    static QString segmentPath(const QString& destination, qint64 first);
+    static QList<qint64> segmentStarts(const QString& destination);   // ascending
+    
+    QNetworkAccessManager* m_network;
+    QNetworkReply* m_reply;
+    QNetworkReply* m_pointerReply;
+    QTimer* m_stallTimer;
+    QUrl m_url;
+    QString m_destination;
+    QFile m_part;
+    std::vector<char> m_chunk;   // one read's worth, reused
+    qint64 m_offset;             // bytes already in the .part when the request went out
+    qint64 m_total;              // -1 until the server says
+    bool m_accepted;             // response headers checked for this request
+    qint64 m_written;            // bytes in the .part
+    qint64 m_end;                // where this connection stops, -1 = end of file
+    bool m_headDone;             // the .part reached m_end
+    int m_connections;
+    QList<DownloadSegment*> m_segments;
+    int m_attempts;              // consecutive failures without progress
+    QString m_error;
+    QByteArray m_expected;
+    QByteArray m_digest;
+    QCryptographicHash m_hash;   // of everything in the .part so far
+    std::thread m_prefixThread;  // hashing an existing .part or appending segments; owns m_hash meanwhile
+    std::atomic<bool> m_stopHashing;
+    
+    static constexpr qint64 READ_BUFFER_BYTES = 4 * 1024 * 1024;   // most the reply holds in RAM
+    static constexpr qint64 CHUNK_BYTES = 256 * 1024;
+    static constexpr int STALL_TIMEOUT_MS = 30000;   // no data for this long counts as a drop
+    static constexpr int MAX_ATTEMPTS = 5;
+    static constexpr int RETRY_DELAY_MS = 2000;      // doubled on each attempt
+    static constexpr qint64 POINTER_MAX_BYTES = 1024;   // an LFS pointer is ~130 bytes
+    static constexpr qint64 SEGMENT_MIN_BYTES = 64 * 1024 * 1024;   // smaller isn't worth the extra connections
+};
+
+#endif // MODELDOWNLOAD_H
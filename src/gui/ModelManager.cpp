@@ -1,4 +1,6 @@
 #include "ModelManager.h"
+#include "ModelDownload.h"
+#include "ZipExtractor.h"
 #include "../utils/Settings.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -8,12 +10,13 @@
 #include <QPushButton>
 #include <QProgressBar>
 #include <QMessageBox>
-#include <QNetworkRequest>
-#include <QNetworkReply>
 #include <QFile>
 #include <QDir>
-#include <QProcess>
 #include <QDebug>
+#include <QNetworkReply>
+#include <QTimer>
+#include <algorithm>
+#include <iterator>
 
 const QList<ModelManager::ModelInfo> ModelManager::MODELS = {
     {"Whisper Tiny", "ggml-tiny.bin", "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-tiny.bin", 75},
@@ -34,22 +37,40 @@ const QList<ModelManager::ModelInfo> ModelManager::MODELS = {
 ModelManager::ModelManager(QWidget* parent)
     : QDialog(parent)
     , m_networkManager(new QNetworkAccessManager(this))
-    , m_currentDownload(nullptr)
-    , m_downloadingRow(-1)
-    , m_downloadProgressBar(nullptr) {
+    , m_parallelDownloads(std::max(1, Settings::instance().parallelDownloads()))
+    , m_connections(std::max(1, Settings::instance().downloadConnections()))
+    , m_bandwidthTimer(new QTimer(this))
+    , m_verifier(new ModelVerifier(this))
+    , m_pendingPointers(0) {
     
     setWindowTitle("Manage Models - Speech Recorder");
     resize(800, 500);
     
     m_modelDirectory = Settings::instance().modelDirectory();
     
+    connect(m_verifier, &ModelVerifier::progress, this, &ModelManager::onVerifyProgress);
+    connect(m_verifier, &ModelVerifier::fileVerified, this, &ModelManager::onModelVerified);
+    connect(m_verifier, &ModelVerifier::finished, this, &ModelManager::onVerifyFinished);
+    
+    m_bandwidthTimer->setInterval(BANDWIDTH_INTERVAL_MS);
+    connect(m_bandwidthTimer, &QTimer::timeout, this, &ModelManager::updateBandwidth);
+    m_bandwidthClock.start();
+    
     setupUI();
     refreshModelList();
 }
 
 ModelManager::~ModelManager() {
-    if (m_currentDownload) {
-        m_currentDownload->abort();
+    // the .parts stay, Download picks up from there next time
+    for (const ActiveDownload& active : m_active) {
+        if (active.download) {
+            active.download->cancel();
+        }
+        if (active.extractor) {
+            active.extractor->cancel();
+            active.extractor->wait();
+            delete active.extractor;
+        }
     }
 }
 
@@ -85,8 +106,24 @@ void ModelManager::setupUI() {
     mainLayout->addWidget(m_storageLabel);
     updateStorageInfo();
     
-    // Close button
+    // Running downloads, all together
+    m_bandwidthLabel = new QLabel();
+    m_bandwidthLabel->setStyleSheet("color: #888; font-size: 11px;");
+    m_bandwidthLabel->setVisible(false);
+    mainLayout->addWidget(m_bandwidthLabel);
+    
+    // Close button, and checking what is on disk
     QHBoxLayout* buttonLayout = new QHBoxLayout();
+    m_verifyButton = new QPushButton("Verify All");
+    m_verifyButton->setToolTip("Checks the downloaded Whisper models against their published "
+                               "SHA-256 checksums");
+    connect(m_verifyButton, &QPushButton::clicked, this, &ModelManager::onVerifyAllClicked);
+    buttonLayout->addWidget(m_verifyButton);
+    m_verifyProgressBar = new QProgressBar();
+    m_verifyProgressBar->setRange(0, 1000);
+    m_verifyProgressBar->setTextVisible(false);
+    m_verifyProgressBar->setVisible(false);
+    buttonLayout->addWidget(m_verifyProgressBar);
     buttonLayout->addStretch();
     m_closeButton = new QPushButton("Close");
     connect(m_closeButton, &QPushButton::clicked, this, &QDialog::accept);
@@ -104,6 +141,11 @@ void ModelManager::refreshModelList() {
     for (int row = 0; row < MODELS.size(); ++row) {
         const ModelInfo& model = MODELS[row];
         
+        // rows with a download running or queued keep their progress
+        if (m_active.contains(row) || m_queue.contains(row)) {
+            continue;
+        }
+        
         // Model name
         m_modelTable->setItem(row, 0, new QTableWidgetItem(model.name));
         
@@ -112,7 +154,12 @@ void ModelManager::refreshModelList() {
         
         // Status
         bool downloaded = isModelDownloaded(model.filename);
-        QTableWidgetItem* statusItem = new QTableWidgetItem(downloaded ? "✓ Ready" : "Not Downloaded");
+        qint64 partial = downloaded ? 0 : ModelDownload::partSize(QDir(m_modelDirectory).filePath(model.filename));
+        QString status = downloaded ? "✓ Ready" : "Not Downloaded";
+        if (partial > 0) {
+            status = QString("Paused at %1").arg(formatSize(partial));
+        }
+        QTableWidgetItem* statusItem = new QTableWidgetItem(status);
         statusItem->setForeground(downloaded ? QColor(Qt::green) : QColor(Qt::gray));
         m_modelTable->setItem(row, 2, statusItem);
         
@@ -125,7 +172,7 @@ void ModelManager::refreshModelList() {
                 onRemoveClicked(row);
             });
         } else {
-            actionBtn->setText("Download");
+            actionBtn->setText(partial > 0 ? "Resume" : "Download");
             actionBtn->setStyleSheet("background-color: #4CAF50;");
             connect(actionBtn, &QPushButton::clicked, [this, row]() {
                 onDownloadClicked(row);
@@ -141,35 +188,36 @@ void ModelManager::refreshModelList() {
 }
 
 void ModelManager::onDownloadClicked(int row) {
-    if (m_currentDownload) {
-        QMessageBox::warning(this, "Download in Progress", 
-                           "Please wait for the current download to complete.");
+    if (m_active.contains(row) || m_queue.contains(row)) {
         return;
     }
     
     const ModelInfo& model = MODELS[row];
+    qint64 partial = ModelDownload::partSize(QDir(m_modelDirectory).filePath(model.filename));
     
-    auto reply = QMessageBox::question(this, "Download Model",
-                                      QString("Download %1 (%2 MB)?\n\nThis may take several minutes.")
-                                      .arg(model.name).arg(model.sizeMB),
+    QString question = QString("Download %1 (%2 MB)?\n\nThis may take several minutes.")
+                       .arg(model.name).arg(model.sizeMB);
+    if (partial > 0) {
+        question = QString("Resume downloading %1?\n\n%2 of %3 MB already downloaded.")
+                   .arg(model.name).arg(formatSize(partial)).arg(model.sizeMB);
+    }
+    auto reply = QMessageBox::question(this, "Download Model", question,
                                       QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        downloadModel(model.name, model.url, model.filename);
-        m_downloadingRow = row;
-        
-        // Update button to show "Downloading..."
-        QPushButton* btn = qobject_cast<QPushButton*>(m_modelTable->cellWidget(row, 3));
-        if (btn) {
-            btn->setText("Downloading...");
-            btn->setEnabled(false);
+        // a zip that finished downloading but was never unpacked needs no
+        // network, and so no download slot
+        QString filepath = QDir(m_modelDirectory).filePath(model.filename);
+        if (filepath.endsWith(".zip") && QFile::exists(filepath)) {
+            m_active[row].zipPath = filepath;
+            showRowState(row, "Extracting...", "Installing...");
+            startExtraction(row, filepath, true);
+            return;
         }
         
-        // Add progress bar
-        m_downloadProgressBar = new QProgressBar();
-        m_downloadProgressBar->setRange(0, 100);
-        m_downloadProgressBar->setValue(0);
-        m_modelTable->setCellWidget(row, 4, m_downloadProgressBar);
+        m_queue.append(row);
+        showRowState(row, "Queued", "Queued...");
+        startQueued();
     }
 }
 
@@ -196,6 +244,7 @@ void ModelManager::onRemoveClicked(int row) {
         // Try to remove as file
         if (QFile::exists(actualPath)) {
             success = QFile::remove(actualPath);
+            ModelVerifier::removeDigest(actualPath);
         }
         // Try to remove as directory
         else if (QDir(actualPath).exists()) {
@@ -215,116 +264,412 @@ void ModelManager::onRemoveClicked(int row) {
     }
 }
 
-void ModelManager::downloadModel(const QString& name, const QString& url, const QString& filename) {
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "SpeechRecorder/1.0");
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, 
-                        QNetworkRequest::NoLessSafeRedirectPolicy);
-    
-    m_currentDownloadFile = QDir(m_modelDirectory).filePath(filename);
-    m_currentDownload = m_networkManager->get(request);
+void ModelManager::startQueued() {
+    while (!m_queue.isEmpty() && downloadsRunning() < m_parallelDownloads) {
+        downloadModel(m_queue.takeFirst());
+    }
+    if (!m_bandwidthTimer->isActive() && downloadsRunning() > 0) {
+        m_bandwidthClock.start();
+        m_bandwidthTimer->start();
+    }
+    updateBandwidth();
+}
+
+void ModelManager::downloadModel(int row) {
+    // streamed to <filename>.part, hashed on the way, and renamed when
+    // complete; resumed if a .part is already there
+    const ModelInfo& model = MODELS[row];
+    QString destination = QDir(m_modelDirectory).filePath(model.filename);
+    ActiveDownload& active = m_active[row];
+    active.download = new ModelDownload(m_networkManager, QUrl(model.url), destination, this);
+    active.download->setExpectedSha256(expectedDigest(model));
+    active.download->setConnections(m_connections);
+    active.received = ModelDownload::partSize(destination);
+    active.receivedAtTick = active.received;
     
-    connect(m_currentDownload, &QNetworkReply::downloadProgress,
+    connect(active.download, &ModelDownload::progress,
             this, &ModelManager::onDownloadProgress);
-    connect(m_currentDownload, &QNetworkReply::finished,
+    connect(active.download, &ModelDownload::finished,
             this, &ModelManager::onDownloadFinished);
-    // Use errorOccurred for Qt 5.15+, error for Qt 5.12
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-    connect(m_currentDownload, &QNetworkReply::errorOccurred,
+    connect(active.download, &ModelDownload::failed,
             this, &ModelManager::onDownloadError);
-#else
-    connect(m_currentDownload, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::error),
-            this, &ModelManager::onDownloadError);
-#endif
+    connect(active.download, &ModelDownload::restarted,
+            this, &ModelManager::onDownloadRestarted);
+    
+    showRowState(row, "Downloading", "Downloading...");
+    qDebug() << "Downloading" << model.name << "from" << active.download->url().toString();
     
-    qDebug() << "Downloading" << name << "from" << url;
+    // Vosk models unpack from the .part while it is still arriving, so
+    // installing takes no longer than the download
+    if (destination.endsWith(".zip")) {
+        active.zipPath = destination;
+        startExtraction(row, ModelDownload::partPath(destination), false);
+    }
+    active.download->start();
 }
 
 void ModelManager::onDownloadProgress(qint64 received, qint64 total) {
-    if (m_downloadProgressBar && total > 0) {
+    int row = rowOf(sender());
+    if (row < 0) return;
+    ActiveDownload& active = m_active[row];
+    active.received = received;
+    
+    if (active.progressBar && total > 0) {
         int percentage = static_cast<int>((received * 100) / total);
-        m_downloadProgressBar->setValue(percentage);
+        active.progressBar->setValue(percentage);
         
         // Update progress text
         QString progressText = QString("%1 / %2")
             .arg(formatSize(received))
             .arg(formatSize(total));
-        m_modelTable->item(m_downloadingRow, 4)->setText(progressText);
+        if (active.bytesPerSecond > 0) {
+            progressText += QString(" (%1/s)").arg(formatSize(static_cast<qint64>(active.bytesPerSecond)));
+        }
+        m_modelTable->item(row, 4)->setText(progressText);
+    }
+    
+    // only the unbroken start of the .part; segments come later
+    if (active.extractor) {
+        active.extractor->setAvailable(active.download->written(), false);
     }
 }
 
 void ModelManager::onDownloadFinished() {
-    if (!m_currentDownload) return;
-    
-    if (m_currentDownload->error() == QNetworkReply::NoError) {
-        // Save downloaded data
-        QFile file(m_currentDownloadFile);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(m_currentDownload->readAll());
-            file.close();
-            
-            qDebug() << "Download completed:" << m_currentDownloadFile;
-            
-            // Extract if it's a zip file
-            if (m_currentDownloadFile.endsWith(".zip")) {
-                extractZipIfNeeded(m_currentDownloadFile);
-            }
-            
-            QMessageBox::information(this, "Download Complete",
-                                   QString("Model downloaded successfully to:\n%1")
-                                   .arg(m_currentDownloadFile));
-            
-            refreshModelList();
-            emit modelsChanged();
-        } else {
-            QMessageBox::critical(this, "Error", 
-                                QString("Failed to save file: %1").arg(file.errorString()));
-        }
+    int row = rowOf(sender());
+    if (row < 0) return;
+    ActiveDownload& active = m_active[row];
+    
+    // already complete, checked and in place, nothing left to write
+    QString filepath = active.download->destination();
+    QByteArray digest = active.download->expectedSha256();
+    active.download->deleteLater();
+    active.download = nullptr;
+    
+    // a zip is mostly unpacked by now; the extractor finishes the tail
+    // and installs it, and reports back in onExtracted(). Either way the
+    // download slot is free
+    if (active.extractor) {
+        active.extractor->setAvailable(QFileInfo(filepath).size(), true);
+        m_modelTable->item(row, 2)->setText("Extracting...");
+        startQueued();
+        return;
     }
     
-    m_currentDownload->deleteLater();
-    m_currentDownload = nullptr;
-    m_downloadingRow = -1;
+    // keep the digest it matched so Verify All works offline
+    if (!digest.isEmpty()) {
+        ModelVerifier::storeDigest(filepath, digest);
+    }
+    qDebug() << "Model downloaded to" << filepath;
+    m_completed.append(MODELS[row].name);
+    finishRow(row);
+    emit modelsChanged();
 }
 
-void ModelManager::onDownloadError() {
-    if (m_currentDownload && m_currentDownload->error() != QNetworkReply::NoError) {
-        QMessageBox::critical(this, "Download Error",
-                            QString("Download failed: %1").arg(m_currentDownload->errorString()));
-        
-        m_currentDownload->deleteLater();
-        m_currentDownload = nullptr;
+void ModelManager::onDownloadError(const QString& error) {
+    int row = rowOf(sender());
+    if (row < 0) return;
+    ActiveDownload& active = m_active[row];
+    
+    QString message = QString("Download of %1 failed: %2").arg(MODELS[row].name).arg(error);
+    if (ModelDownload::partSize(active.download->destination()) > 0) {
+        message += "\n\nWhat was downloaded is kept; Resume continues from there.";
+    }
+    finishRow(row);
+    
+    QMessageBox::critical(this, "Download Error", message);
+}
+
+QByteArray ModelManager::expectedDigest(const ModelInfo& model) const {
+    if (!model.sha256.isEmpty()) {
+        return model.sha256.toLatin1().toLower();
+    }
+    return ModelVerifier::storedDigest(QDir(m_modelDirectory).filePath(model.filename));
+}
+
+void ModelManager::onVerifyAllClicked() {
+    if (m_verifier->isRunning() || m_pendingPointers > 0) {
+        return;
+    }
+    
+    // 1. Whisper models on disk; Vosk models are unpacked directories
+    //    with nothing published to check them against
+    m_verifyRows.clear();
+    for (int row = 0; row < MODELS.size(); ++row) {
+        const ModelInfo& model = MODELS[row];
+        if (model.filename.endsWith(".zip") || !isModelDownloaded(model.filename)) {
+            continue;
+        }
+        m_verifyRows.append(row);
         
-        // Refresh to restore buttons
+        // 1a. no digest yet (downloaded before checksums were kept): the
+        //     LFS pointer is a few hundred bytes, fetch that first
+        if (!expectedDigest(model).isEmpty()) {
+            continue;
+        }
+        QNetworkReply* reply = ModelDownload::requestPointer(m_networkManager,
+                                                             ModelDownload::mirrored(QUrl(model.url)));
+        if (!reply) {
+            continue;
+        }
+        m_pendingPointers++;
+        QString path = QDir(m_modelDirectory).filePath(model.filename);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, path]() {
+            QByteArray digest = ModelDownload::pointerDigest(reply);
+            if (!digest.isEmpty()) {
+                ModelVerifier::storeDigest(path, digest);
+            }
+            reply->deleteLater();
+            if (--m_pendingPointers == 0) {
+                startVerify();
+            }
+        });
+    }
+    
+    if (m_verifyRows.isEmpty()) {
+        QMessageBox::information(this, "Verify Models", "There are no downloaded Whisper models to verify.");
+        return;
+    }
+    m_verifyButton->setEnabled(false);
+    if (m_pendingPointers == 0) {
+        startVerify();
+    }
+}
+
+void ModelManager::startVerify() {
+    // 2. hash them all in parallel against what is now known
+    QList<ModelVerifier::Job> jobs;
+    for (int row : m_verifyRows) {
+        const ModelInfo& model = MODELS[row];
+        jobs.append({QDir(m_modelDirectory).filePath(model.filename), expectedDigest(model)});
+        m_modelTable->item(row, 2)->setText("Verifying...");
+    }
+    std::fill(std::begin(m_verifyCounts), std::end(m_verifyCounts), 0);
+    m_verifyProgressBar->setValue(0);
+    m_verifyProgressBar->setVisible(true);
+    m_verifier->verifyAll(jobs);
+}
+
+void ModelManager::onVerifyProgress(qint64 hashed, qint64 total) {
+    if (total > 0) {
+        m_verifyProgressBar->setValue(static_cast<int>(hashed * 1000 / total));
+    }
+}
+
+void ModelManager::onModelVerified(int index, ModelVerifier::Status status, const QByteArray& digest) {
+    int row = m_verifyRows.value(index, -1);
+    if (row < 0) return;
+    m_verifyCounts[status]++;
+    
+    QTableWidgetItem* statusItem = m_modelTable->item(row, 2);
+    switch (status) {
+        case ModelVerifier::Verified:
+            statusItem->setText("✓ Verified");
+            statusItem->setForeground(QColor(Qt::green));
+            break;
+        case ModelVerifier::Mismatch:
+            statusItem->setText("✗ Corrupt, download again");
+            statusItem->setForeground(QColor(Qt::red));
+            qWarning() << "Checksum mismatch:" << MODELS[row].filename << "is" << digest;
+            break;
+        case ModelVerifier::NoDigest:
+            statusItem->setText("✓ Ready (no checksum)");
+            break;
+        case ModelVerifier::Unreadable:
+            statusItem->setText("✗ Unreadable");
+            statusItem->setForeground(QColor(Qt::red));
+            break;
+    }
+}
+
+void ModelManager::onVerifyFinished() {
+    m_verifyProgressBar->setVisible(false);
+    m_verifyButton->setEnabled(true);
+    
+    QString summary = QString("%1 verified").arg(m_verifyCounts[ModelVerifier::Verified]);
+    if (m_verifyCounts[ModelVerifier::Mismatch] > 0) {
+        summary += QString(", %1 corrupt (remove and download again)").arg(m_verifyCounts[ModelVerifier::Mismatch]);
+    }
+    if (m_verifyCounts[ModelVerifier::Unreadable] > 0) {
+        summary += QString(", %1 unreadable").arg(m_verifyCounts[ModelVerifier::Unreadable]);
+    }
+    if (m_verifyCounts[ModelVerifier::NoDigest] > 0) {
+        summary += QString(", %1 without a published checksum").arg(m_verifyCounts[ModelVerifier::NoDigest]);
+    }
+    
+    if (m_verifyCounts[ModelVerifier::Mismatch] + m_verifyCounts[ModelVerifier::Unreadable] > 0) {
+        QMessageBox::warning(this, "Verify Models", summary + ".");
+    } else {
+        QMessageBox::information(this, "Verify Models", summary + ".");
+    }
+}
+
+void ModelManager::onDownloadRestarted() {
+    // the server sent the archive from the start: what was unpacked from
+    // the old bytes is no good
+    int row = rowOf(sender());
+    if (row < 0 || !m_active[row].extractor) return;
+    
+    ZipExtractor* extractor = m_active[row].extractor;
+    QString archive = extractor->archive();
+    extractor->cancel();
+    extractor->wait();
+    delete extractor;
+    m_active[row].extractor = nullptr;
+    startExtraction(row, archive, false);
+}
+
+void ModelManager::startExtraction(int row, const QString& archive, bool complete) {
+    // the model directory is the archive's name without ".zip"
+    ActiveDownload& active = m_active[row];
+    QString destination = active.zipPath.left(active.zipPath.length() - 4);
+    active.extractor = new ZipExtractor(archive, destination);
+    
+    connect(active.extractor, &ZipExtractor::extractProgress, this, &ModelManager::onExtractProgress);
+    connect(active.extractor, &ZipExtractor::extracted, this, &ModelManager::onExtracted);
+    connect(active.extractor, &ZipExtractor::extractFailed, this, &ModelManager::onExtractFailed);
+    
+    active.extractor->setAvailable(QFileInfo(archive).size(), complete);
+    active.extractor->start();
+    qDebug() << "Extracting" << active.zipPath << "to" << destination;
+}
+
+void ModelManager::onExtractProgress(qint64 read, qint64 total) {
+    // while the download is running its own progress is the one shown
+    int row = rowOf(sender());
+    if (row < 0 || m_active[row].download || total <= 0) {
+        return;
+    }
+    if (m_active[row].progressBar) {
+        m_active[row].progressBar->setValue(static_cast<int>(read * 100 / total));
+    }
+    m_modelTable->item(row, 4)->setText(QString("Extracting %1 / %2")
+                                        .arg(formatSize(read))
+                                        .arg(formatSize(total)));
+}
+
+void ModelManager::onExtracted() {
+    int row = rowOf(sender());
+    if (row < 0) return;
+    
+    QFile::remove(m_active[row].zipPath);
+    qDebug() << "Model installed to" << m_active[row].extractor->destination();
+    m_completed.append(MODELS[row].name);
+    finishRow(row);
+    emit modelsChanged();
+}
+
+void ModelManager::onExtractFailed(const QString& error, bool archiveDamaged) {
+    int row = rowOf(sender());
+    if (row < 0) return;
+    
+    // the download is stopped too: a broken archive won't get better
+    QString name = MODELS[row].name;
+    QString zipPath = m_active[row].zipPath;
+    finishRow(row);
+    
+    // bad bytes are deleted, .part and ETag included, so [Download] fetches
+    // the archive fresh instead of unpacking the same ones again; after a
+    // local failure (disk full, permissions) they're kept for another try
+    QString next = "The archive was kept, Download tries unpacking it again.";
+    if (archiveDamaged) {
+        QFile::remove(zipPath);
+        ModelDownload::discard(zipPath);
         refreshModelList();
+        next = "The archive was deleted, Download fetches it again.";
     }
+    
+    QMessageBox::warning(this, "Extraction Failed",
+                       QString("%1 could not be unpacked: %2\n\n%3").arg(name).arg(error).arg(next));
 }
 
-void ModelManager::extractZipIfNeeded(const QString& filepath) {
-    // Extract zip file using system unzip command
-    QFileInfo fileInfo(filepath);
-    QString outputDir = fileInfo.dir().path();
+void ModelManager::finishRow(int row) {
+    // the .part stays for a later resume; a cancelled extractor says
+    // nothing more, and waiting for it is at most one chunk of inflate
+    ActiveDownload active = m_active.take(row);
+    if (active.download) {
+        active.download->cancel();
+        active.download->deleteLater();
+    }
+    if (active.extractor) {
+        active.extractor->cancel();
+        active.extractor->wait();
+        active.extractor->deleteLater();
+    }
+    m_modelTable->removeCellWidget(row, 4);
     
-    QProcess unzip;
-    unzip.setWorkingDirectory(outputDir);
+    refreshModelList();
+    startQueued();
     
-    QStringList args;
-    args << "-o" << filepath << "-d" << outputDir;
+    // one message for the whole batch, once nothing is left running
+    if (m_active.isEmpty() && m_queue.isEmpty() && !m_completed.isEmpty()) {
+        QString names = m_completed.join("\n");
+        m_completed.clear();
+        QMessageBox::information(this, "Download Complete",
+                               QString("Downloaded to %1:\n\n%2").arg(m_modelDirectory).arg(names));
+    }
+}
+
+void ModelManager::showRowState(int row, const QString& status, const QString& action) {
+    m_modelTable->item(row, 2)->setText(status);
+    QPushButton* btn = qobject_cast<QPushButton*>(m_modelTable->cellWidget(row, 3));
+    if (btn) {
+        btn->setText(action);
+        btn->setEnabled(false);
+    }
     
-    qDebug() << "Extracting:" << filepath;
-    unzip.start("unzip", args);
-    unzip.waitForFinished(300000); // 5 minute timeout
+    // Add progress bar
+    ActiveDownload& active = m_active[row];
+    if (!active.progressBar && !m_queue.contains(row)) {
+        active.progressBar = new QProgressBar();
+        active.progressBar->setRange(0, 100);
+        active.progressBar->setValue(0);
+        m_modelTable->setCellWidget(row, 4, active.progressBar);
+    }
+}
+
+void ModelManager::updateBandwidth() {
+    // per row and in total, over the last interval
+    double seconds = m_bandwidthClock.restart() / 1000.0;
+    double total = 0;
+    for (ActiveDownload& active : m_active) {
+        if (active.download && seconds > 0) {
+            active.bytesPerSecond = std::max<qint64>(0, active.received - active.receivedAtTick) / seconds;
+            total += active.bytesPerSecond;
+        }
+        active.receivedAtTick = active.received;
+    }
     
-    if (unzip.exitCode() == 0) {
-        qDebug() << "Extraction successful";
-        // Remove zip file after extraction
-        QFile::remove(filepath);
-    } else {
-        qWarning() << "Extraction failed:" << unzip.readAllStandardError();
-        QMessageBox::warning(this, "Extraction Warning",
-                           "Downloaded zip file but extraction failed. "
-                           "You may need to extract it manually with: unzip " + filepath);
+    int running = downloadsRunning();
+    if (running == 0) {
+        m_bandwidthTimer->stop();
+        m_bandwidthLabel->setVisible(false);
+        return;
+    }
+    QString text = QString("Downloading %1 of %2 at once, %3/s")
+                   .arg(running).arg(m_parallelDownloads)
+                   .arg(formatSize(static_cast<qint64>(total)));
+    if (!m_queue.isEmpty()) {
+        text += QString(" | %1 queued").arg(m_queue.size());
+    }
+    m_bandwidthLabel->setText(text);
+    m_bandwidthLabel->setVisible(true);
+}
+
+int ModelManager::rowOf(QObject* object) const {
+    for (auto it = m_active.constBegin(); it != m_active.constEnd(); ++it) {
+        if (object && (it->download == object || it->extractor == object)) {
+            return it.key();
+        }
+    }
+    return -1;
+}
+
+int ModelManager::downloadsRunning() const {
+    int running = 0;
+    for (const ActiveDownload& active : m_active) {
+        running += active.download ? 1 : 0;
     }
+    return running;
 }
 
 bool ModelManager::isModelDownloaded(const QString& filename) const {
@@ -1,19 +1,29 @@
 #ifndef MODELMANAGER_H
 #define MODELMANAGER_H
 
+#include "ModelVerifier.h"
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QList>
 #include <QMap>
 #include <QNetworkAccessManager>
+#include <QStringList>
 
 class QTableWidget;
 class QLabel;
 class QProgressBar;
 class QPushButton;
-class QNetworkReply;
+class QTimer;
+class ModelDownload;
+class ZipExtractor;
 
+// The model table. Downloads are queued: up to Settings::parallelDownloads()
+// run at once, each with its own progress in its row, and the total
+// bandwidth is shown under the table. Vosk archives unpack while they
+// download (ZipExtractor); that doesn't take a download slot.
 class ModelManager : public QDialog {
     Q_OBJECT
-
+    
 public:
     explicit ModelManager(QWidget* parent = nullptr);
     ~ModelManager();
@@ -26,7 +36,16 @@ private slots:
     void onRemoveClicked(int row);
     void onDownloadProgress(qint64 received, qint64 total);
     void onDownloadFinished();
-    void onDownloadError();
+    void onDownloadError(const QString& error);
+    void onDownloadRestarted();
+    void onExtractProgress(qint64 read, qint64 total);
+    void onExtracted();
+    void onExtractFailed(const QString& error, bool archiveDamaged);
+    void updateBandwidth();
+    void onVerifyAllClicked();
+    void onVerifyProgress(qint64 hashed, qint64 total);
+    void onModelVerified(int index, ModelVerifier::Status status, const QByteArray& digest);
+    void onVerifyFinished();
     
 private:
     void setupUI();
@@ -35,20 +54,48 @@ private:
     QString formatSize(qint64 bytes) const;
     bool isModelDownloaded(const QString& filename) const;
     qint64 getModelSize(const QString& filename) const;
-    void downloadModel(const QString& name, const QString& url, const QString& filename);
-    void extractZipIfNeeded(const QString& filepath);
+    void startQueued();
+    void downloadModel(int row);
+    void startVerify();
+    void startExtraction(int row, const QString& archive, bool complete);
+    void finishRow(int row);
+    void showRowState(int row, const QString& status, const QString& action);
+    int rowOf(QObject* object) const;
+    int downloadsRunning() const;
     
     // UI components
     QTableWidget* m_modelTable;
     QLabel* m_storageLabel;
     QPushButton* m_closeButton;
+    QPushButton* m_verifyButton;
+    QProgressBar* m_verifyProgressBar;
     
     // Download management
+    struct ActiveDownload {
+        ModelDownload* download = nullptr;   // null once the file is in
+        ZipExtractor* extractor = nullptr;   // Vosk: unpacking alongside the download
+        QProgressBar* progressBar = nullptr;
+        QString zipPath;                     // the archive, removed once unpacked
+        qint64 received = 0;
+        qint64 receivedAtTick = 0;
+        double bytesPerSecond = 0;
+    };
+    
     QNetworkAccessManager* m_networkManager;
-    QNetworkReply* m_currentDownload;
-    QString m_currentDownloadFile;
-    int m_downloadingRow;
-    QProgressBar* m_downloadProgressBar;
+    QMap<int, ActiveDownload> m_active;   // by table row
+    QList<int> m_queue;                   // rows waiting for a free slot
+    QStringList m_completed;              // names installed since the queue was last empty
+    int m_parallelDownloads;
+    int m_connections;                    // per download
+    QLabel* m_bandwidthLabel;
+    QTimer* m_bandwidthTimer;
+    QElapsedTimer m_bandwidthClock;
+    
+    // Verify all
+    ModelVerifier* m_verifier;
+    QList<int> m_verifyRows;      // table row of each verifier job
+    int m_pendingPointers;        // LFS pointer requests still out
+    int m_verifyCounts[ModelVerifier::Unreadable + 1];
     
     // Model information
     struct ModelInfo {
@@ -56,10 +103,15 @@ private:
         QString filename;
         QString url;
         int sizeMB;
+        QString sha256;   // hex; empty = taken from the LFS pointer, if there is one
     };
     
+    QByteArray expectedDigest(const ModelInfo& model) const;
+    
     static const QList<ModelInfo> MODELS;
     QString m_modelDirectory;
+    
+    static constexpr int BANDWIDTH_INTERVAL_MS = 1000;
 };
 
 #endif // MODELMANAGER_H
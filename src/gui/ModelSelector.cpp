@@ -101,7 +101,12 @@ void ModelSelector::updateModelList() {
 }
 
 QString ModelSelector::getModelDisplayName(const QString& modelName, bool isDownloaded) const {
-    if (isDownloaded) {
+    if (modelName == m_loadingModel) {
+        if (m_loadingPercent < 0) {
+            return QString("%1 (Loading...)").arg(modelName);
+        }
+        return QString("%1 (Loading %2%)").arg(modelName).arg(m_loadingPercent);
+    } else if (isDownloaded) {
         return QString("%1 ✓").arg(modelName);
     } else {
         return QString("%1 (Download Required)").arg(modelName);
@@ -116,6 +121,31 @@ bool ModelSelector::isModelDownloaded(const QString& modelName) const {
     return m_modelStatus.value(modelName, false);
 }
 
+void ModelSelector::setLoadingState(const QString& modelName, int percent) {
+    if (modelName != m_loadingModel) {
+        QString previous = m_loadingModel;
+        m_loadingModel = modelName;
+        updateItemText(previous);
+    }
+    m_loadingPercent = percent;
+    updateItemText(modelName);
+}
+
+void ModelSelector::clearLoadingState() {
+    QString previous = m_loadingModel;
+    m_loadingModel.clear();
+    m_loadingPercent = -1;
+    updateItemText(previous);
+}
+
+void ModelSelector::updateItemText(const QString& modelName) {
+    // setItemText doesn't touch the selection, so no modelChanged is emitted
+    int index = findData(modelName);
+    if (index >= 0) {
+        setItemText(index, getModelDisplayName(modelName, m_modelStatus.value(modelName, false)));
+    }
+}
+
 void ModelSelector::onCurrentIndexChanged(int index) {
     if (index < 0) return;
     
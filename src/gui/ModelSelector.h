@@ -14,6 +14,10 @@ public:
     QString selectedModel() const;
     bool isModelDownloaded(const QString& modelName) const;
     
+    // Show load progress next to a model (-1 = no percentage available)
+    void setLoadingState(const QString& modelName, int percent);
+    void clearLoadingState();
+    
 signals:
     void modelChanged(const QString& modelName);
     
@@ -24,7 +28,11 @@ private:
     void updateModelList();
     QString getModelDisplayName(const QString& modelName, bool isDownloaded) const;
     
+    void updateItemText(const QString& modelName);
+    
     QMap<QString, bool> m_modelStatus; // model name -> is downloaded
+    QString m_loadingModel;
+    int m_loadingPercent = -1;
     
     // Model definitions
     struct ModelInfo {
@@ -0,0 +1,188 @@
+#include "ModelVerifier.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QTimer>
+#include <algorithm>
+
+ModelVerifier::ModelVerifier(QObject* parent)
+    : QObject(parent)
+    , m_nextJob(0)
+    , m_remaining(0)
+    , m_hashed(0)
+    , m_cancelled(false)
+    , m_total(0)
+    , m_progressTimer(new QTimer(this)) {
+    
+    m_progressTimer->setInterval(PROGRESS_INTERVAL_MS);
+    connect(m_progressTimer, &QTimer::timeout, this, &ModelVerifier::reportProgress);
+}
+
+ModelVerifier::~ModelVerifier() {
+    m_cancelled = true;
+    stopWorkers();
+}
+
+void ModelVerifier::verifyAll(const QList<Job>& jobs) {
+    if (isRunning()) {
+        return;
+    }
+    
+    m_jobs = jobs;
+    m_nextJob = 0;
+    m_remaining = jobs.size();
+    m_hashed = 0;
+    m_cancelled = false;
+    m_total = 0;
+    for (const Job& job : jobs) {
+        m_total += QFileInfo(job.path).size();
+    }
+    if (jobs.isEmpty()) {
+        emit finished();
+        return;
+    }
+    
+    // no more threads than files, none idle while a file is left
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int workers = std::min(cores, jobs.size());
+    for (int i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&ModelVerifier::workerLoop, this);
+    }
+    m_progressTimer->start();
+    qDebug() << "Verifying" << jobs.size() << "models on" << workers << "threads";
+}
+
+void ModelVerifier::workerLoop() {
+    for (int index = m_nextJob++; index < m_jobs.size() && !m_cancelled; index = m_nextJob++) {
+        const Job& job = m_jobs[index];
+        Result result{index, Unreadable, QByteArray()};
+        
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        if (addFile(hash, job.path, -1, &m_hashed, &m_cancelled)) {
+            result.digest = hash.result().toHex();
+            if (job.expected.isEmpty()) {
+                result.status = NoDigest;
+            } else {
+                result.status = result.digest == job.expected.toLower() ? Verified : Mismatch;
+            }
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(result);
+        }
+        QMetaObject::invokeMethod(this, "deliverResults", Qt::QueuedConnection);
+    }
+}
+
+void ModelVerifier::deliverResults() {
+    std::vector<Result> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        results.swap(m_results);
+    }
+    
+    for (const Result& result : results) {
+        emit fileVerified(result.index, result.status, result.digest);
+        m_remaining--;
+    }
+    
+    // the last file is in: the workers are done or about to be
+    if (m_remaining == 0 && isRunning()) {
+        stopWorkers();
+        reportProgress();
+        emit finished();
+    }
+}
+
+void ModelVerifier::reportProgress() {
+    emit progress(m_hashed.load(), m_total);
+}
+
+void ModelVerifier::stopWorkers() {
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_progressTimer->stop();
+}
+
+bool ModelVerifier::addFile(QCryptographicHash& hash, const QString& path, qint64 length,
+                            std::atomic<qint64>* hashed, const std::atomic<bool>* stop) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot read" << path << ":" << file.errorString();
+        return false;
+    }
+    
+    std::vector<char> buffer(READ_CHUNK);
+    qint64 left = length < 0 ? file.size() : length;
+    while (left > 0) {
+        if (stop && stop->load()) {
+            return false;
+        }
+        qint64 n = file.read(buffer.data(), std::min(left, READ_CHUNK));
+        if (n <= 0) {
+            qWarning() << "Cannot read" << path << ":" << file.errorString();
+            return false;
+        }
+        hash.addData(buffer.data(), static_cast<int>(n));
+        left -= n;
+        if (hashed) {
+            *hashed += n;
+        }
+    }
+    return true;
+}
+
+QByteArray ModelVerifier::storedDigest(const QString& modelPath) {
+    QFile file(modelPath + ".sha256");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll().trimmed().toLower();
+}
+
+bool ModelVerifier::storeDigest(const QString& modelPath, const QByteArray& digest) {
+    QFile file(modelPath + ".sha256");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot write" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+    return file.write(digest + "\n") == digest.size() + 1;
+}
+
+void ModelVerifier::removeDigest(const QString& modelPath) {
+    QFile::remove(modelPath + ".sha256");
+}
+
+QUrl ModelVerifier::pointerUrl(const QUrl& url) {
+    QString path = url.path();
+    int at = path.indexOf("/resolve/");
+    if (at < 0) {
+        return QUrl();
+    }
+    QUrl pointer = url;
+    pointer.setPath(path.left(at) + "/raw/" + path.mid(at + 9));
+    return pointer;
+}
+
+QByteArray ModelVerifier::parsePointer(const QByteArray& pointer) {
+    // version https://git-lfs.github.com/spec/v1
+    // oid sha256:<64 hex digits>
+    // size <bytes>
+    for (const QByteArray& line : pointer.split('\n')) {
+        QByteArray value = line.trimmed();
+        if (value.startsWith("oid sha256:")) {
+            value = value.mid(11).toLower();
+            bool hex = value.size() == 64;
+            for (char c : value) {
+                hex = hex && ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'));
+            }
+            return hex ? value : QByteArray();
+        }
+    }
+    return QByteArray();
+}
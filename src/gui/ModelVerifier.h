@@ -0,0 +1,102 @@
+#ifndef MODELVERIFIER_H
+#define MODELVERIFIER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class QCryptographicHash;
+class QTimer;
+
+// SHA-256 checks for model files.
+//
+// The expected digest of a model is the catalog's if it has one, otherwise
+// the one Hugging Face publishes in the Git LFS pointer beside the file
+// (".../raw/main/<file>" holds "oid sha256:<hex>"). Once known it is kept
+// in "<model>.sha256" next to the model, so checking again later needs no
+// network. Downloads hash as they write (see ModelDownload); this class
+// covers files already on disk.
+//
+// verifyAll() hashes a list of files on a pool of threads. SHA-256 is
+// sequential within a file, so the pool works on one file per thread and
+// the speedup comes from checking several models at once. Progress and
+// results are reported on the verifier's thread.
+class ModelVerifier : public QObject {
+    Q_OBJECT
+    
+public:
+    enum Status {
+        Verified,      // matches the expected digest
+        Mismatch,      // corrupt or truncated: download again
+        NoDigest,      // hashed, but nothing to compare with
+        Unreadable
+    };
+    
+    struct Job {
+        QString path;
+        QByteArray expected;   // hex, may be empty
+    };
+    
+    explicit ModelVerifier(QObject* parent = nullptr);
+    ~ModelVerifier() override;
+    
+    // Results come back as fileVerified(index into jobs, ...)
+    void verifyAll(const QList<Job>& jobs);
+    bool isRunning() const { return !m_workers.empty(); }
+    
+    // Feeds the first `length` bytes of a file (-1 = all of it) to `hash`.
+    // `hashed` counts bytes as they go; `stop` ends it early (false).
+    static bool addFile(QCryptographicHash& hash, const QString& path, qint64 length,
+                        std::atomic<qint64>* hashed = nullptr,
+                        const std::atomic<bool>* stop = nullptr);
+    
+    // "<model>.sha256", hex; empty if there is none
+    static QByteArray storedDigest(const QString& modelPath);
+    static bool storeDigest(const QString& modelPath, const QByteArray& digest);
+    static void removeDigest(const QString& modelPath);
+    
+    // The LFS pointer of a ".../resolve/<rev>/<file>" URL, or an empty URL
+    static QUrl pointerUrl(const QUrl& url);
+    static QByteArray parsePointer(const QByteArray& pointer);   // hex, or empty
+    
+signals:
+    void progress(qint64 hashed, qint64 total);
+    void fileVerified(int index, ModelVerifier::Status status, const QByteArray& digest);
+    void finished();
+    
+private slots:
+    void deliverResults();
+    void reportProgress();
+    
+private:
+    struct Result {
+        int index;
+        Status status;
+        QByteArray digest;
+    };
+    
+    void workerLoop();
+    void stopWorkers();
+    
+    QList<Job> m_jobs;
+    std::vector<std::thread> m_workers;
+    std::atomic<int> m_nextJob;
+    std::atomic<int> m_remaining;
+    std::atomic<qint64> m_hashed;
+    std::atomic<bool> m_cancelled;   // only set on destruction
+    qint64 m_total;
+    std::mutex m_mutex;
+    std::vector<Result> m_results;   // guarded by m_mutex, waiting for delivery
+    QTimer* m_progressTimer;
+    
+    static constexpr qint64 READ_CHUNK = 1024 * 1024;
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+};
+
+#endif // MODELVERIFIER_H
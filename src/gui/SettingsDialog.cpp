@@ -1,5 +1,7 @@
 #include "SettingsDialog.h"
 #include "../utils/Settings.h"
+#include "../utils/LatencyTrace.h"
+#include "../audio/AudioBackend.h"
 #include <QTabWidget>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -22,6 +24,12 @@ SettingsDialog::SettingsDialog(QWidget* parent)
     loadSettings();
 }
 
+SettingsDialog::~SettingsDialog() {
+    if (m_deviceThread.joinable()) {
+        m_deviceThread.join();
+    }
+}
+
 void SettingsDialog::setupUI() {
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     
@@ -33,19 +41,75 @@ void SettingsDialog::setupUI() {
     QFormLayout* audioLayout = new QFormLayout(audioTab);
     
     m_inputDeviceCombo = new QComboBox();
-    m_inputDeviceCombo->addItem("Default");
-    m_inputDeviceCombo->addItem("PulseAudio Default");
+    m_inputDeviceCombo->addItem("Default", "default");
     audioLayout->addRow("Input Device:", m_inputDeviceCombo);
     
+    // the sound server may be slow to answer, the list fills in when it does
+    m_deviceThread = std::thread([this]() {
+        m_devices = AudioBackend::devices();
+        QMetaObject::invokeMethod(this, "onDevicesListed", Qt::QueuedConnection);
+    });
+    
     m_sampleRateCombo = new QComboBox();
-    m_sampleRateCombo->addItem("16000 Hz (Recommended)", 16000);
+    m_sampleRateCombo->addItem("Device native (Recommended)", 0);
+    m_sampleRateCombo->addItem("16000 Hz (server converts)", 16000);
     m_sampleRateCombo->addItem("44100 Hz", 44100);
     m_sampleRateCombo->addItem("48000 Hz", 48000);
+    m_sampleRateCombo->setToolTip("Audio is converted to 16 kHz mono for the models either way; "
+                                  "capturing at the device's own rate lets the app do it with a "
+                                  "better filter than the sound server's.");
     audioLayout->addRow("Sample Rate:", m_sampleRateCombo);
     
+    m_resampleQualityCombo = new QComboBox();
+    m_resampleQualityCombo->addItem("Fast", "fast");
+    m_resampleQualityCombo->addItem("Balanced (Recommended)", "balanced");
+    m_resampleQualityCombo->addItem("Best", "best");
+    m_resampleQualityCombo->setToolTip("Filter used to convert to 16 kHz. Better keeps more of "
+                                       "the top of the voice band, at a little more CPU.");
+    audioLayout->addRow("Resampling Quality:", m_resampleQualityCombo);
+    
     m_noiseGateCheck = new QCheckBox("Enable noise gate (reduce background noise)");
     audioLayout->addRow("", m_noiseGateCheck);
     
+    m_noiseGateModeCombo = new QComboBox();
+    m_noiseGateModeCombo->addItem("Gate (Recommended)", "gate");
+    m_noiseGateModeCombo->addItem("Gate + spectral noise removal", "spectral");
+    m_noiseGateModeCombo->setToolTip("Spectral removal also takes steady noise (fans, hum) out "
+                                     "of speech, at a little more CPU.");
+    audioLayout->addRow("Noise Gate Mode:", m_noiseGateModeCombo);
+    connect(m_noiseGateCheck, &QCheckBox::toggled, m_noiseGateModeCombo, &QWidget::setEnabled);
+    
+    m_vadCheck = new QCheckBox("Skip silence when transcribing");
+    m_vadCheck->setToolTip("Detects speech while recording and only sends the parts with "
+                           "speech to the model. Timestamps still match the recording.");
+    audioLayout->addRow("", m_vadCheck);
+    
+    m_spillCheck = new QCheckBox("Record to disk (for very long sessions)");
+    m_spillCheck->setToolTip("Keeps memory use flat by writing audio to a temporary file "
+                             "while recording.");
+    audioLayout->addRow("", m_spillCheck);
+    
+    m_preRollCombo = new QComboBox();
+    m_preRollCombo->addItem("Off", 0);
+    m_preRollCombo->addItem("1 second", 1);
+    m_preRollCombo->addItem("2 seconds", 2);
+    m_preRollCombo->addItem("3 seconds", 3);
+    m_preRollCombo->addItem("5 seconds", 5);
+    m_preRollCombo->setToolTip("Starts each recording with the audio from just before Record "
+                               "was pressed. The microphone stays open while the app runs.");
+    audioLayout->addRow("Pre-roll:", m_preRollCombo);
+    
+    m_backendCombo = new QComboBox();
+    m_backendCombo->addItem("PulseAudio Stream (Recommended)", "async");
+    m_backendCombo->addItem("PulseAudio Simple", "simple");
+    audioLayout->addRow("Capture Backend:", m_backendCombo);
+    
+    m_latencyCombo = new QComboBox();
+    m_latencyCombo->addItem("10 ms", 10);
+    m_latencyCombo->addItem("20 ms (Recommended)", 20);
+    m_latencyCombo->addItem("50 ms", 50);
+    audioLayout->addRow("Capture Latency:", m_latencyCombo);
+    
     audioLayout->addRow(new QLabel("<i>Note: Changes require app restart</i>"));
     
     m_tabs->addTab(audioTab, "Audio");
@@ -66,6 +130,21 @@ void SettingsDialog::setupUI() {
     m_keepLoadedCheck->setChecked(true);
     modelLayout->addRow("", m_keepLoadedCheck);
     
+    m_liveTranscriptionCheck = new QCheckBox("Show text while recording (Whisper)");
+    modelLayout->addRow("", m_liveTranscriptionCheck);
+    
+    m_adaptiveCtxCheck = new QCheckBox("Faster decoding of short clips (Whisper)");
+    m_adaptiveCtxCheck->setToolTip("Shrinks the encoder window to the clip length. "
+                                   "Falls back to the full window if confidence drops.");
+    modelLayout->addRow("", m_adaptiveCtxCheck);
+    
+    m_workersSpin = new QSpinBox();
+    m_workersSpin->setRange(0, 8);
+    m_workersSpin->setSpecialValueText("Auto");
+    m_workersSpin->setToolTip("How many recordings may be transcribed at the same time. "
+                              "Applies after restart.");
+    modelLayout->addRow("Parallel Transcriptions:", m_workersSpin);
+    
     m_languageCombo = new QComboBox();
     m_languageCombo->addItem("English", "en");
     m_languageCombo->addItem("Spanish", "es");
@@ -74,6 +153,19 @@ void SettingsDialog::setupUI() {
     m_languageCombo->addItem("Auto-detect", "auto");
     modelLayout->addRow("Language:", m_languageCombo);
     
+    m_parallelDownloadsSpin = new QSpinBox();
+    m_parallelDownloadsSpin->setRange(1, 4);
+    m_parallelDownloadsSpin->setToolTip("How many models Manage Models downloads at the same time; "
+                                        "the rest wait in a queue.");
+    modelLayout->addRow("Parallel Downloads:", m_parallelDownloadsSpin);
+    
+    m_connectionsSpin = new QSpinBox();
+    m_connectionsSpin->setRange(1, 8);
+    m_connectionsSpin->setSpecialValueText("Single");
+    m_connectionsSpin->setToolTip("Splits downloads over 64 MB across this many connections. "
+                                  "Helps when the server limits each connection's speed.");
+    modelLayout->addRow("Connections per Download:", m_connectionsSpin);
+    
     modelLayout->addRow(new QLabel("<i>Whisper supports 99+ languages</i>"));
     
     m_tabs->addTab(modelTab, "Models");
@@ -115,6 +207,13 @@ void SettingsDialog::setupUI() {
     m_logLevelCombo->addItem("Debug", 3);
     advancedLayout->addRow("Log Level:", m_logLevelCombo);
     
+    m_latencyReadoutCheck = new QCheckBox("Show per-stage timings in the status bar");
+    advancedLayout->addRow("Latency Readout:", m_latencyReadoutCheck);
+    
+    m_latencyLogCheck = new QCheckBox("Append timings to latency.jsonl");
+    m_latencyLogCheck->setToolTip(LatencyTrace::latencyLogPath());
+    advancedLayout->addRow("Latency Log:", m_latencyLogCheck);
+    
     QHBoxLayout* modelDirLayout = new QHBoxLayout();
     m_modelDirEdit = new QLineEdit();
     m_modelDirEdit->setReadOnly(true);
@@ -155,11 +254,35 @@ void SettingsDialog::setupUI() {
     mainLayout->addLayout(buttonLayout);
 }
 
+void SettingsDialog::onDevicesListed() {
+    m_deviceThread.join();
+    
+    // rebuild around whatever is selected, the saved device until now
+    QString selected = m_inputDeviceCombo->currentData().toString();
+    m_inputDeviceCombo->clear();
+    m_inputDeviceCombo->addItem("Default", "default");
+    for (const AudioBackend::Device& device : m_devices) {
+        m_inputDeviceCombo->addItem(device.description, device.name);
+    }
+    selectInputDevice(selected);
+}
+
+void SettingsDialog::selectInputDevice(const QString& device) {
+    int deviceIndex = m_inputDeviceCombo->findData(device);
+    if (deviceIndex < 0 && device != "Default" && device != "PulseAudio Default") {
+        // unplugged right now (or not listed yet); keep it selected rather
+        // than silently switching
+        m_inputDeviceCombo->addItem(device + " (not connected)", device);
+        deviceIndex = m_inputDeviceCombo->count() - 1;
+    }
+    m_inputDeviceCombo->setCurrentIndex(qMax(0, deviceIndex));
+}
+
 void SettingsDialog::loadSettings() {
     Settings& settings = Settings::instance();
     
     // Audio
-    m_inputDeviceCombo->setCurrentText(settings.inputDevice());
+    selectInputDevice(settings.inputDevice());
     int sampleRate = settings.sampleRate();
     for (int i = 0; i < m_sampleRateCombo->count(); ++i) {
         if (m_sampleRateCombo->itemData(i).toInt() == sampleRate) {
@@ -167,11 +290,52 @@ void SettingsDialog::loadSettings() {
             break;
         }
     }
+    QString quality = settings.resampleQuality();
+    for (int i = 0; i < m_resampleQualityCombo->count(); ++i) {
+        if (m_resampleQualityCombo->itemData(i).toString() == quality) {
+            m_resampleQualityCombo->setCurrentIndex(i);
+            break;
+        }
+    }
     m_noiseGateCheck->setChecked(settings.noiseGateEnabled());
+    m_noiseGateModeCombo->setEnabled(settings.noiseGateEnabled());
+    QString gateMode = settings.noiseGateMode();
+    for (int i = 0; i < m_noiseGateModeCombo->count(); ++i) {
+        if (m_noiseGateModeCombo->itemData(i).toString() == gateMode) {
+            m_noiseGateModeCombo->setCurrentIndex(i);
+            break;
+        }
+    }
+    m_vadCheck->setChecked(settings.voiceActivityDetection());
+    m_spillCheck->setChecked(settings.spillToDisk());
+    int preRoll = settings.preRollSeconds();
+    for (int i = 0; i < m_preRollCombo->count(); ++i) {
+        if (m_preRollCombo->itemData(i).toInt() == preRoll) {
+            m_preRollCombo->setCurrentIndex(i);
+            break;
+        }
+    }
+    QString backend = settings.audioBackend();
+    for (int i = 0; i < m_backendCombo->count(); ++i) {
+        if (m_backendCombo->itemData(i).toString() == backend) {
+            m_backendCombo->setCurrentIndex(i);
+            break;
+        }
+    }
+    int latency = settings.captureLatencyMs();
+    for (int i = 0; i < m_latencyCombo->count(); ++i) {
+        if (m_latencyCombo->itemData(i).toInt() == latency) {
+            m_latencyCombo->setCurrentIndex(i);
+            break;
+        }
+    }
     
     // Models
     m_defaultModelCombo->setCurrentText(settings.defaultModel());
     m_keepLoadedCheck->setChecked(settings.keepModelLoaded());
+    m_liveTranscriptionCheck->setChecked(settings.liveTranscription());
+    m_adaptiveCtxCheck->setChecked(settings.adaptiveAudioContext());
+    m_workersSpin->setValue(settings.transcriptionWorkers());
     QString lang = settings.languageOverride();
     for (int i = 0; i < m_languageCombo->count(); ++i) {
         if (m_languageCombo->itemData(i).toString() == lang) {
@@ -179,6 +343,8 @@ void SettingsDialog::loadSettings() {
             break;
         }
     }
+    m_parallelDownloadsSpin->setValue(settings.parallelDownloads());
+    m_connectionsSpin->setValue(settings.downloadConnections());
     
     // Interface
     QString theme = settings.theme();
@@ -194,6 +360,8 @@ void SettingsDialog::loadSettings() {
     // Advanced
     m_autoSaveCheck->setChecked(settings.autoSaveDrafts());
     m_logLevelCombo->setCurrentIndex(settings.logLevel());
+    m_latencyReadoutCheck->setChecked(settings.latencyReadout());
+    m_latencyLogCheck->setChecked(settings.latencyLog());
     m_modelDirEdit->setText(settings.modelDirectory());
 }
 
@@ -201,14 +369,26 @@ void SettingsDialog::saveSettings() {
     Settings& settings = Settings::instance();
     
     // Audio
-    settings.setInputDevice(m_inputDeviceCombo->currentText());
+    settings.setInputDevice(m_inputDeviceCombo->currentData().toString());
     settings.setSampleRate(m_sampleRateCombo->currentData().toInt());
+    settings.setResampleQuality(m_resampleQualityCombo->currentData().toString());
     settings.setNoiseGateEnabled(m_noiseGateCheck->isChecked());
+    settings.setNoiseGateMode(m_noiseGateModeCombo->currentData().toString());
+    settings.setVoiceActivityDetection(m_vadCheck->isChecked());
+    settings.setSpillToDisk(m_spillCheck->isChecked());
+    settings.setPreRollSeconds(m_preRollCombo->currentData().toInt());
+    settings.setAudioBackend(m_backendCombo->currentData().toString());
+    settings.setCaptureLatencyMs(m_latencyCombo->currentData().toInt());
     
     // Models
     settings.setDefaultModel(m_defaultModelCombo->currentText());
     settings.setKeepModelLoaded(m_keepLoadedCheck->isChecked());
+    settings.setLiveTranscription(m_liveTranscriptionCheck->isChecked());
+    settings.setAdaptiveAudioContext(m_adaptiveCtxCheck->isChecked());
+    settings.setTranscriptionWorkers(m_workersSpin->value());
     settings.setLanguageOverride(m_languageCombo->currentData().toString());
+    settings.setParallelDownloads(m_parallelDownloadsSpin->value());
+    settings.setDownloadConnections(m_connectionsSpin->value());
     
     // Interface
     settings.setTheme(m_themeCombo->currentData().toString());
@@ -218,6 +398,8 @@ void SettingsDialog::saveSettings() {
     // Advanced
     settings.setAutoSaveDrafts(m_autoSaveCheck->isChecked());
     settings.setLogLevel(m_logLevelCombo->currentIndex());
+    settings.setLatencyReadout(m_latencyReadoutCheck->isChecked());
+    settings.setLatencyLog(m_latencyLogCheck->isChecked());
 }
 
 void SettingsDialog::onApply() {
@@ -237,16 +419,30 @@ void SettingsDialog::onReset() {
         
         // Reset to defaults (just reload default values)
         settings.setInputDevice("default");
-        settings.setSampleRate(16000);
+        settings.setSampleRate(0);
+        settings.setResampleQuality("balanced");
         settings.setNoiseGateEnabled(false);
+        settings.setNoiseGateMode("gate");
+        settings.setVoiceActivityDetection(true);
+        settings.setSpillToDisk(false);
+        settings.setPreRollSeconds(0);
+        settings.setAudioBackend("async");
+        settings.setCaptureLatencyMs(20);
         settings.setDefaultModel("Whisper Base");
         settings.setKeepModelLoaded(true);
+        settings.setLiveTranscription(false);
+        settings.setAdaptiveAudioContext(false);
+        settings.setTranscriptionWorkers(0);
         settings.setLanguageOverride("en");
+        settings.setParallelDownloads(2);
+        settings.setDownloadConnections(1);
         settings.setTheme("dark");
         settings.setFontSize(14);
         settings.setShowConfidence(false);
         settings.setAutoSaveDrafts(false);
         settings.setLogLevel(1);
+        settings.setLatencyReadout(false);
+        settings.setLatencyLog(false);
         
         loadSettings();
         QMessageBox::information(this, "Reset Complete", "Settings have been reset to defaults.");
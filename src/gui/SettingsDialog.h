@@ -1,7 +1,10 @@
 #ifndef SETTINGSDIALOG_H
 #define SETTINGSDIALOG_H
 
+#include "../audio/AudioBackend.h"
 #include <QDialog>
+#include <thread>
+#include <vector>
 
 class QTabWidget;
 class QComboBox;
@@ -11,18 +14,24 @@ class QLineEdit;
 
 class SettingsDialog : public QDialog {
     Q_OBJECT
-
+    
 public:
     explicit SettingsDialog(QWidget* parent = nullptr);
+    ~SettingsDialog() override;
     
 private slots:
     void onApply();
     void onReset();
+    void onDevicesListed();
     
 private:
     void setupUI();
     void loadSettings();
     void saveSettings();
+    void selectInputDevice(const QString& device);
+    
+    std::thread m_deviceThread;                   // asks the sound server, fills m_devices
+    std::vector<AudioBackend::Device> m_devices;
     
     // UI components
     QTabWidget* m_tabs;
@@ -30,12 +39,24 @@ private:
     // Audio tab
     QComboBox* m_inputDeviceCombo;
     QComboBox* m_sampleRateCombo;
+    QComboBox* m_resampleQualityCombo;
     QCheckBox* m_noiseGateCheck;
+    QComboBox* m_noiseGateModeCombo;
+    QCheckBox* m_vadCheck;
+    QCheckBox* m_spillCheck;
+    QComboBox* m_preRollCombo;
+    QComboBox* m_backendCombo;
+    QComboBox* m_latencyCombo;
     
     // Model tab
     QComboBox* m_defaultModelCombo;
     QCheckBox* m_keepLoadedCheck;
+    QCheckBox* m_liveTranscriptionCheck;
+    QCheckBox* m_adaptiveCtxCheck;
+    QSpinBox* m_workersSpin;
     QComboBox* m_languageCombo;
+    QSpinBox* m_parallelDownloadsSpin;
+    QSpinBox* m_connectionsSpin;
     
     // Interface tab
     QComboBox* m_themeCombo;
@@ -45,6 +66,8 @@ private:
     // Advanced tab
     QCheckBox* m_autoSaveCheck;
     QComboBox* m_logLevelCombo;
+    QCheckBox* m_latencyReadoutCheck;
+    QCheckBox* m_latencyLogCheck;
     QLineEdit* m_modelDirEdit;
 };
 
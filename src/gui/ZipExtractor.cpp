@@ -0,0 +1,411 @@
+#include "ZipExtractor.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+ZipExtractor::ZipExtractor(const QString& archive, const QString& destination)
+    : m_archive(archive)
+    , m_destination(destination)
+    , m_input(CHUNK_BYTES)
+    , m_inputPos(0)
+    , m_inputEnd(0)
+    , m_output(CHUNK_BYTES)
+    , m_read(0)
+    , m_reported(0)
+    , m_available(0)
+    , m_complete(false)
+    , m_cancelled(false)
+    , m_localError(false) {
+}
+
+ZipExtractor::~ZipExtractor() {
+    cancel();
+    wait();
+}
+
+void ZipExtractor::setAvailable(qint64 bytes, bool complete) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_available = std::max(m_available, bytes);
+        m_complete = m_complete || complete;
+    }
+    m_more.notify_all();
+}
+
+void ZipExtractor::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+    }
+    m_more.notify_all();
+}
+
+void ZipExtractor::run() {
+    QElapsedTimer timer;
+    timer.start();
+    
+    QString error;
+    bool ok = extractAll(error) && waitForComplete() && install(error);
+    m_file.close();
+    if (!ok) {
+        QDir(stagingPath()).removeRecursively();
+        if (!m_cancelled) {
+            qWarning() << "Extracting" << m_archive << "failed:" << error;
+            emit extractFailed(error, !m_localError);
+        }
+        return;
+    }
+    
+    reportProgress(true);
+    qDebug() << "Extracted" << m_archive << "to" << m_destination << "in" << timer.elapsed() << "ms";
+    emit extracted();
+}
+
+bool ZipExtractor::extractAll(QString& error) {
+    m_file.setFileName(m_archive);
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        error = QString("Cannot read %1: %2").arg(m_archive).arg(m_file.errorString());
+        m_localError = true;
+        return false;
+    }
+    QDir staging(stagingPath());
+    staging.removeRecursively();
+    if (!staging.mkpath(".")) {
+        error = QString("Cannot create %1").arg(staging.path());
+        m_localError = true;
+        return false;
+    }
+    
+    // 1. local headers in archive order; the central directory at the end
+    //    only repeats them, so reading stops there
+    for (;;) {
+        Entry entry;
+        quint32 signature = 0;
+        if (!read(&signature, 4)) {
+            error = "The archive ends before its directory";
+            return false;
+        }
+        signature = qFromLittleEndian(signature);
+        if (signature == CENTRAL_HEADER || signature == END_OF_CENTRAL) {
+            return true;
+        }
+        if (signature != LOCAL_HEADER) {
+            error = "Not a zip archive, or a damaged one";
+            return false;
+        }
+        if (!readEntry(entry, error)) {
+            return false;
+        }
+        
+        // 1a. nothing may land outside the staging directory
+        if (!isSafePath(entry.name)) {
+            error = QString("Refusing to extract \"%1\": it points outside the model directory").arg(entry.name);
+            return false;
+        }
+        QString path = staging.filePath(QString(entry.name).replace('\\', '/'));
+        
+        if (entry.name.endsWith('/') || entry.name.endsWith('\\')) {
+            if (!QDir().mkpath(path) || !skip(entry.compressedSize)) {
+                error = QString("Cannot create %1").arg(path);
+                m_localError = true;
+                return false;
+            }
+        } else if (!extractFile(entry, path, error)) {
+            return false;
+        }
+    }
+}
+
+bool ZipExtractor::readEntry(Entry& entry, QString& error) {
+    // version, flags, method, time, date, crc, sizes, name and extra lengths
+    uchar header[26];
+    if (!read(header, sizeof(header))) {
+        error = "The archive ends in a file header";
+        return false;
+    }
+    entry.flags = qFromLittleEndian<quint16>(header + 2);
+    entry.method = qFromLittleEndian<quint16>(header + 4);
+    entry.crc = qFromLittleEndian<quint32>(header + 10);
+    entry.compressedSize = qFromLittleEndian<quint32>(header + 14);
+    entry.size = qFromLittleEndian<quint32>(header + 18);
+    quint16 nameLength = qFromLittleEndian<quint16>(header + 22);
+    quint16 extraLength = qFromLittleEndian<quint16>(header + 24);
+    entry.zip64 = false;
+    
+    QByteArray name(nameLength, '\0');
+    QByteArray extra(extraLength, '\0');
+    if (!read(name.data(), nameLength) || !read(extra.data(), extraLength)) {
+        error = "The archive ends in a file header";
+        return false;
+    }
+    // bit 11: UTF-8 names; older archivers write their code page, which is
+    // ASCII for anything a model ships
+    entry.name = entry.flags & 0x0800 ? QString::fromUtf8(name) : QString::fromLatin1(name);
+    
+    // 2a. Zip64: sizes that don't fit 32 bits are in extra field 0x0001
+    const uchar* data = reinterpret_cast<const uchar*>(extra.constData());
+    for (int at = 0; at + 4 <= extra.size();) {
+        quint16 id = qFromLittleEndian<quint16>(data + at);
+        quint16 size = qFromLittleEndian<quint16>(data + at + 2);
+        int field = at + 4;
+        if (id == 0x0001) {
+            entry.zip64 = true;
+            if (entry.size == 0xFFFFFFFF && field + 8 <= extra.size()) {
+                entry.size = qFromLittleEndian<quint64>(data + field);
+                field += 8;
+            }
+            if (entry.compressedSize == 0xFFFFFFFF && field + 8 <= extra.size()) {
+                entry.compressedSize = qFromLittleEndian<quint64>(data + field);
+            }
+        }
+        at += 4 + size;
+    }
+    
+    if (entry.flags & 0x0001) {
+        error = QString("%1 is encrypted").arg(entry.name);
+        return false;
+    }
+    if (entry.method != 0 && entry.method != 8) {
+        error = QString("%1 uses an unsupported compression method (%2)").arg(entry.name).arg(entry.method);
+        return false;
+    }
+    if (entry.method == 0 && (entry.flags & 0x0008)) {
+        // a stored entry with its size after the data can't be streamed
+        error = QString("%1 is stored without a size").arg(entry.name);
+        return false;
+    }
+    return true;
+}
+
+bool ZipExtractor::extractFile(const Entry& entry, const QString& path, QString& error) {
+    QFileInfo info(path);
+    QFile out(path);
+    if (!QDir().mkpath(info.path()) || !out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = QString("Cannot write %1: %2").arg(path).arg(out.errorString());
+        m_localError = true;
+        return false;
+    }
+    
+    uLong crc = crc32(0L, Z_NULL, 0);
+    qint64 written = 0;
+    auto emitOutput = [&](const char* data, size_t size) {
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size));
+        written += static_cast<qint64>(size);
+        return out.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+    };
+    
+    if (entry.method == 0) {
+        // 2b. stored: copied straight from the input buffer
+        qint64 left = entry.compressedSize;
+        while (left > 0) {
+            if (m_inputPos == m_inputEnd && !fill()) {
+                error = QString("The archive ends in the middle of %1").arg(entry.name);
+                return false;
+            }
+            size_t n = static_cast<size_t>(std::min<qint64>(left, m_inputEnd - m_inputPos));
+            if (!emitOutput(m_input.data() + m_inputPos, n)) {
+                error = QString("Cannot write %1: %2").arg(path).arg(out.errorString());
+                m_localError = true;
+                return false;
+            }
+            m_inputPos += n;
+            left -= static_cast<qint64>(n);
+        }
+    } else {
+        // 2c. deflated: raw inflate over the input buffer until the stream
+        //     says it is done, so the compressed size isn't needed
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            error = "Cannot start the decompressor";
+            m_localError = true;
+            return false;
+        }
+        int status = Z_OK;
+        while (status != Z_STREAM_END) {
+            if (m_inputPos == m_inputEnd && !fill()) {
+                inflateEnd(&stream);
+                error = QString("The archive ends in the middle of %1").arg(entry.name);
+                return false;
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(m_input.data() + m_inputPos);
+            stream.avail_in = static_cast<uInt>(m_inputEnd - m_inputPos);
+            stream.next_out = reinterpret_cast<Bytef*>(m_output.data());
+            stream.avail_out = static_cast<uInt>(m_output.size());
+            
+            status = inflate(&stream, Z_NO_FLUSH);
+            if (status != Z_OK && status != Z_STREAM_END) {
+                inflateEnd(&stream);
+                error = QString("%1 is damaged in the archive").arg(entry.name);
+                return false;
+            }
+            m_inputPos = m_inputEnd - stream.avail_in;
+            if (!emitOutput(m_output.data(), m_output.size() - stream.avail_out)) {
+                inflateEnd(&stream);
+                error = QString("Cannot write %1: %2").arg(path).arg(out.errorString());
+                m_localError = true;
+                return false;
+            }
+        }
+        inflateEnd(&stream);
+    }
+    
+    // 2d. sizes and CRC after the data: optional signature, CRC, then two
+    //     sizes of 4 bytes, or 8 with Zip64
+    quint32 expectedCrc = entry.crc;
+    if (entry.flags & 0x0008) {
+        quint32 first = 0;
+        if (!read(&first, 4)) {
+            error = QString("The archive ends after %1").arg(entry.name);
+            return false;
+        }
+        expectedCrc = qFromLittleEndian(first);
+        if (expectedCrc == DATA_DESCRIPTOR && !read(&expectedCrc, 4)) {
+            error = QString("The archive ends after %1").arg(entry.name);
+            return false;
+        }
+        expectedCrc = qFromLittleEndian(expectedCrc);
+        if (!skip(entry.zip64 ? 16 : 8)) {
+            error = QString("The archive ends after %1").arg(entry.name);
+            return false;
+        }
+    } else if (written != entry.size) {
+        error = QString("%1 has the wrong size in the archive").arg(entry.name);
+        return false;
+    }
+    
+    if (static_cast<quint32>(crc) != expectedCrc) {
+        error = QString("%1 is damaged in the archive (CRC mismatch)").arg(entry.name);
+        return false;
+    }
+    if (!out.flush()) {
+        error = QString("Cannot write %1: %2").arg(path).arg(out.errorString());
+        m_localError = true;
+        return false;
+    }
+    return true;
+}
+
+bool ZipExtractor::waitForComplete() {
+    // the directory can arrive before the download is through its checks;
+    // nothing is installed until the downloader says the archive is final
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_more.wait(lock, [this]() { return m_complete || m_cancelled; });
+    return !m_cancelled;
+}
+
+bool ZipExtractor::install(QString& error) {
+    // 3. a single top-level directory is the model itself; otherwise the
+    //    whole staging directory is
+    QDir staging(stagingPath());
+    QStringList entries = staging.entryList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot);
+    QString source = staging.path();
+    if (entries.size() == 1 && QFileInfo(staging.filePath(entries.first())).isDir()) {
+        source = staging.filePath(entries.first());
+    }
+    
+    // 3a. same file system, so this is a rename and not a copy
+    QDir(m_destination).removeRecursively();
+    QFile::remove(m_destination);
+    if (!QDir().rename(source, m_destination)) {
+        error = QString("Cannot move the model into %1").arg(m_destination);
+        m_localError = true;
+        return false;
+    }
+    staging.removeRecursively();
+    return true;
+}
+
+bool ZipExtractor::fill() {
+    // keep what is left, then top up to a full buffer from the file
+    if (m_inputPos > 0) {
+        std::memmove(m_input.data(), m_input.data() + m_inputPos, m_inputEnd - m_inputPos);
+        m_inputEnd -= m_inputPos;
+        m_inputPos = 0;
+    }
+    qint64 want = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_more.wait(lock, [this]() { return m_cancelled || m_complete || m_available > m_read; });
+        if (m_cancelled) {
+            return false;
+        }
+        want = std::min<qint64>(m_input.size() - m_inputEnd, m_available - m_read);
+    }
+    if (want <= 0) {
+        return false;
+    }
+    qint64 n = m_file.read(m_input.data() + m_inputEnd, want);
+    if (n <= 0) {
+        return false;
+    }
+    m_inputEnd += static_cast<size_t>(n);
+    m_read += n;
+    reportProgress(false);
+    return true;
+}
+
+bool ZipExtractor::read(void* data, qint64 size) {
+    char* target = static_cast<char*>(data);
+    while (size > 0) {
+        if (m_inputPos == m_inputEnd && !fill()) {
+            return false;
+        }
+        size_t n = static_cast<size_t>(std::min<qint64>(size, m_inputEnd - m_inputPos));
+        std::memcpy(target, m_input.data() + m_inputPos, n);
+        m_inputPos += n;
+        target += n;
+        size -= static_cast<qint64>(n);
+    }
+    return true;
+}
+
+bool ZipExtractor::skip(qint64 size) {
+    while (size > 0) {
+        if (m_inputPos == m_inputEnd && !fill()) {
+            return false;
+        }
+        size_t n = static_cast<size_t>(std::min<qint64>(size, m_inputEnd - m_inputPos));
+        m_inputPos += n;
+        size -= static_cast<qint64>(n);
+    }
+    return true;
+}
+
+void ZipExtractor::reportProgress(bool force) {
+    if (!force && m_read - m_reported < PROGRESS_STEP) {
+        return;
+    }
+    m_reported = m_read;
+    qint64 total = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_complete) {
+            total = m_available;
+        }
+    }
+    emit extractProgress(m_read, total);
+}
+
+QString ZipExtractor::stagingPath() const {
+    QFileInfo info(m_destination);
+    return info.dir().filePath("." + info.fileName() + ".extracting");
+}
+
+bool ZipExtractor::isSafePath(const QString& name) {
+    // absolute, or a Windows drive
+    if (name.isEmpty() || name.startsWith('/') || name.startsWith('\\') || name.contains(':')) {
+        return false;
+    }
+    for (const QString& part : QString(name).replace('\\', '/').split('/')) {
+        if (part == "..") {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef ZIPEXTRACTOR_H
+#define ZIPEXTRACTOR_H
+
+#include <QFile>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+// Unpacks a zip archive (Vosk models) on its own thread with zlib, no
+// external unzip. The archive is read front to back through its local
+// headers, so it can be extracted while it is still downloading: the
+// downloader reports how much is on disk with setAvailable() and the
+// extractor waits whenever it catches up. Installing a model then takes
+// about as long as the download.
+//
+// Entries go to a hidden staging directory next to the destination and
+// the result is renamed into place only once the archive is complete and
+// every entry's CRC matched. Entry names that are absolute or climb out
+// with ".." fail the whole archive. Stored and deflated entries are
+// supported, including Zip64 sizes and trailing data descriptors.
+class ZipExtractor : public QThread {
+    Q_OBJECT
+    
+public:
+    // `destination` is replaced if it exists. An archive with a single
+    // top-level directory has that directory installed as `destination`.
+    ZipExtractor(const QString& archive, const QString& destination);
+    ~ZipExtractor() override;
+    
+    // The first `bytes` of the archive are on disk; `complete` once no
+    // more will come. Call with complete = true for a finished archive.
+    void setAvailable(qint64 bytes, bool complete);
+    
+    // Stops at the next chunk and removes what was extracted. No signal
+    // is emitted afterwards.
+    void cancel();
+    
+    QString archive() const { return m_archive; }
+    QString destination() const { return m_destination; }
+    
+protected:
+    void run() override;
+    
+signals:
+    void extractProgress(qint64 read, qint64 total);   // archive bytes; total -1 while growing
+    void extracted();
+    void extractFailed(const QString& error, bool archiveDamaged);   // else a local read/write failed
+    
+private:
+    struct Entry {
+        QString name;
+        quint16 flags;
+        quint16 method;
+        quint32 crc;
+        qint64 compressedSize;
+        qint64 size;
+        bool zip64;
+    };
+    
+    bool extractAll(QString& error);
+    bool readEntry(Entry& entry, QString& error);
+    bool extractFile(const Entry& entry, const QString& path, QString& error);
+    bool install(QString& error);
+    bool waitForComplete();
+    
+    bool fill();
+    bool read(void* data, qint64 size);
+    bool skip(qint64 size);
+    void reportProgress(bool force);
+    
+    QString stagingPath() const;
+    static bool isSafePath(const QString& name);
+    
+    QString m_archive;
+    QString m_destination;
+    QFile m_file;
+    std::vector<char> m_input;     // archive bytes read but not consumed
+    size_t m_inputPos;
+    size_t m_inputEnd;
+    std::vector<char> m_output;    // one inflate step's output
+    qint64 m_read;                 // archive bytes read from the file
+    qint64 m_reported;
+    
+    std::mutex m_mutex;
+    std::condition_variable m_more;
+    qint64 m_available;            // guarded by m_mutex
+    bool m_complete;               // guarded by m_mutex
+    std::atomic<bool> m_cancelled;
+    bool m_localError;             // failed on our side, not in the archive's data
+    
+    static constexpr size_t CHUNK_BYTES = 256 * 1024;
+    static constexpr qint64 PROGRESS_STEP = 4 * 1024 * 1024;
+    static constexpr quint32 LOCAL_HEADER = 0x04034b50;
+    static constexpr quint32 CENTRAL_HEADER = 0x02014b50;
+    static constexpr quint32 END_OF_CENTRAL = 0x06054b50;
+    static constexpr quint32 DATA_DESCRIPTOR = 0x08074b50;
+};
+
+#endif // ZIPEXTRACTOR_H
@@ -1,9 +1,46 @@
 #include <QApplication>
 #include "MainWindow.h"
+#include "utils/StartupTimer.h"
 #include <QStyleFactory>
 #include <QFile>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    // The batch CLI is built into speech-transcribe only, so --batch
+    // replaces this process with it: the copy next to this binary if
+    // there is one, else whichever is on the PATH
+    int execBatchTranscriber(char* argv[]) {
+        char self[PATH_MAX];
+        ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+        if (n > 0) {
+            self[n] = '\0';
+            std::string sibling(self);
+            sibling = sibling.substr(0, sibling.rfind('/') + 1) + "speech-transcribe";
+            execv(sibling.c_str(), argv);
+        }
+        execvp("speech-transcribe", argv);
+        
+        fprintf(stderr, "--batch: cannot run speech-transcribe: %s\n", strerror(errno));
+        return 1;
+    }
+}
 
 int main(int argc, char *argv[]) {
+    // 0. startup milestones are measured from here
+    StartupTimer::start();
+    
+    // 0a. --batch runs headless, before anything touches the display
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--batch") == 0) {
+            return execBatchTranscriber(argv);
+        }
+    }
+    
     QApplication app(argc, argv);
     
     // 1a. set app metadata
@@ -0,0 +1,114 @@
+#include "ModelCache.h"
+#include "../utils/SystemInfo.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDebug>
+
+ModelCache::Entry ModelCache::find(const QString& modelPath) {
+    auto it = m_entries.find(modelPath);
+    if (it == m_entries.end()) {
+        return {};
+    }
+    
+    // move to front of the LRU list
+    m_lru.removeAll(modelPath);
+    m_lru.prepend(modelPath);
+    return it->entry;
+}
+
+void ModelCache::insert(const QString& modelPath, const Entry& entry) {
+    if (!entry.isValid()) {
+        return;
+    }
+    
+    m_entries.insert(modelPath, {entry, estimateModelMB(modelPath)});
+    m_lru.removeAll(modelPath);
+    m_lru.prepend(modelPath);
+    
+    enforceBudget(modelPath);
+}
+
+void ModelCache::remove(const QString& modelPath) {
+    m_entries.remove(modelPath);
+    m_lru.removeAll(modelPath);
+}
+
+void ModelCache::clear() {
+    m_entries.clear();
+    m_lru.clear();
+}
+
+void ModelCache::pruneMissing() {
+    const QStringList paths = m_lru;
+    for (const QString& path : paths) {
+        if (!QFileInfo::exists(path)) {
+            remove(path);
+        }
+    }
+}
+
+void ModelCache::setKeepModelsLoaded(bool keep) {
+    m_keepLoaded = keep;
+    if (!m_lru.isEmpty()) {
+        enforceBudget(m_lru.first());
+    }
+}
+
+qint64 ModelCache::cachedMB() const {
+    qint64 total = 0;
+    for (const CachedModel& model : m_entries) {
+        total += model.sizeMB;
+    }
+    return total;
+}
+
+qint64 ModelCache::budgetMB() const {
+    // 1a. allow the cache at most half of what would be free without it
+    qint64 available = SystemInfo::getAvailableRAM();
+    if (available < 0) {
+        return 0; // can't tell, only keep the active model
+    }
+    return (available + cachedMB()) / 2;
+}
+
+void ModelCache::enforceBudget(const QString& keepPath) {
+    // 2a. evict from the back of the LRU list until we fit
+    while (m_lru.size() > 1) {
+        bool overBudget = !m_keepLoaded || cachedMB() > budgetMB();
+        if (!overBudget) {
+            break;
+        }
+        
+        QString victim = m_lru.last();
+        if (victim == keepPath) {
+            break;
+        }
+        
+        qDebug() << "Model cache: evicting" << victim
+                 << "(" << m_entries.value(victim).sizeMB << "MB )";
+        
+        // in-flight transcriptions hold their own reference, so the model
+        // is actually freed once they finish
+        remove(victim);
+    }
+}
+
+qint64 ModelCache::estimateModelMB(const QString& modelPath) {
+    QFileInfo info(modelPath);
+    qint64 bytes = 0;
+    
+    if (info.isFile()) {
+        bytes = info.size();
+    } else if (info.isDir()) {
+        // Vosk models are directories
+        QDirIterator it(modelPath, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            bytes += it.fileInfo().size();
+        }
+    }
+    
+    qint64 mb = bytes / (1024 * 1024);
+    return mb + mb * LOAD_OVERHEAD_PERCENT / 100;
+}
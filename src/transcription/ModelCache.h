@@ -0,0 +1,60 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <memory>
+
+class TranscriptionEngine;
+
+// Keeps recently used models in memory so switching back to one is instant.
+// Keyed by model path, evicted least-recently-used first once the cache
+// would take more than its share of system RAM.
+class ModelCache {
+public:
+    struct Entry {
+        std::shared_ptr<TranscriptionEngine> engine;
+        
+        bool isValid() const { return engine != nullptr; }
+    };
+    
+    // Returns an empty entry on a miss. A hit becomes most recently used.
+    Entry find(const QString& modelPath);
+    
+    // Adds a freshly loaded model and evicts others until within budget.
+    // The model just inserted is never evicted.
+    void insert(const QString& modelPath, const Entry& entry);
+    
+    void remove(const QString& modelPath);
+    void clear();
+    
+    // Drop entries whose model was deleted from disk
+    void pruneMissing();
+    
+    // false = hold only the active model (Settings::keepModelLoaded)
+    void setKeepModelsLoaded(bool keep);
+    
+    int count() const { return m_entries.size(); }
+    qint64 cachedMB() const;
+    
+    // Rough resident size of a model once loaded
+    static qint64 estimateModelMB(const QString& modelPath);
+    
+private:
+    void enforceBudget(const QString& keepPath);
+    qint64 budgetMB() const;
+    
+    struct CachedModel {
+        Entry entry;
+        qint64 sizeMB;
+    };
+    
+    QMap<QString, CachedModel> m_entries;
+    QStringList m_lru;               // front = most recently used
+    bool m_keepLoaded = true;
+    
+    static constexpr int LOAD_OVERHEAD_PERCENT = 20;   // compute buffers, KV cache
+};
+
+#endif // MODELCACHE_H
@@ -0,0 +1,59 @@
+#include "ModelLoader.h"
+#include "VoskEngine.h"
+#include "../WhisperTranscriber.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <stdexcept>
+
+ModelLoader::ModelLoader(const QString& modelName, const QString& modelPath)
+    : m_modelName(modelName)
+    , m_modelPath(modelPath)
+    , m_cancelled(false) {
+}
+
+ModelCache::Entry ModelLoader::takeResult() {
+    ModelCache::Entry result = m_result;
+    m_result = {};
+    return result;
+}
+
+void ModelLoader::cancel() {
+    m_cancelled = true;
+}
+
+void ModelLoader::run() {
+    QElapsedTimer timer;
+    timer.start();
+    
+    try {
+        if (m_modelName.startsWith("Vosk")) {
+            // vosk_model_new has no progress hook
+            emit loadProgress(-1);
+            auto vosk = std::make_shared<VoskEngine>(m_modelPath.toStdString());
+            if (!vosk->isModelLoaded()) {
+                throw std::runtime_error("Vosk model not found. Download from Tools > Manage Models.");
+            }
+            m_result = {vosk};
+        } else {
+            // 1a. only signal whole-percent steps, reads come in small pieces
+            int lastPercent = -1;
+            auto progress = [this, &lastPercent](float fraction) {
+                int percent = static_cast<int>(fraction * 100.0f);
+                if (percent != lastPercent) {
+                    lastPercent = percent;
+                    emit loadProgress(percent);
+                }
+                return !m_cancelled.load();
+            };
+            m_result = {std::make_shared<WhisperTranscriber>(m_modelPath, progress)};
+        }
+    } catch (const std::exception& e) {
+        if (!m_cancelled) {
+            emit loadFailed(QString::fromStdString(e.what()));
+        }
+        return;
+    }
+    
+    qDebug() << "Model" << m_modelName << "loaded in" << timer.elapsed() << "ms";
+    emit modelLoaded();
+}
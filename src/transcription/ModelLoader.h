@@ -0,0 +1,42 @@
+#ifndef MODELLOADER_H
+#define MODELLOADER_H
+
+#include "ModelCache.h"
+#include <QThread>
+#include <QString>
+#include <atomic>
+
+// Loads a Whisper or Vosk model off the GUI thread. Emits loadProgress while
+// reading the file (-1 when the engine can't report it) and then either
+// modelLoaded or loadFailed. The result is picked up with takeResult().
+class ModelLoader : public QThread {
+    Q_OBJECT
+    
+public:
+    ModelLoader(const QString& modelName, const QString& modelPath);
+    
+    QString modelName() const { return m_modelName; }
+    QString modelPath() const { return m_modelPath; }
+    
+    // Only valid after modelLoaded was emitted
+    ModelCache::Entry takeResult();
+    
+    // Stops a Whisper load at the next read; Vosk loads run to completion
+    void cancel();
+    
+protected:
+    void run() override;
+    
+signals:
+    void loadProgress(int percent);
+    void modelLoaded();
+    void loadFailed(const QString& error);
+    
+private:
+    QString m_modelName;
+    QString m_modelPath;
+    ModelCache::Entry m_result;
+    std::atomic<bool> m_cancelled;
+};
+
+#endif // MODELLOADER_H
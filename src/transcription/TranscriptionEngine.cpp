@@ -0,0 +1,126 @@
+#include "TranscriptionEngine.h"
+#include <QDebug>
+#include <algorithm>
+#include <stdexcept>
+
+std::string TranscriptionEngine::transcribe(const std::vector<int16_t>& audioData) {
+    std::vector<Segment> segments = transcribeSegments(audioData);
+    return joinSegments(segments, 0, segments.size());
+}
+
+std::unique_ptr<TranscriptionEngine::Workspace> TranscriptionEngine::createWorkspace() {
+    return std::make_unique<Workspace>();
+}
+
+std::vector<TranscriptionEngine::Segment> TranscriptionEngine::transcribeWith(
+        const AudioBuffer& audio, Workspace& workspace) {
+    if (workspace.cancelRequested) {
+        return {};
+    }
+    return transcribeSegments(std::vector<int16_t>(audio.samples(), audio.samples() + audio.size()));
+}
+
+namespace {
+    // Where a packed batch's samples came from
+    struct Piece {
+        size_t packedBegin;
+        AudioBuffer::Span source;
+    };
+    
+    int64_t toOriginalMs(int64_t packedMs, const std::vector<Piece>& pieces, bool isEnd) {
+        const int rate = AudioBuffer::SAMPLE_RATE;
+        size_t sample = static_cast<size_t>(std::max<int64_t>(0, packedMs)) * rate / 1000;
+        
+        // an end exactly on a seam belongs to the piece before it
+        size_t index = 0;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            if (isEnd ? pieces[i].packedBegin < sample : pieces[i].packedBegin <= sample) {
+                index = i;
+            }
+        }
+        
+        const Piece& piece = pieces[index];
+        size_t original = std::min(piece.source.begin + (sample - std::min(sample, piece.packedBegin)),
+                                   piece.source.end);
+        return static_cast<int64_t>(original) * 1000 / rate;
+    }
+}
+
+std::vector<TranscriptionEngine::Segment> TranscriptionEngine::transcribeSpeech(
+        const AudioBuffer& audio, Workspace& workspace) {
+    const AudioBuffer::SpeechSpans& speech = audio.speechSpans();
+    
+    // 1a. not analysed, or not enough silence to be worth packing
+    if (!speech || audio.speechSamples() >= audio.size() * (1.0 - SPEECH_SKIP_MIN)) {
+        return transcribeWith(audio, workspace);
+    }
+    if (speech->empty()) {
+        qDebug() << "No speech detected, nothing to transcribe";
+        return {};
+    }
+    
+    qDebug() << "VAD: decoding" << audio.speechSamples() / AudioBuffer::SAMPLE_RATE << "of"
+             << audio.size() / AudioBuffer::SAMPLE_RATE << "seconds";
+    
+    std::vector<Segment> result;
+    const float* floats = audio.floatSamples();
+    size_t next = 0;
+    
+    while (next < speech->size() && !workspace.cancelRequested) {
+        // 1b. pack spans until the batch is full; an oversized span goes alone
+        std::vector<Piece> pieces;
+        std::vector<int16_t> packed;
+        std::vector<float> packedFloats;
+        while (next < speech->size()) {
+            const AudioBuffer::Span& span = (*speech)[next];
+            const size_t length = span.end - span.begin;
+            if (!packed.empty() && packed.size() + length > SPEECH_BATCH_SAMPLES) {
+                break;
+            }
+            
+            pieces.push_back({packed.size(), span});
+            packed.insert(packed.end(), audio.samples() + span.begin, audio.samples() + span.end);
+            if (floats) {
+                packedFloats.insert(packedFloats.end(), floats + span.begin, floats + span.end);
+            }
+            ++next;
+        }
+        
+        // 1c. decode and move the timestamps back to where the speech was
+        AudioBuffer::Ptr batch = AudioBuffer::create(std::move(packed), std::move(packedFloats));
+        for (Segment& segment : transcribeWith(*batch, workspace)) {
+            segment.startMs = toOriginalMs(segment.startMs, pieces, false);
+            segment.endMs = std::max(segment.startMs, toOriginalMs(segment.endMs, pieces, true));
+            result.push_back(std::move(segment));
+        }
+    }
+    return result;
+}
+
+std::unique_ptr<TranscriptionEngine::Stream> TranscriptionEngine::beginStream() {
+    throw std::logic_error(name().toStdString() + " does not support streaming");
+}
+
+TranscriptionEngine::StreamUpdate TranscriptionEngine::feedStream(Stream&, const int16_t*, size_t) {
+    throw std::logic_error(name().toStdString() + " does not support streaming");
+}
+
+TranscriptionEngine::StreamUpdate TranscriptionEngine::finishStream(Stream&, const int16_t*, size_t) {
+    throw std::logic_error(name().toStdString() + " does not support streaming");
+}
+
+std::string TranscriptionEngine::joinSegments(const std::vector<Segment>& segments,
+                                              size_t begin, size_t end) {
+    std::string transcription;
+    for (size_t i = begin; i < end; ++i) {
+        transcription += segments[i].text;
+        transcription += " ";
+    }
+    
+    // trim trailing space
+    if (!transcription.empty() && transcription.back() == ' ') {
+        transcription.pop_back();
+    }
+    
+    return transcription;
+}
@@ -0,0 +1,95 @@
+#ifndef TRANSCRIPTIONENGINE_H
+#define TRANSCRIPTIONENGINE_H
+
+#include "audio/AudioBuffer.h"
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Common interface of the speech engines (Whisper, Vosk). Implementations
+// are called from worker threads only, never from the GUI thread, and must
+// serialize access to their model themselves.
+class TranscriptionEngine {
+public:
+    struct Capabilities {
+        bool streaming = false;      // beginStream/feedStream/finishStream work
+        bool incremental = false;    // streaming costs no more than a batch decode
+        bool timestamps = false;     // Segment start/end are meaningful
+        bool confidences = false;    // Segment confidence is meaningful
+    };
+    
+    struct Segment {
+        std::string text;
+        int64_t startMs;
+        int64_t endMs;
+        float confidence;   // mean token probability, 0..1
+    };
+    
+    // Result of feeding live audio: text that will no longer change, plus the
+    // current (unstable) hypothesis for the audio after it
+    struct StreamUpdate {
+        bool updated = false;
+        std::string committed;
+        std::string partial;
+    };
+    
+    // Per-worker decoding state (a whisper_state, a Vosk recognizer) so
+    // concurrent jobs never share one. Must not outlive its engine.
+    class Workspace {
+    public:
+        virtual ~Workspace() = default;
+        
+        int threads = 0;                              // CPU threads to use, 0 = engine default
+        std::atomic<bool> cancelRequested{false};     // polled while decoding
+    };
+    
+    // Per-recording streaming state (uncommitted audio, a Vosk recognizer),
+    // so a stream still decoding its tail never shares state with the next
+    // one. Must not outlive its engine.
+    class Stream {
+    public:
+        virtual ~Stream() = default;
+    };
+    
+    virtual ~TranscriptionEngine() = default;
+    
+    virtual QString name() const = 0;
+    virtual Capabilities capabilities() const = 0;
+    virtual bool isModelLoaded() const = 0;
+    
+    // Whole-buffer transcription of 16 kHz mono audio
+    virtual std::string transcribe(const std::vector<int16_t>& audioData);
+    virtual std::vector<Segment> transcribeSegments(const std::vector<int16_t>& audioData) = 0;
+    
+    // Same, decoding in the caller's workspace. The default workspace
+    // carries no state and transcribeWith falls back to transcribeSegments.
+    // The buffer is shared, not copied: it may be a mapped DiskRecording,
+    // and engines that take float use its capture-time float view.
+    virtual std::unique_ptr<Workspace> createWorkspace();
+    virtual std::vector<Segment> transcribeWith(const AudioBuffer& audio, Workspace& workspace);
+    
+    // transcribeWith() on the buffer's speech spans only, when VAD marked
+    // any: the spans are packed back to back (in batches, so memory stays
+    // bounded for long recordings) and the segment timestamps are mapped
+    // back onto the original timeline. Audio with no spans is decoded whole.
+    std::vector<Segment> transcribeSpeech(const AudioBuffer& audio, Workspace& workspace);
+    
+    // Streaming mode, only if capabilities().streaming. Each recording
+    // gets its own Stream from beginStream(). The default implementations
+    // throw.
+    virtual std::unique_ptr<Stream> beginStream();
+    virtual StreamUpdate feedStream(Stream& stream, const int16_t* samples, size_t count);
+    virtual StreamUpdate finishStream(Stream& stream, const int16_t* samples, size_t count);
+    
+    static std::string joinSegments(const std::vector<Segment>& segments,
+                                    size_t begin, size_t end);
+    
+private:
+    static constexpr double SPEECH_SKIP_MIN = 0.1;   // skip less silence than this: decode whole
+    static constexpr size_t SPEECH_BATCH_SAMPLES = AudioBuffer::SAMPLE_RATE * 600;   // 10 min
+};
+
+#endif // TRANSCRIPTIONENGINE_H
@@ -0,0 +1,288 @@
+#include "TranscriptionScheduler.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <algorithm>
+
+TranscriptionScheduler::TranscriptionScheduler(int workers, int maxQueued, QObject* parent)
+    : QObject(parent)
+    , m_nextId(1)
+    , m_nextDelivery(1)
+    , m_maxQueued(std::max(1, maxQueued))
+    , m_stopping(false)
+    , m_totalWaitMs(0.0)
+    , m_totalRunMs(0.0)
+    , m_started(0)
+    , m_ran(0) {
+    
+    if (workers <= 0) {
+        workers = defaultWorkerCount();
+    }
+    
+    // split the cores between workers so the pool never oversubscribes
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    m_threadsPerWorker = std::max(1, cores / workers);
+    
+    m_slots.resize(workers);
+    for (int i = 0; i < workers; ++i) {
+        m_workers.emplace_back(&TranscriptionScheduler::workerLoop, this, static_cast<size_t>(i));
+    }
+    
+    qDebug() << "Transcription scheduler:" << workers << "workers x"
+             << m_threadsPerWorker << "threads, queue limit" << m_maxQueued;
+}
+
+TranscriptionScheduler::~TranscriptionScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+        for (WorkerSlot& slot : m_slots) {
+            if (slot.workspace) {
+                slot.workspace->cancelRequested = true;
+            }
+        }
+    }
+    m_cond.notify_all();
+    
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+int TranscriptionScheduler::defaultWorkerCount() {
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    return std::max(1, std::min(MAX_WORKERS, cores / THREADS_PER_WORKER));
+}
+
+quint64 TranscriptionScheduler::submit(std::shared_ptr<TranscriptionEngine> engine,
+                                       AudioBuffer::Ptr audio, Priority priority,
+                                       std::shared_ptr<LatencyTrace> trace) {
+    Job job{0, std::move(engine), std::move(audio), Clock::now(), std::move(trace)};
+    quint64 id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        // 1a. backpressure: refuse instead of queueing without bound
+        if (static_cast<int>(m_queue.size()) >= m_maxQueued) {
+            m_metrics.rejected++;
+            qWarning() << "Transcription queue full, rejecting job";
+            return 0;
+        }
+        
+        id = m_nextId++;
+        job.id = id;
+        m_queue.emplace(QueueKey(-priority, id), std::move(job));
+        m_metrics.peakQueued = std::max(m_metrics.peakQueued, static_cast<int>(m_queue.size()));
+    }
+    
+    m_cond.notify_one();
+    notifyDepth();
+    return id;
+}
+
+bool TranscriptionScheduler::cancel(quint64 jobId) {
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        // 2a. still queued: drop it and free its delivery slot
+        for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+            if (it->second.id == jobId) {
+                m_queue.erase(it);
+                m_done[jobId] = {Result::Cancelled, QString(), {}};
+                found = true;
+                break;
+            }
+        }
+        
+        // 2b. running: ask the engine to stop, result is discarded
+        for (WorkerSlot& slot : m_slots) {
+            if (!found && slot.jobId == jobId) {
+                m_cancelledRunning.insert(jobId);
+                if (slot.workspace) {
+                    slot.workspace->cancelRequested = true;
+                }
+                found = true;
+            }
+        }
+    }
+    
+    if (found) {
+        notifyDepth();
+        deliverResults();
+    }
+    return found;
+}
+
+void TranscriptionScheduler::cancelAll() {
+    std::vector<quint64> ids;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_queue) {
+            ids.push_back(entry.second.id);
+        }
+        for (const WorkerSlot& slot : m_slots) {
+            if (slot.jobId != 0) {
+                ids.push_back(slot.jobId);
+            }
+        }
+    }
+    
+    for (quint64 id : ids) {
+        cancel(id);
+    }
+}
+
+void TranscriptionScheduler::setThreadsPerWorker(int threads) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threadsPerWorker = std::max(1, threads);
+}
+
+int TranscriptionScheduler::threadsPerWorker() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_threadsPerWorker;
+}
+
+bool TranscriptionScheduler::isFull() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(m_queue.size()) >= m_maxQueued;
+}
+
+TranscriptionScheduler::Metrics TranscriptionScheduler::metrics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Metrics metrics = m_metrics;
+    metrics.queued = static_cast<int>(m_queue.size());
+    metrics.running = static_cast<int>(std::count_if(m_slots.begin(), m_slots.end(),
+        [](const WorkerSlot& slot) { return slot.jobId != 0; }));
+    return metrics;
+}
+
+void TranscriptionScheduler::notifyDepth() {
+    int queued;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        queued = static_cast<int>(m_queue.size());
+    }
+    emit queueDepthChanged(queued, queued >= m_maxQueued);
+}
+
+void TranscriptionScheduler::workerLoop(size_t index) {
+    // the workspace is only valid together with the engine that made it,
+    // so the engine is declared first and destroyed last
+    std::shared_ptr<TranscriptionEngine> engine;
+    std::unique_ptr<TranscriptionEngine::Workspace> workspace;
+    
+    for (;;) {
+        Job job;
+        
+        // 3a. take the highest-priority job
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) {
+                break;
+            }
+            
+            job = std::move(m_queue.begin()->second);
+            m_queue.erase(m_queue.begin());
+            m_slots[index].jobId = job.id;
+            
+            double waitMs = std::chrono::duration<double, std::milli>(Clock::now() - job.submitted).count();
+            m_started++;
+            m_totalWaitMs += waitMs;
+            m_metrics.meanWaitMs = m_totalWaitMs / m_started;
+            m_metrics.maxWaitMs = std::max(m_metrics.maxWaitMs, waitMs);
+            if (job.trace) {
+                job.trace->add("queue", waitMs);
+            }
+        }
+        notifyDepth();
+        
+        Clock::time_point start = Clock::now();
+        Result result{Result::Finished, QString(), {}};
+        
+        try {
+            // 3b. workspace per engine, reused for back-to-back jobs
+            if (job.engine != engine || !workspace) {
+                workspace.reset();
+                engine = job.engine;
+                workspace = engine->createWorkspace();
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                workspace->threads = m_threadsPerWorker;
+                workspace->cancelRequested = m_cancelledRunning.count(job.id) > 0;
+                m_slots[index].workspace = workspace.get();
+            }
+            
+            // 3c. decode without holding the scheduler lock
+            LatencyTrace::Scope traceScope(job.trace.get());
+            LatencyTrace::StageTimer timer("transcribe");
+            result.segments = engine->transcribeSpeech(*job.audio, *workspace);
+            result.text = QString::fromStdString(
+                TranscriptionEngine::joinSegments(result.segments, 0, result.segments.size())).trimmed();
+        } catch (const std::exception& e) {
+            result = {Result::Failed, QString("Transcription failed: %1").arg(e.what()), {}};
+        }
+        
+        double runMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        bool idle = false;
+        
+        // 3d. park the result until every earlier job has been delivered
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_cancelledRunning.erase(job.id) > 0 || m_stopping) {
+                result = {Result::Cancelled, QString(), {}};
+            }
+            m_done[job.id] = std::move(result);
+            m_slots[index] = WorkerSlot();
+            
+            m_ran++;
+            m_totalRunMs += runMs;
+            m_metrics.meanRunMs = m_totalRunMs / m_ran;
+            idle = m_queue.empty();
+        }
+        
+        qDebug() << "Transcription job" << job.id << "ran" << runMs << "ms on worker" << index;
+        QMetaObject::invokeMethod(this, "deliverResults", Qt::QueuedConnection);
+        
+        // 3e. nothing else to do: let go of the model so the cache can evict it
+        if (idle) {
+            workspace.reset();
+            engine.reset();
+        }
+    }
+    
+    workspace.reset();
+}
+
+void TranscriptionScheduler::deliverResults() {
+    // one at a time, so a slot connected to our signals may call back in
+    for (;;) {
+        quint64 id;
+        Result result;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_done.find(m_nextDelivery);
+            if (it == m_done.end()) {
+                return;
+            }
+            id = it->first;
+            result = std::move(it->second);
+            m_done.erase(it);
+            m_nextDelivery++;
+            
+            switch (result.status) {
+                case Result::Finished:  m_metrics.completed++; break;
+                case Result::Failed:    m_metrics.failed++; break;
+                case Result::Cancelled: m_metrics.cancelled++; break;
+            }
+        }
+        
+        if (result.status == Result::Finished) {
+            emit jobFinished(id, result.text, result.segments);
+        } else if (result.status == Result::Failed) {
+            emit jobFailed(id, result.text);
+        }
+    }
+}
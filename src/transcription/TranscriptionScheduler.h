@@ -0,0 +1,139 @@
+#ifndef TRANSCRIPTIONSCHEDULER_H
+#define TRANSCRIPTIONSCHEDULER_H
+
+#include "TranscriptionEngine.h"
+#include "audio/AudioBuffer.h"
+#include "utils/LatencyTrace.h"
+#include <QObject>
+#include <QString>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// Runs whole-buffer transcriptions on a fixed pool of worker threads. Each
+// worker decodes in its own engine Workspace (its own whisper_state), so
+// jobs never share decoder state and the pool size bounds CPU use.
+//
+// Jobs start in priority order (FIFO within a priority); results are always
+// delivered in submission order on the scheduler's thread. The queue is
+// bounded: submit() refuses new jobs while it is full.
+class TranscriptionScheduler : public QObject {
+    Q_OBJECT
+    
+public:
+    static constexpr int DEFAULT_MAX_QUEUED = 8;
+    
+    using Segments = std::vector<TranscriptionEngine::Segment>;
+    
+    enum Priority {
+        Low = 0,
+        Normal = 1,
+        High = 2
+    };
+    
+    struct Metrics {
+        int queued = 0;
+        int running = 0;
+        int peakQueued = 0;
+        quint64 completed = 0;
+        quint64 failed = 0;
+        quint64 cancelled = 0;
+        quint64 rejected = 0;
+        double meanWaitMs = 0.0;    // submit -> start
+        double maxWaitMs = 0.0;
+        double meanRunMs = 0.0;     // start -> done
+    };
+    
+    // workers = 0 picks a count from the number of cores
+    explicit TranscriptionScheduler(int workers = 0, int maxQueued = DEFAULT_MAX_QUEUED,
+                                    QObject* parent = nullptr);
+    ~TranscriptionScheduler() override;
+    
+    // Returns the job id, or 0 if the queue is full. The job holds a
+    // reference to the audio, never a copy. A trace, if given, collects the
+    // queue wait and the engine's stages.
+    quint64 submit(std::shared_ptr<TranscriptionEngine> engine,
+                   AudioBuffer::Ptr audio, Priority priority = Normal,
+                   std::shared_ptr<LatencyTrace> trace = nullptr);
+    
+    // A queued job is dropped; a running one is aborted at the engine's next
+    // check. Either way no result is delivered for it.
+    bool cancel(quint64 jobId);
+    void cancelAll();
+    
+    bool isFull() const;
+    int workerCount() const { return static_cast<int>(m_workers.size()); }
+    
+    // CPU threads each job may use. Defaults to cores / workers; applies
+    // to jobs started after the call.
+    void setThreadsPerWorker(int threads);
+    int threadsPerWorker() const;
+    Metrics metrics() const;
+    
+    static int defaultWorkerCount();
+    
+signals:
+    void jobFinished(quint64 jobId, const QString& text, const TranscriptionScheduler::Segments& segments);
+    void jobFailed(quint64 jobId, const QString& error);
+    void queueDepthChanged(int queued, bool full);
+    
+private slots:
+    void deliverResults();
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Job {
+        quint64 id;
+        std::shared_ptr<TranscriptionEngine> engine;
+        AudioBuffer::Ptr audio;
+        Clock::time_point submitted;
+        std::shared_ptr<LatencyTrace> trace;
+    };
+    
+    struct Result {
+        enum Status { Finished, Failed, Cancelled } status;
+        QString text;
+        Segments segments;
+    };
+    
+    struct WorkerSlot {
+        quint64 jobId = 0;
+        TranscriptionEngine::Workspace* workspace = nullptr;
+    };
+    
+    void workerLoop(size_t index);
+    void notifyDepth();
+    
+    // ordered by (-priority, id): begin() is the next job to start
+    using QueueKey = std::pair<int, quint64>;
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::map<QueueKey, Job> m_queue;
+    std::map<quint64, Result> m_done;        // waiting for earlier jobs
+    std::set<quint64> m_cancelledRunning;
+    std::vector<WorkerSlot> m_slots;
+    std::vector<std::thread> m_workers;
+    quint64 m_nextId;
+    quint64 m_nextDelivery;
+    int m_maxQueued;
+    int m_threadsPerWorker;
+    bool m_stopping;
+    
+    Metrics m_metrics;
+    double m_totalWaitMs;
+    double m_totalRunMs;
+    quint64 m_started;
+    quint64 m_ran;
+    
+    static constexpr int MAX_WORKERS = 4;
+    static constexpr int THREADS_PER_WORKER = 4;   // below this whisper slows down a lot
+};
+
+#endif // TRANSCRIPTIONSCHEDULER_H
@@ -4,6 +4,7 @@
 #include <QDir>
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
 
 // Vosk headers
 #ifdef VOSK_AVAILABLE
@@ -78,6 +79,111 @@ bool VoskEngine::loadModel(const std::string& modelPath) {
 #endif
 }
 
+TranscriptionEngine::Capabilities VoskEngine::capabilities() const {
+    Capabilities caps;
+#ifdef VOSK_AVAILABLE
+    caps.streaming = true;
+    caps.incremental = true;
+#endif
+    return caps;
+}
+
+std::vector<TranscriptionEngine::Segment> VoskEngine::transcribeSegments(
+        const std::vector<int16_t>& audioData) {
+    std::string text = transcribe(audioData);
+    if (text.empty()) {
+        return {};
+    }
+    
+    int64_t durationMs = static_cast<int64_t>(audioData.size()) * 1000 / SAMPLE_RATE;
+    return {{text, 0, durationMs, 1.0f}};
+}
+
+#ifdef VOSK_AVAILABLE
+namespace {
+    // a recognizer per scheduler worker; the model itself is shareable
+    struct VoskWorkspace : public TranscriptionEngine::Workspace {
+        VoskRecognizer* recognizer = nullptr;
+        
+        ~VoskWorkspace() override {
+            if (recognizer) {
+                vosk_recognizer_free(recognizer);
+            }
+        }
+    };
+    
+    // a recognizer per recording, freed with the stream, so a new stream
+    // never pulls the recognizer from under one still finishing
+    struct VoskStream : public TranscriptionEngine::Stream {
+        VoskRecognizer* recognizer = nullptr;
+        std::string partial;   // last partial sent, to skip unchanged ones
+        
+        ~VoskStream() override {
+            if (recognizer) {
+                vosk_recognizer_free(recognizer);
+            }
+        }
+    };
+    
+    VoskStream& voskStream(TranscriptionEngine::Stream& stream) {
+        auto* voskStream = dynamic_cast<VoskStream*>(&stream);
+        if (!voskStream || !voskStream->recognizer) {
+            throw std::runtime_error("Vosk stream not started");
+        }
+        return *voskStream;
+    }
+}
+#endif
+
+std::unique_ptr<TranscriptionEngine::Workspace> VoskEngine::createWorkspace() {
+#ifdef VOSK_AVAILABLE
+    if (!m_model) {
+        throw std::runtime_error("Vosk engine not initialized - no model loaded");
+    }
+    
+    auto workspace = std::make_unique<VoskWorkspace>();
+    workspace->recognizer = vosk_recognizer_new(m_model, SAMPLE_RATE);
+    if (!workspace->recognizer) {
+        throw std::runtime_error("Failed to create Vosk recognizer");
+    }
+    return workspace;
+#else
+    return TranscriptionEngine::createWorkspace();
+#endif
+}
+
+std::vector<TranscriptionEngine::Segment> VoskEngine::transcribeWith(
+        const AudioBuffer& audio, Workspace& workspace) {
+#ifdef VOSK_AVAILABLE
+    auto* voskWorkspace = dynamic_cast<VoskWorkspace*>(&workspace);
+    if (!voskWorkspace || audio.empty()) {
+        return TranscriptionEngine::transcribeWith(audio, workspace);
+    }
+    
+    // Vosk takes int16 as captured, the float view is never needed
+    const int16_t* samples = audio.samples();
+    const size_t count = audio.size();
+    
+    // same as transcribe(), on the worker's own recognizer without locking
+    vosk_recognizer_reset(voskWorkspace->recognizer);
+    std::string text;
+    feedRecognizer(voskWorkspace->recognizer, samples, count,
+                   BATCH_CHUNK_SAMPLES, text, &workspace.cancelRequested);
+    if (workspace.cancelRequested) {
+        return {};
+    }
+    appendText(text, extractField(vosk_recognizer_final_result(voskWorkspace->recognizer), "text"));
+    
+    if (text.empty()) {
+        return {};
+    }
+    int64_t durationMs = static_cast<int64_t>(count) * 1000 / SAMPLE_RATE;
+    return {{text, 0, durationMs, 1.0f}};
+#else
+    return TranscriptionEngine::transcribeWith(audio, workspace);
+#endif
+}
+
 std::string VoskEngine::transcribe(const std::vector<int16_t>& audioData) {
 #ifdef VOSK_AVAILABLE
     if (!m_model || !m_recognizer) {
@@ -88,48 +194,131 @@ std::string VoskEngine::transcribe(const std::vector<int16_t>& audioData) {
         return "";
     }
     
+    std::lock_guard<std::mutex> lock(m_recognizerMutex);
+    
     // Reset recognizer for fresh transcription
     vosk_recognizer_reset(m_recognizer);
     
-    // Feed audio data in chunks
-    const size_t CHUNK_SIZE = 8000; // Process in 0.5 second chunks
+    // Feed audio data in chunks, keeping every utterance Vosk finalizes
+    std::string text;
+    feedRecognizer(m_recognizer, audioData.data(), audioData.size(), BATCH_CHUNK_SAMPLES, text);
+    
+    // Get final result
+    appendText(text, extractField(vosk_recognizer_final_result(m_recognizer), "text"));
+    
+    qDebug() << "Vosk transcription result:" << text.c_str();
+    return text;
+#else
+    return "Vosk transcription not available - rebuild with libvosk";
+#endif
+}
+
+std::unique_ptr<TranscriptionEngine::Stream> VoskEngine::beginStream() {
+#ifdef VOSK_AVAILABLE
+    if (!m_model) {
+        throw std::runtime_error("Vosk engine not initialized - no model loaded");
+    }
+    
+    // own recognizer so a batch decode on m_recognizer can't interfere
+    auto stream = std::make_unique<VoskStream>();
+    stream->recognizer = vosk_recognizer_new(m_model, SAMPLE_RATE);
+    if (!stream->recognizer) {
+        throw std::runtime_error("Failed to create Vosk recognizer");
+    }
+    return stream;
+#else
+    return TranscriptionEngine::beginStream();
+#endif
+}
+
+TranscriptionEngine::StreamUpdate VoskEngine::feedStream(Stream& stream, const int16_t* samples, size_t count) {
+    StreamUpdate update;
+#ifdef VOSK_AVAILABLE
+    VoskStream& state = voskStream(stream);
+    
+    // 1a. decode what arrived, utterances that ended become committed text
+    feedRecognizer(state.recognizer, samples, count, STREAM_CHUNK_SAMPLES, update.committed);
+    
+    // 1b. hypothesis for the utterance still in progress
+    update.partial = extractField(vosk_recognizer_partial_result(state.recognizer), "partial");
+    update.updated = !update.committed.empty() || update.partial != state.partial;
+    state.partial = update.partial;
+#else
+    Q_UNUSED(stream);
+    Q_UNUSED(samples);
+    Q_UNUSED(count);
+#endif
+    return update;
+}
+
+TranscriptionEngine::StreamUpdate VoskEngine::finishStream(Stream& stream, const int16_t* samples, size_t count) {
+    StreamUpdate update;
+#ifdef VOSK_AVAILABLE
+    VoskStream& state = voskStream(stream);
+    
+    // 2a. the tail is at most a few capture blocks, then flush the decoder
+    feedRecognizer(state.recognizer, samples, count, STREAM_CHUNK_SAMPLES, update.committed);
+    appendText(update.committed, extractField(vosk_recognizer_final_result(state.recognizer), "text"));
+    update.updated = true;
+#else
+    Q_UNUSED(stream);
+    Q_UNUSED(samples);
+    Q_UNUSED(count);
+#endif
+    return update;
+}
+
+void VoskEngine::feedRecognizer(VoskRecognizer* recognizer, const int16_t* samples, size_t count,
+                                size_t chunkSamples, std::string& text,
+                                const std::atomic<bool>* cancel) {
+#ifdef VOSK_AVAILABLE
     size_t offset = 0;
     
-    while (offset < audioData.size()) {
-        size_t remaining = audioData.size() - offset;
-        size_t chunkSize = std::min(remaining, CHUNK_SIZE);
+    while (offset < count && !(cancel && *cancel)) {
+        size_t chunkSize = std::min(count - offset, chunkSamples);
         
-        const char* audioPtr = reinterpret_cast<const char*>(audioData.data() + offset);
+        const char* audioPtr = reinterpret_cast<const char*>(samples + offset);
         size_t byteSize = chunkSize * sizeof(int16_t);
         
-        int result = vosk_recognizer_accept_waveform(m_recognizer, audioPtr, byteSize);
+        // 1 = end of an utterance, its result has to be collected now or it's lost
+        if (vosk_recognizer_accept_waveform(recognizer, audioPtr, byteSize) == 1) {
+            appendText(text, extractField(vosk_recognizer_result(recognizer), "text"));
+        }
         
         offset += chunkSize;
     }
-    
-    // Get final result
-    const char* resultJson = vosk_recognizer_final_result(m_recognizer);
-    
-    if (!resultJson) {
+#else
+    Q_UNUSED(recognizer);
+    Q_UNUSED(samples);
+    Q_UNUSED(count);
+    Q_UNUSED(chunkSamples);
+    Q_UNUSED(text);
+    Q_UNUSED(cancel);
+#endif
+}
+
+std::string VoskEngine::extractField(const char* json, const char* key) {
+    if (!json) {
         return "";
     }
     
-    // Parse JSON to extract text
-    // Simple parsing - look for "text" : "..."
-    std::string jsonStr(resultJson);
-    size_t textPos = jsonStr.find("\"text\" : \"");
+    // Simple parsing - look for "key" : "..."
+    std::string jsonStr(json);
+    std::string spaced = std::string("\"") + key + "\" : \"";
+    std::string compact = std::string("\"") + key + "\":\"";
     
-    if (textPos == std::string::npos) {
-        textPos = jsonStr.find("\"text\":\"");
+    size_t textPos = jsonStr.find(spaced);
+    if (textPos != std::string::npos) {
+        textPos += spaced.size();
+    } else {
+        textPos = jsonStr.find(compact);
         if (textPos != std::string::npos) {
-            textPos += 8; // length of "text":"
+            textPos += compact.size();
         }
-    } else {
-        textPos += 10; // length of "text" : "
     }
     
     if (textPos == std::string::npos) {
-        qWarning() << "Could not parse Vosk result:" << resultJson;
+        qWarning() << "Could not parse Vosk result:" << json;
         return "";
     }
     
@@ -138,13 +327,17 @@ std::string VoskEngine::transcribe(const std::vector<int16_t>& audioData) {
         return "";
     }
     
-    std::string text = jsonStr.substr(textPos, endPos - textPos);
-    
-    qDebug() << "Vosk transcription result:" << text.c_str();
-    return text;
-#else
-    return "Vosk transcription not available - rebuild with libvosk";
-#endif
+    return jsonStr.substr(textPos, endPos - textPos);
+}
+
+void VoskEngine::appendText(std::string& text, const std::string& piece) {
+    if (piece.empty()) {
+        return;
+    }
+    if (!text.empty()) {
+        text += " ";
+    }
+    text += piece;
 }
 
 bool VoskEngine::isModelLoaded() const {
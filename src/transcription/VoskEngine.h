@@ -1,36 +1,62 @@
 #ifndef VOSKENGINE_H
 #define VOSKENGINE_H
 
+#include "TranscriptionEngine.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 // Forward declaration for Vosk types
 struct VoskModel;
 struct VoskRecognizer;
 
-class VoskEngine {
+class VoskEngine : public TranscriptionEngine {
 public:
     VoskEngine();
     explicit VoskEngine(const std::string& modelPath);
-    ~VoskEngine();
+    ~VoskEngine() override;
+    
+    QString name() const override { return "Vosk"; }
+    Capabilities capabilities() const override;
     
     // Main transcription method
-    std::string transcribe(const std::vector<int16_t>& audioData);
+    std::string transcribe(const std::vector<int16_t>& audioData) override;
+    
+    // Single segment spanning the whole clip, Vosk is run without word times
+    std::vector<Segment> transcribeSegments(const std::vector<int16_t>& audioData) override;
+    
+    // Workspaces carry their own recognizer, no lock on m_recognizer
+    std::unique_ptr<Workspace> createWorkspace() override;
+    std::vector<Segment> transcribeWith(const AudioBuffer& audio, Workspace& workspace) override;
+    
+    // Streaming: audio is decoded as it arrives, each utterance Vosk
+    // finalizes becomes committed text, the one in progress is the partial
+    std::unique_ptr<Stream> beginStream() override;
+    StreamUpdate feedStream(Stream& stream, const int16_t* samples, size_t count) override;
+    StreamUpdate finishStream(Stream& stream, const int16_t* samples, size_t count) override;
     
     // Check if model is loaded
-    bool isModelLoaded() const;
+    bool isModelLoaded() const override;
     
     // Load a specific model
     bool loadModel(const std::string& modelPath);
     
 private:
     void cleanup();
+    void feedRecognizer(VoskRecognizer* recognizer, const int16_t* samples, size_t count,
+                        size_t chunkSamples, std::string& text,
+                        const std::atomic<bool>* cancel = nullptr);
+    static std::string extractField(const char* json, const char* key);
+    static void appendText(std::string& text, const std::string& piece);
     
     VoskModel* m_model;
     VoskRecognizer* m_recognizer;
+    std::mutex m_recognizerMutex;   // one recognizer, one decode at a time
     
     static constexpr int SAMPLE_RATE = 16000;
+    static constexpr size_t BATCH_CHUNK_SAMPLES = 8000;    // 0.5 s
+    static constexpr size_t STREAM_CHUNK_SAMPLES = 1600;   // 100 ms, bounds latency after stop
     static constexpr const char* DEFAULT_MODEL_PATH = "./models/vosk/vosk-model-small-en-us-0.15";
 };
 
@@ -20,11 +20,8 @@ public:
     static void showFileError(QWidget* parent, const QString& operation, const QString& filename);
     static void showMemoryWarning(QWidget* parent, int requiredMB, int availableMB);
     
-    // Diagnostic helpers
+    // Diagnostic helpers (host queries live in SystemInfo)
     static QString getPulseAudioDiagnostics();
-    static QString getSystemInfo();
-    static bool checkDiskSpace(const QString& path, qint64 requiredBytes);
-    static qint64 getAvailableRAM();
     
 private:
     ErrorHandler() = default;
@@ -1,10 +1,6 @@
 #include "FileExporter.h"
 #include <QFile>
 #include <QTextStream>
-#include <QClipboard>
-#include <QApplication>
-#include <QPrinter>
-#include <QTextDocument>
 #include <QDebug>
 
 bool FileExporter::exportToTXT(const QString& text, const QString& filepath) {
@@ -46,43 +42,6 @@ bool FileExporter::exportToDOCX(const QString& text, const QString& filepath) {
     return true;
 }
 
-bool FileExporter::exportToPDF(const QString& text, const QString& filepath) {
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(filepath);
-    printer.setPageSize(QPrinter::A4);
-    
-    // Set margins (works across Qt 5.12-5.15)
-    QMarginsF margins(15, 15, 15, 15);
-    printer.setPageMargins(margins, QPageLayout::Millimeter);
-    
-    QTextDocument document;
-    document.setDefaultFont(QFont("Arial", 12));
-    document.setPlainText(text);
-    
-    // Add a header
-    QString htmlContent = QString(
-        "<html><body>"
-        "<h2 style='text-align: center;'>Speech Transcription</h2>"
-        "<p style='font-size: 10pt; color: #666; text-align: center;'>Generated by Speech Recorder - SparklyLabz</p>"
-        "<hr>"
-        "<p style='font-size: 12pt; line-height: 1.6;'>%1</p>"
-        "</body></html>"
-    ).arg(text.toHtmlEscaped().replace("\n", "<br>"));
-    
-    document.setHtml(htmlContent);
-    document.print(&printer);
-    
-    qDebug() << "Exported to PDF:" << filepath;
-    return true;
-}
-
-void FileExporter::copyToClipboard(const QString& text) {
-    QClipboard* clipboard = QApplication::clipboard();
-    clipboard->setText(text);
-    qDebug() << "Copied" << text.length() << "characters to clipboard";
-}
-
 QString FileExporter::wrapDOCXText(const QString& text) {
     // Simple RTF format that most word processors can open
     QString rtf = "{\\rtf1\\ansi\\deff0\n";
@@ -3,13 +3,13 @@
 
 #include <QString>
 
+// Plain file exports. PDF and clipboard need a GUI session and live in
+// gui/DesktopExporter.
 class FileExporter {
 public:
     // Export functions
     static bool exportToTXT(const QString& text, const QString& filepath);
     static bool exportToDOCX(const QString& text, const QString& filepath);
-    static bool exportToPDF(const QString& text, const QString& filepath);
-    static void copyToClipboard(const QString& text);
     
 private:
     static QString wrapDOCXText(const QString& text);
@@ -0,0 +1,126 @@
+#include "LatencyTrace.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QStringList>
+#include <cstring>
+
+namespace {
+    thread_local LatencyTrace* t_current = nullptr;
+}
+
+LatencyTrace::LatencyTrace()
+    : m_created(Clock::now())
+    , m_audioMs(0.0) {
+    m_stages.reserve(8);
+}
+
+void LatencyTrace::setAudioSamples(size_t samples, int sampleRate) {
+    m_audioMs = samples * 1000.0 / sampleRate;
+}
+
+void LatencyTrace::add(const char* stage, double ms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_stages) {
+        if (strcmp(entry.first, stage) == 0) {
+            entry.second += ms;
+            return;
+        }
+    }
+    m_stages.emplace_back(stage, ms);
+}
+
+double LatencyTrace::stageMs(const char* stage) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : m_stages) {
+        if (strcmp(entry.first, stage) == 0) {
+            return entry.second;
+        }
+    }
+    return 0.0;
+}
+
+double LatencyTrace::totalMs() const {
+    return std::chrono::duration<double, std::milli>(Clock::now() - m_created).count();
+}
+
+double LatencyTrace::realTimeFactor() const {
+    return m_audioMs > 0.0 ? totalMs() / m_audioMs : 0.0;
+}
+
+QString LatencyTrace::summary() const {
+    QStringList parts;
+    parts << QString("RTF %1").arg(realTimeFactor(), 0, 'f', 2);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : m_stages) {
+        parts << QString("%1 %2 ms").arg(entry.first).arg(entry.second, 0, 'f', 0);
+    }
+    return parts.join(" | ");
+}
+
+QJsonObject LatencyTrace::toJson() const {
+    QJsonObject stages;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_stages) {
+            stages[entry.first] = entry.second;
+        }
+    }
+    
+    QJsonObject object;
+    object["time"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    object["audioMs"] = m_audioMs;
+    object["totalMs"] = totalMs();
+    object["rtf"] = realTimeFactor();
+    object["stages"] = stages;
+    return object;
+}
+
+QString LatencyTrace::latencyLogPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/latency.jsonl";
+}
+
+bool LatencyTrace::appendToLog() const {
+    QString path = latencyLogPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Compact));
+    file.write("\n");
+    return true;
+}
+
+LatencyTrace* LatencyTrace::current() {
+    return t_current;
+}
+
+LatencyTrace::Scope::Scope(LatencyTrace* trace)
+    : m_previous(t_current) {
+    t_current = trace;
+}
+
+LatencyTrace::Scope::~Scope() {
+    t_current = m_previous;
+}
+
+LatencyTrace::StageTimer::StageTimer(const char* stage)
+    : m_trace(t_current)
+    , m_stage(stage) {
+    // 1a. no trace, no clock read
+    if (m_trace) {
+        m_start = Clock::now();
+    }
+}
+
+LatencyTrace::StageTimer::~StageTimer() {
+    if (m_trace) {
+        m_trace->add(m_stage, std::chrono::duration<double, std::milli>(Clock::now() - m_start).count());
+    }
+}
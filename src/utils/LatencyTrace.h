@@ -0,0 +1,77 @@
+#ifndef LATENCYTRACE_H
+#define LATENCYTRACE_H
+
+#include <QJsonObject>
+#include <QString>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Per-recording latency breakdown, from stopRecording to the text on
+// screen. Stages may nest ("transcribe" contains "convert", "mel" and
+// "inference"). Stages are added from whichever thread runs them; engine code
+// reports through StageTimer into the trace installed on its thread with
+// Scope. With no trace installed a StageTimer is one thread-local load, so
+// the hot paths pay nothing when tracing is off.
+class LatencyTrace {
+public:
+    // The clock starts here; the audio length is usually only known later
+    LatencyTrace();
+    void setAudioSamples(size_t samples, int sampleRate = 16000);
+    
+    // Adds to the stage's total (a stage may run more than once)
+    void add(const char* stage, double ms);
+    double stageMs(const char* stage) const;
+    
+    double audioMs() const { return m_audioMs; }
+    double totalMs() const;     // since construction
+    double realTimeFactor() const;
+    
+    // "RTF 0.21 | drain 2 ms | convert 1 ms | ..."
+    QString summary() const;
+    QJsonObject toJson() const;
+    
+    // One JSON object per line, appended to latencyLogPath()
+    bool appendToLog() const;
+    static QString latencyLogPath();
+    
+    // Installs a trace as the current thread's for its lifetime
+    class Scope {
+    public:
+        explicit Scope(LatencyTrace* trace);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    
+    private:
+        LatencyTrace* m_previous;
+    };
+    
+    // Times its own lifetime into the current thread's trace, if any
+    class StageTimer {
+    public:
+        explicit StageTimer(const char* stage);
+        ~StageTimer();
+        StageTimer(const StageTimer&) = delete;
+        StageTimer& operator=(const StageTimer&) = delete;
+    
+    private:
+        LatencyTrace* m_trace;
+        const char* m_stage;
+        std::chrono::steady_clock::time_point m_start;
+    };
+    
+    static LatencyTrace* current();
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    mutable std::mutex m_mutex;
+    std::vector<std::pair<const char*, double>> m_stages;   // in first-seen order
+    Clock::time_point m_created;
+    double m_audioMs;
+};
+
+#endif // LATENCYTRACE_H
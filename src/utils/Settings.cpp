@@ -60,13 +60,21 @@ void Settings::setInputDevice(const QString& device) {
 }
 
 int Settings::sampleRate() const {
-    return m_settings.value("audio/sampleRate", 16000).toInt();
+    return m_settings.value("audio/sampleRate", 0).toInt();
 }
 
 void Settings::setSampleRate(int rate) {
     m_settings.setValue("audio/sampleRate", rate);
 }
 
+QString Settings::resampleQuality() const {
+    return m_settings.value("audio/resampleQuality", "balanced").toString();
+}
+
+void Settings::setResampleQuality(const QString& quality) {
+    m_settings.setValue("audio/resampleQuality", quality);
+}
+
 bool Settings::noiseGateEnabled() const {
     return m_settings.value("audio/noiseGate", false).toBool();
 }
@@ -75,6 +83,54 @@ void Settings::setNoiseGateEnabled(bool enabled) {
     m_settings.setValue("audio/noiseGate", enabled);
 }
 
+QString Settings::noiseGateMode() const {
+    return m_settings.value("audio/noiseGateMode", "gate").toString();
+}
+
+void Settings::setNoiseGateMode(const QString& mode) {
+    m_settings.setValue("audio/noiseGateMode", mode);
+}
+
+bool Settings::voiceActivityDetection() const {
+    return m_settings.value("audio/voiceActivityDetection", true).toBool();
+}
+
+void Settings::setVoiceActivityDetection(bool enabled) {
+    m_settings.setValue("audio/voiceActivityDetection", enabled);
+}
+
+bool Settings::spillToDisk() const {
+    return m_settings.value("audio/spillToDisk", false).toBool();
+}
+
+void Settings::setSpillToDisk(bool enabled) {
+    m_settings.setValue("audio/spillToDisk", enabled);
+}
+
+int Settings::preRollSeconds() const {
+    return m_settings.value("audio/preRollSeconds", 0).toInt();
+}
+
+void Settings::setPreRollSeconds(int seconds) {
+    m_settings.setValue("audio/preRollSeconds", seconds);
+}
+
+QString Settings::audioBackend() const {
+    return m_settings.value("audio/backend", "async").toString();
+}
+
+void Settings::setAudioBackend(const QString& backend) {
+    m_settings.setValue("audio/backend", backend);
+}
+
+int Settings::captureLatencyMs() const {
+    return m_settings.value("audio/latencyMs", 20).toInt();
+}
+
+void Settings::setCaptureLatencyMs(int ms) {
+    m_settings.setValue("audio/latencyMs", ms);
+}
+
 // Model settings
 QString Settings::defaultModel() const {
     return m_settings.value("model/default", "Whisper Base").toString();
@@ -92,6 +148,30 @@ void Settings::setKeepModelLoaded(bool keep) {
     m_settings.setValue("model/keepLoaded", keep);
 }
 
+bool Settings::liveTranscription() const {
+    return m_settings.value("model/liveTranscription", false).toBool();
+}
+
+void Settings::setLiveTranscription(bool enabled) {
+    m_settings.setValue("model/liveTranscription", enabled);
+}
+
+bool Settings::adaptiveAudioContext() const {
+    return m_settings.value("model/adaptiveAudioCtx", false).toBool();
+}
+
+void Settings::setAdaptiveAudioContext(bool enabled) {
+    m_settings.setValue("model/adaptiveAudioCtx", enabled);
+}
+
+int Settings::transcriptionWorkers() const {
+    return m_settings.value("model/workers", 0).toInt();
+}
+
+void Settings::setTranscriptionWorkers(int workers) {
+    m_settings.setValue("model/workers", workers);
+}
+
 QString Settings::languageOverride() const {
     return m_settings.value("model/language", "en").toString();
 }
@@ -100,6 +180,22 @@ void Settings::setLanguageOverride(const QString& lang) {
     m_settings.setValue("model/language", lang);
 }
 
+int Settings::parallelDownloads() const {
+    return m_settings.value("model/parallelDownloads", 2).toInt();
+}
+
+void Settings::setParallelDownloads(int downloads) {
+    m_settings.setValue("model/parallelDownloads", downloads);
+}
+
+int Settings::downloadConnections() const {
+    return m_settings.value("model/downloadConnections", 1).toInt();
+}
+
+void Settings::setDownloadConnections(int connections) {
+    m_settings.setValue("model/downloadConnections", connections);
+}
+
 // Interface settings
 QString Settings::theme() const {
     return m_settings.value("interface/theme", "dark").toString();
@@ -142,6 +238,22 @@ void Settings::setLogLevel(int level) {
     m_settings.setValue("advanced/logLevel", level);
 }
 
+bool Settings::latencyReadout() const {
+    return m_settings.value("advanced/latencyReadout", false).toBool();
+}
+
+void Settings::setLatencyReadout(bool enabled) {
+    m_settings.setValue("advanced/latencyReadout", enabled);
+}
+
+bool Settings::latencyLog() const {
+    return m_settings.value("advanced/latencyLog", false).toBool();
+}
+
+void Settings::setLatencyLog(bool enabled) {
+    m_settings.setValue("advanced/latencyLog", enabled);
+}
+
 QString Settings::modelDirectory() const {
     return m_settings.value("modelDirectory").toString();
 }
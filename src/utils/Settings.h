@@ -12,15 +12,36 @@ public:
     }
     
     // Audio settings
-    QString inputDevice() const;
+    QString inputDevice() const;            // PulseAudio source name or "default"
     void setInputDevice(const QString& device);
     
-    int sampleRate() const;
+    int sampleRate() const;                 // capture rate, 0 = the device's own
     void setSampleRate(int rate);
     
+    QString resampleQuality() const;        // "fast", "balanced" or "best"
+    void setResampleQuality(const QString& quality);
+    
     bool noiseGateEnabled() const;
     void setNoiseGateEnabled(bool enabled);
     
+    QString noiseGateMode() const;          // "gate" or "spectral"
+    void setNoiseGateMode(const QString& mode);
+    
+    bool voiceActivityDetection() const;    // decode only the parts with speech
+    void setVoiceActivityDetection(bool enabled);
+    
+    bool spillToDisk() const;               // record to a file instead of RAM
+    void setSpillToDisk(bool enabled);
+    
+    int preRollSeconds() const;             // 0 = off; keeps the mic open between takes
+    void setPreRollSeconds(int seconds);
+    
+    QString audioBackend() const;           // "async" or "simple"
+    void setAudioBackend(const QString& backend);
+    
+    int captureLatencyMs() const;
+    void setCaptureLatencyMs(int ms);
+    
     // Model settings
     QString defaultModel() const;
     void setDefaultModel(const QString& model);
@@ -28,9 +49,24 @@ public:
     bool keepModelLoaded() const;
     void setKeepModelLoaded(bool keep);
     
+    bool liveTranscription() const;
+    void setLiveTranscription(bool enabled);
+    
+    bool adaptiveAudioContext() const;
+    void setAdaptiveAudioContext(bool enabled);
+    
+    int transcriptionWorkers() const;      // 0 = pick from core count
+    void setTranscriptionWorkers(int workers);
+    
     QString languageOverride() const;
     void setLanguageOverride(const QString& lang);
     
+    int parallelDownloads() const;         // models downloading at once
+    void setParallelDownloads(int downloads);
+    
+    int downloadConnections() const;       // per large download; 1 = no segments
+    void setDownloadConnections(int connections);
+    
     // Interface settings
     QString theme() const;
     void setTheme(const QString& theme);
@@ -48,6 +84,12 @@ public:
     int logLevel() const;
     void setLogLevel(int level);
     
+    bool latencyReadout() const;           // per-stage timings in the status bar
+    void setLatencyReadout(bool enabled);
+    
+    bool latencyLog() const;               // append timings to latency.jsonl
+    void setLatencyLog(bool enabled);
+    
     // Model directory
     QString modelDirectory() const;
     
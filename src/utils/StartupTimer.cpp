@@ -0,0 +1,33 @@
+#include "StartupTimer.h"
+#include <QElapsedTimer>
+#include <QSet>
+#include <QDebug>
+
+namespace {
+    QElapsedTimer& processTimer() {
+        static QElapsedTimer timer;
+        return timer;
+    }
+    
+    QSet<QString>& reachedMilestones() {
+        static QSet<QString> milestones;
+        return milestones;
+    }
+}
+
+void StartupTimer::start() {
+    processTimer().start();
+}
+
+qint64 StartupTimer::elapsedMs() {
+    return processTimer().isValid() ? processTimer().elapsed() : -1;
+}
+
+void StartupTimer::mark(const QString& milestone) {
+    // GUI thread only, no locking needed
+    if (!processTimer().isValid() || reachedMilestones().contains(milestone)) {
+        return;
+    }
+    reachedMilestones().insert(milestone);
+    qInfo().noquote() << "Startup:" << milestone << "after" << elapsedMs() << "ms";
+}
@@ -0,0 +1,19 @@
+#ifndef STARTUPTIMER_H
+#define STARTUPTIMER_H
+
+#include <QString>
+
+// Measures time from process start to startup milestones (first paint,
+// model ready). Each milestone is logged once; later marks are ignored.
+class StartupTimer {
+public:
+    // Call first thing in main()
+    static void start();
+    
+    static qint64 elapsedMs();
+    
+    // Log the milestone if it hasn't been reached before
+    static void mark(const QString& milestone);
+};
+
+#endif // STARTUPTIMER_H
@@ -0,0 +1,59 @@
+#include "SystemInfo.h"
+#include <QFile>
+#include <QRegExp>
+#include <QStorageInfo>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTextStream>
+
+QString SystemInfo::getDescription() {
+    QString info;
+    
+    info += "OS: " + QSysInfo::prettyProductName() + "\n";
+    info += "Kernel: " + QSysInfo::kernelVersion() + "\n";
+    info += "Arch: " + QSysInfo::currentCpuArchitecture() + "\n";
+    
+    // RAM
+    qint64 ramMB = getAvailableRAM();
+    if (ramMB > 0) {
+        info += QString("Available RAM: %1 MB\n").arg(ramMB);
+    }
+    
+    // Qt version
+    info += "Qt version: " + QString(qVersion()) + "\n";
+    
+    return info;
+}
+
+bool SystemInfo::checkDiskSpace(const QString& path, qint64 requiredBytes) {
+    QStorageInfo storage(path);
+    
+    if (storage.isValid()) {
+        qint64 available = storage.bytesAvailable();
+        return available >= requiredBytes;
+    }
+    
+    return false; // Assume insufficient if we can't check
+}
+
+qint64 SystemInfo::getAvailableRAM() {
+    QFile meminfo("/proc/meminfo");
+    
+    if (!meminfo.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    
+    QTextStream in(&meminfo);
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        if (line.startsWith("MemAvailable:")) {
+            QStringList parts = line.split(QRegExp("\\s+"));
+            if (parts.size() >= 2) {
+                qint64 kb = parts[1].toLongLong();
+                return kb / 1024; // Convert to MB
+            }
+        }
+    }
+    
+    return -1;
+}
@@ -0,0 +1,17 @@
+#ifndef SYSTEMINFO_H
+#define SYSTEMINFO_H
+
+#include <QString>
+
+// Host queries that don't need a GUI: memory, disk space, OS details
+class SystemInfo {
+public:
+    static QString getDescription();
+    static bool checkDiskSpace(const QString& path, qint64 requiredBytes);
+    static qint64 getAvailableRAM();    // MB, -1 if unknown
+    
+private:
+    SystemInfo() = default;
+};
+
+#endif // SYSTEMINFO_H